@@ -160,6 +160,8 @@ Status AspiredVersionsManager::Create(
       options.flush_filesystem_caches;
   basic_manager_options.servable_event_bus = options.servable_event_bus;
   basic_manager_options.pre_load_hook = std::move(options.pre_load_hook);
+  basic_manager_options.enable_optimistic_load_admission =
+      options.enable_optimistic_load_admission;
   std::unique_ptr<BasicManager> basic_manager;
   TF_RETURN_IF_ERROR(
       BasicManager::Create(std::move(basic_manager_options), &basic_manager));
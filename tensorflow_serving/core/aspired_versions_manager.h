@@ -140,6 +140,11 @@ class AspiredVersionsManager : public Manager,
     /// Callback to be called just before a servable is to be loaded. This will
     /// called on the same manager load thread which starts the load.
     PreLoadHook pre_load_hook;
+
+    /// If true, loads that have to wait for resources don't hold up the
+    /// approval of other loads. See
+    /// BasicManager::Options::enable_optimistic_load_admission.
+    bool enable_optimistic_load_admission = false;
   };
   static Status Create(Options options,
                        std::unique_ptr<AspiredVersionsManager>* manager);
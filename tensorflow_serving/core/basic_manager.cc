@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow_serving/core/load_phase_recorder.h"
 #include "tensorflow_serving/core/servable_handle.h"
 #include "tensorflow_serving/core/source.h"
 #include "tensorflow_serving/util/cleanup.h"
@@ -227,7 +228,8 @@ Status BasicManager::Create(Options options,
       options.env, options.num_load_threads, options.num_unload_threads,
       options.max_num_load_retries, options.load_retry_interval_micros,
       options.flush_filesystem_caches, std::move(options.resource_tracker),
-      options.servable_event_bus, std::move(options.pre_load_hook)));
+      options.servable_event_bus, std::move(options.pre_load_hook),
+      options.enable_optimistic_load_admission));
   return Status::OK();
 }
 
@@ -238,12 +240,14 @@ BasicManager::BasicManager(Env* const env, const uint32 num_load_threads,
                            bool flush_filesystem_caches,
                            std::unique_ptr<ResourceTracker> resource_tracker,
                            EventBus<ServableState>* servable_event_bus,
-                           std::function<void(const ServableId&)> pre_load_hook)
+                           std::function<void(const ServableId&)> pre_load_hook,
+                           bool enable_optimistic_load_admission)
     : servable_event_bus_(servable_event_bus),
       env_(env),
       num_load_threads_(num_load_threads),
       flush_filesystem_caches_(flush_filesystem_caches),
-      pre_load_hook_(std::move(pre_load_hook)) {
+      pre_load_hook_(std::move(pre_load_hook)),
+      enable_optimistic_load_admission_(enable_optimistic_load_admission) {
   harness_options_.max_num_load_retries = max_num_load_retries;
   harness_options_.load_retry_interval_micros = load_retry_interval_micros;
   harness_options_.error_callback = [this](const ServableId& id,
@@ -500,6 +504,13 @@ Status BasicManager::ExecuteLoad(LoaderHarness* harness) {
     }
   }
 
+  // Export the timings of whichever load phases ran, even if the load failed;
+  // slow failures are as interesting as slow successes.
+  LoadPhaseRecorder* const load_phase_recorder = LoadPhaseRecorder::Current();
+  if (load_phase_recorder != nullptr) {
+    load_phase_recorder->ExportMetrics(id.name);
+  }
+
   TF_RETURN_IF_ERROR(status);
 
   {
@@ -507,8 +518,12 @@ Status BasicManager::ExecuteLoad(LoaderHarness* harness) {
     UpdateServingMap();
   }
 
-  PublishOnEventBus(
-      {id, ServableState::ManagerState::kAvailable, Status::OK()});
+  ServableState available_state = {
+      id, ServableState::ManagerState::kAvailable, Status::OK()};
+  if (load_phase_recorder != nullptr) {
+    available_state.load_phase_micros = load_phase_recorder->phase_timings();
+  }
+  PublishOnEventBus(available_state);
   return Status::OK();
 }
 
@@ -638,6 +653,11 @@ void BasicManager::LoadOrUnloadServable(const LoadOrUnloadRequest& request,
 
 void BasicManager::HandleLoadOrUnloadRequest(const LoadOrUnloadRequest& request,
                                              DoneCallback done_callback) {
+  // Collects the timings of the load phases instrumented by the loader, which
+  // run on this thread. Covers the decision phase too, since that is where
+  // the loader's resources are (typically first) estimated.
+  LoadPhaseRecorder load_phase_recorder;
+
   // Decision phase.
   Status decision_status;
   LoaderHarness* harness;
@@ -645,8 +665,10 @@ void BasicManager::HandleLoadOrUnloadRequest(const LoadOrUnloadRequest& request,
     // We serialize the decision phases of the requests. We will make a decision
     // about the present request before allowing other requests to enter their
     // decision phase. See the .h file for more explanation and rationale.
-    mutex_lock l(load_unload_decision_phase_mu_);
-    decision_status = ApproveLoadOrUnload(request, &harness);
+    std::unique_ptr<mutex_lock> decision_phase_lock(
+        new mutex_lock(load_unload_decision_phase_mu_));
+    decision_status =
+        ApproveLoadOrUnload(request, &decision_phase_lock, &harness);
   }
   if (!decision_status.ok()) {
     done_callback(decision_status);
@@ -658,15 +680,16 @@ void BasicManager::HandleLoadOrUnloadRequest(const LoadOrUnloadRequest& request,
   done_callback(execution_status);
 }
 
-Status BasicManager::ApproveLoadOrUnload(const LoadOrUnloadRequest& request,
-                                         LoaderHarness** harness) {
+Status BasicManager::ApproveLoadOrUnload(
+    const LoadOrUnloadRequest& request,
+    std::unique_ptr<mutex_lock>* decision_phase_lock, LoaderHarness** harness) {
   mutex_lock l(mu_);
 
   TF_RETURN_IF_ERROR(GetHealthyHarness(request.servable_id, harness));
 
   switch (request.kind) {
     case LoadOrUnloadRequest::Kind::kLoad: {
-      TF_RETURN_IF_ERROR(ApproveLoad(*harness, &l));
+      TF_RETURN_IF_ERROR(ApproveLoad(*harness, decision_phase_lock, &l));
       break;
     }
     case LoadOrUnloadRequest::Kind::kUnload: {
@@ -680,11 +703,13 @@ Status BasicManager::ApproveLoadOrUnload(const LoadOrUnloadRequest& request,
   return Status::OK();
 }
 
-Status BasicManager::ApproveLoad(LoaderHarness* harness, mutex_lock* mu_lock) {
+Status BasicManager::ApproveLoad(
+    LoaderHarness* harness, std::unique_ptr<mutex_lock>* decision_phase_lock,
+    mutex_lock* mu_lock) {
   if (resource_tracker_ != nullptr) {
     // Attempt to reserve resources for the load.
     const Status resource_reservation_status =
-        ReserveResources(harness, mu_lock);
+        ReserveResources(harness, decision_phase_lock, mu_lock);
     if (!resource_reservation_status.ok()) {
       LOG(WARNING) << resource_reservation_status;
       harness->Error(resource_reservation_status);
@@ -710,8 +735,9 @@ Status BasicManager::ApproveUnload(LoaderHarness* harness) {
   return Status::OK();
 }
 
-Status BasicManager::ReserveResources(LoaderHarness* harness,
-                                      mutex_lock* mu_lock) {
+Status BasicManager::ReserveResources(
+    LoaderHarness* harness, std::unique_ptr<mutex_lock>* decision_phase_lock,
+    mutex_lock* mu_lock) {
   while (true) {
     TF_RETURN_IF_ERROR(resource_tracker_->RecomputeUsedResources(
         GetLoadersCurrentlyUsingResources()));
@@ -751,6 +777,14 @@ Status BasicManager::ReserveResources(LoaderHarness* harness,
           "Insufficient resources to load servable ",
           harness->id().DebugString());
     } else {
+      if (enable_optimistic_load_admission_ &&
+          *decision_phase_lock != nullptr) {
+        // Don't hold up the decision phases of subsequent requests, which may
+        // well fit in the resources that are currently available.
+        VLOG(1) << "Leaving decision phase while waiting for resources to load "
+                << "servable " << harness->id().DebugString();
+        decision_phase_lock->reset();
+      }
       // Wait until at least one load/unload request finishes, then retry.
       VLOG(1) << "Waiting for another load/unload request to finish";
       num_ongoing_load_unload_executions_cv_.wait(*mu_lock);
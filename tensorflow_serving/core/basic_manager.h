@@ -75,7 +75,9 @@ class BasicManagerTestAccess;
 /// needs and/or only bind their servables' resources to device instances,
 /// load/unload concurrency can be reduced below the thread-pool size. That is
 /// because we may have to wait for one servable's load/unload to finish to pin
-/// down the resource availability for loading another servable.
+/// down the resource availability for loading another servable. (See
+/// Options::enable_optimistic_load_admission for a way to only hold up the
+/// loads that need to wait.)
 ///
 /// REQUIRES:
 /// 1. Order of method calls -
@@ -152,6 +154,17 @@ class BasicManager : public Manager {
     // Callback to be called just before a servable is to be loaded. This will
     // called on the same manager load thread which starts the load.
     PreLoadHook pre_load_hook;
+
+    // If true, a load request whose resources do not fit until some ongoing
+    // load/unload finishes waits outside of the (otherwise serialized) decision
+    // phase, so that subsequent requests whose resources do fit are approved
+    // and executed in the meantime. The waiting request re-attempts its
+    // reservation each time a load/unload finishes.
+    //
+    // This gives up the guarantee that load requests are approved in FIFO
+    // order, so a large servable may be passed over by smaller ones for as long
+    // as they keep arriving.
+    bool enable_optimistic_load_admission = false;
   };
   static Status Create(Options options, std::unique_ptr<BasicManager>* manager);
 
@@ -273,7 +286,8 @@ class BasicManager : public Manager {
                bool flush_filesystem_caches,
                std::unique_ptr<ResourceTracker> resource_tracker,
                EventBus<ServableState>* servable_event_bus,
-               PreLoadHook pre_load_hook);
+               PreLoadHook pre_load_hook,
+               bool enable_optimistic_load_admission);
 
   // Starts managing the servable.
   //
@@ -331,7 +345,12 @@ class BasicManager : public Manager {
   // subsequent execution phase of the request because approval of this request
   // precludes concurrent execution of another request that could delete the
   // harness.)
+  //
+  // Argument 'decision_phase_lock' is a lock held on
+  // 'load_unload_decision_phase_mu_'. It may be released early, see
+  // ReserveResources().
   Status ApproveLoadOrUnload(const LoadOrUnloadRequest& request,
+                             std::unique_ptr<mutex_lock>* decision_phase_lock,
                              LoaderHarness** harness) LOCKS_EXCLUDED(mu_);
 
   // The decision phase of whether to approve a load request.
@@ -342,8 +361,9 @@ class BasicManager : public Manager {
   //
   // Argument 'mu_lock' is a lock held on 'mu_'. It is released temporarily via
   // 'num_ongoing_load_unload_executions_cv_'.
-  Status ApproveLoad(LoaderHarness* harness, mutex_lock* mu_lock)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status ApproveLoad(LoaderHarness* harness,
+                     std::unique_ptr<mutex_lock>* decision_phase_lock,
+                     mutex_lock* mu_lock) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // The decision phase of whether to approve an unload request. If it succeeds,
   // places the servable into state kQuiescing. Among other things, that
@@ -357,8 +377,14 @@ class BasicManager : public Manager {
   //
   // Argument 'mu_lock' is a lock held on 'mu_'. It is released temporarily via
   // 'num_ongoing_load_unload_executions_cv_'.
-  Status ReserveResources(LoaderHarness* harness, mutex_lock* mu_lock)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  //
+  // If 'enable_optimistic_load_admission_' is set, 'decision_phase_lock' is
+  // released (and reset to null) before waiting for an ongoing load/unload to
+  // finish, letting other requests enter their decision phase. The remainder of
+  // the reservation is still atomic, since it is made while holding 'mu_'.
+  Status ReserveResources(LoaderHarness* harness,
+                          std::unique_ptr<mutex_lock>* decision_phase_lock,
+                          mutex_lock* mu_lock) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // The execution phase of loading/unloading a servable. Delegates to either
   // ExecuteLoad() or ExecuteUnload().
@@ -478,7 +504,9 @@ class BasicManager : public Manager {
   //
   // Given a stream of load/unload requests, we execute the decision phases
   // serially, which guarantees that request i’s decision phase can complete
-  // before considering request i+1's so there’s no starvation.
+  // before considering request i+1's so there’s no starvation. (Unless
+  // 'enable_optimistic_load_admission_' is set, in which case a load request
+  // that has to wait for resources leaves the decision phase while waiting.)
 
   Env* const env_;
 
@@ -511,6 +539,10 @@ class BasicManager : public Manager {
 
   PreLoadHook pre_load_hook_;
 
+  // Whether load requests that are waiting for resources let other requests
+  // through the decision phase. See Options::enable_optimistic_load_admission.
+  const bool enable_optimistic_load_admission_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(BasicManager);
 };
 
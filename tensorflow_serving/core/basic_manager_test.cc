@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/null_file_system.h"
+#include "tensorflow_serving/core/load_phase_recorder.h"
 #include "tensorflow_serving/core/servable_state_monitor.h"
 #include "tensorflow_serving/core/test_util/availability_test_util.h"
 #include "tensorflow_serving/core/test_util/fake_loader.h"
@@ -751,6 +752,32 @@ TEST_P(BasicManagerTest, EventBusServableLifecycle) {
               EqualsServableState(end_state));
 }
 
+TEST_P(BasicManagerTest, EventBusReportsLoadPhaseTimings) {
+  const ServableId id = {kServableName, 7};
+  test_util::MockLoader* loader = new NiceMock<test_util::MockLoader>();
+  TF_ASSERT_OK(
+      basic_manager_->ManageServable({id, std::unique_ptr<Loader>(loader)}));
+  EXPECT_CALL(*loader, Load()).WillOnce(InvokeWithoutArgs([]() {
+    {
+      ScopedLoadPhase phase("restore");
+    }
+    {
+      ScopedLoadPhase phase("warmup");
+    }
+    return Status::OK();
+  }));
+  basic_manager_->LoadServable(
+      id, [](const Status& status) { TF_ASSERT_OK(status); });
+  WaitUntilServableManagerStateIsOneOf(
+      servable_state_monitor_, id, {ServableState::ManagerState::kAvailable});
+
+  const optional<ServableState> state = servable_state_monitor_.GetState(id);
+  ASSERT_TRUE(state);
+  ASSERT_EQ(2, state->load_phase_micros.size());
+  EXPECT_EQ("restore", state->load_phase_micros[0].first);
+  EXPECT_EQ("warmup", state->load_phase_micros[1].first);
+}
+
 // Tests whether there are any errors if we don't have an event bus configured.
 TEST_P(BasicManagerTest, NoEventBus) {
   BasicManager::Options options;
@@ -1582,6 +1609,84 @@ TEST_F(ResourceConstrainedBasicManagerTest, FirstLoadDeniedSecondOneApproved) {
               EqualsServableState(expected_error_state));
 }
 
+TEST(OptimisticLoadAdmissionTest, WaitingLoadDoesNotHoldUpFittingLoad) {
+  BasicManager::Options options;
+  // Seed the manager with ten resource units.
+  options.resource_tracker = CreateSimpleResourceTracker(10);
+  options.num_load_threads = 3;
+  options.num_unload_threads = 0;
+  options.max_num_load_retries = 0;
+  options.enable_optimistic_load_admission = true;
+  std::unique_ptr<BasicManager> basic_manager;
+  TF_CHECK_OK(BasicManager::Create(std::move(options), &basic_manager));
+
+  // A first loader, using most of the resources, whose load doesn't finish
+  // until we say so.
+  const ServableId slow_id = {"slow", 0};
+  test_util::MockLoader* slow_loader = new NiceMock<test_util::MockLoader>;
+  ON_CALL(*slow_loader, EstimateResources(_))
+      .WillByDefault(Invoke([](ResourceAllocation* estimate) {
+        *estimate = CreateResourceQuantity(6);
+        return Status::OK();
+      }));
+  Notification slow_load_started;
+  Notification finish_slow_load;
+  EXPECT_CALL(*slow_loader, Load())
+      .WillOnce(Invoke([&slow_load_started, &finish_slow_load]() {
+        slow_load_started.Notify();
+        finish_slow_load.WaitForNotification();
+        return Status::OK();
+      }));
+  TF_ASSERT_OK(basic_manager->ManageServable(
+      CreateServableData(slow_id, std::unique_ptr<Loader>(slow_loader))));
+  basic_manager->LoadServable(
+      slow_id, [](const Status& status) { TF_EXPECT_OK(status); });
+  slow_load_started.WaitForNotification();
+
+  // A second loader that doesn't fit while the first one is loading, and so
+  // waits for it to finish (and is then rejected).
+  const ServableId waiting_id = {"waiting", 0};
+  test_util::MockLoader* waiting_loader = new NiceMock<test_util::MockLoader>;
+  ON_CALL(*waiting_loader, EstimateResources(_))
+      .WillByDefault(Invoke([](ResourceAllocation* estimate) {
+        *estimate = CreateResourceQuantity(6);
+        return Status::OK();
+      }));
+  EXPECT_CALL(*waiting_loader, Load()).Times(0);
+  TF_ASSERT_OK(basic_manager->ManageServable(
+      CreateServableData(waiting_id, std::unique_ptr<Loader>(waiting_loader))));
+  basic_manager->LoadServable(waiting_id, [](const Status& status) {
+    EXPECT_EQ(error::RESOURCE_EXHAUSTED, status.code());
+  });
+
+  // A third loader that fits right away. It should get loaded while the first
+  // one is still loading, rather than queue up behind the second one.
+  const ServableId fitting_id = {"fitting", 0};
+  test_util::MockLoader* fitting_loader = new NiceMock<test_util::MockLoader>;
+  ON_CALL(*fitting_loader, EstimateResources(_))
+      .WillByDefault(Invoke([](ResourceAllocation* estimate) {
+        *estimate = CreateResourceQuantity(4);
+        return Status::OK();
+      }));
+  Notification fitting_loaded;
+  EXPECT_CALL(*fitting_loader, Load())
+      .WillOnce(Invoke([&finish_slow_load, &fitting_loaded]() {
+        EXPECT_FALSE(finish_slow_load.HasBeenNotified());
+        fitting_loaded.Notify();
+        return Status::OK();
+      }));
+  TF_ASSERT_OK(basic_manager->ManageServable(
+      CreateServableData(fitting_id, std::unique_ptr<Loader>(fitting_loader))));
+  basic_manager->LoadServable(
+      fitting_id, [](const Status& status) { TF_EXPECT_OK(status); });
+
+  fitting_loaded.WaitForNotification();
+  finish_slow_load.Notify();
+
+  // Force the manager to finish before deleting the notifications.
+  basic_manager.reset();
+}
+
 TEST_F(ResourceConstrainedBasicManagerTest, EventBusErrorOnEstimateResources) {
   const ServableId id = {kServableName, 7};
   test_util::MockLoader* loader = new NiceMock<test_util::MockLoader>;
@@ -0,0 +1,92 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/core/load_phase_recorder.h"
+
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+auto* model_load_phase_latency = monitoring::Sampler<2>::New(
+    {
+        "/tensorflow/serving/model_load_phase_latency",
+        "Distribution of wall time (in microseconds) spent in each phase of "
+        "loading a model.",
+        "model_name",
+        "phase",
+    },  // Scale of 10, power of 1.8 with bucket count 33 (~20 minutes).
+    monitoring::Buckets::Exponential(10, 1.8, 33));
+
+// The recorder installed on the current thread, if any.
+thread_local LoadPhaseRecorder* current_recorder = nullptr;
+
+}  // namespace
+
+LoadPhaseRecorder::LoadPhaseRecorder() : previous_(current_recorder) {
+  current_recorder = this;
+}
+
+LoadPhaseRecorder::~LoadPhaseRecorder() {
+  DCHECK_EQ(this, current_recorder)
+      << "LoadPhaseRecorders must be destroyed in reverse order of creation, "
+         "on the thread that created them";
+  current_recorder = previous_;
+}
+
+LoadPhaseRecorder* LoadPhaseRecorder::Current() { return current_recorder; }
+
+void LoadPhaseRecorder::Record(const string& phase, const uint64 micros) {
+  phase_timings_.emplace_back(phase, micros);
+}
+
+void LoadPhaseRecorder::ExportMetrics(const string& model_name) const {
+  for (const auto& phase_timing : phase_timings_) {
+    model_load_phase_latency->GetCell(model_name, phase_timing.first)
+        ->Add(phase_timing.second);
+  }
+}
+
+LoadPhaseRecorder::ScopedInstall::ScopedInstall(
+    LoadPhaseRecorder* const recorder)
+    : previous_(current_recorder) {
+  current_recorder = recorder;
+}
+
+LoadPhaseRecorder::ScopedInstall::~ScopedInstall() {
+  current_recorder = previous_;
+}
+
+ScopedLoadPhase::ScopedLoadPhase(const string& phase)
+    : recorder_(LoadPhaseRecorder::Current()),
+      phase_(phase),
+      start_micros_(Env::Default()->NowMicros()) {}
+
+ScopedLoadPhase::~ScopedLoadPhase() {
+  if (recorder_ == nullptr) {
+    return;
+  }
+  const uint64 end_micros = Env::Default()->NowMicros();
+  // Avoid clock skew.
+  const uint64 duration_micros =
+      end_micros > start_micros_ ? end_micros - start_micros_ : 0;
+  recorder_->Record(phase_, duration_micros);
+}
+
+}  // namespace serving
+}  // namespace tensorflow
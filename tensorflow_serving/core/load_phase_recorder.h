@@ -0,0 +1,113 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_CORE_LOAD_PHASE_RECORDER_H_
+#define TENSORFLOW_SERVING_CORE_LOAD_PHASE_RECORDER_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Collects the wall time spent in each phase of loading a servable, e.g.
+// resource estimation, graph import or warmup.
+//
+// While a LoadPhaseRecorder is alive, ScopedLoadPhase objects created on the
+// same thread record into it. This lets a manager time the phases of a load
+// without the Loader interface (or the libraries the loader calls into) having
+// to pass timings around explicitly. Recorders nest: constructing one hides any
+// recorder already installed on the thread until it is destroyed.
+//
+// This class is not thread-safe; it must be created and destroyed on the
+// thread that performs the load.
+class LoadPhaseRecorder {
+ public:
+  // Pairs of (phase name, wall time in microseconds), in the order in which the
+  // phases finished. A phase that runs more than once, e.g. due to load
+  // retries, appears once per run.
+  using PhaseTimings = std::vector<std::pair<string, uint64>>;
+
+  // Installs the recorder on the current thread.
+  LoadPhaseRecorder();
+
+  // Uninstalls the recorder, reinstating the previously installed one (if any).
+  ~LoadPhaseRecorder();
+
+  // Returns the recorder installed on the current thread, or nullptr if none.
+  static LoadPhaseRecorder* Current();
+
+  // Records that 'phase' took 'micros' microseconds.
+  void Record(const string& phase, uint64 micros);
+
+  const PhaseTimings& phase_timings() const { return phase_timings_; }
+
+  // Adds the recorded timings to the per-model load-phase latency metric,
+  // labeled with 'model_name'.
+  void ExportMetrics(const string& model_name) const;
+
+  // Installs an existing recorder (which may be null) on the current thread
+  // for the lifetime of this object. Useful for recording the phases of a load
+  // that the thread owning the recorder hands off to a helper thread; the
+  // owning thread must not record phases meanwhile.
+  class ScopedInstall {
+   public:
+    explicit ScopedInstall(LoadPhaseRecorder* recorder);
+    ~ScopedInstall();
+
+   private:
+    LoadPhaseRecorder* const previous_;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(ScopedInstall);
+  };
+
+ private:
+  LoadPhaseRecorder* const previous_;
+  PhaseTimings phase_timings_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(LoadPhaseRecorder);
+};
+
+// Times the enclosing scope as one run of the named load phase, and records it
+// in the LoadPhaseRecorder installed on the current thread, if any. (If none is
+// installed the timing is discarded, so it is cheap to instrument code that
+// also runs outside of servable loads.)
+//
+// Example use:
+//   {
+//     ScopedLoadPhase phase("warmup");
+//     ... warm up the model ...
+//   }
+class ScopedLoadPhase {
+ public:
+  explicit ScopedLoadPhase(const string& phase);
+  ~ScopedLoadPhase();
+
+ private:
+  LoadPhaseRecorder* const recorder_;
+  const string phase_;
+  const uint64 start_micros_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedLoadPhase);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_CORE_LOAD_PHASE_RECORDER_H_
@@ -0,0 +1,96 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/core/load_phase_recorder.h"
+
+#include <memory>
+#include <utility>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Field;
+using ::testing::IsEmpty;
+
+TEST(LoadPhaseRecorderTest, NoRecorderInstalled) {
+  EXPECT_EQ(nullptr, LoadPhaseRecorder::Current());
+  // Must not crash.
+  ScopedLoadPhase phase("phase");
+}
+
+TEST(LoadPhaseRecorderTest, RecordsPhasesInCompletionOrder) {
+  LoadPhaseRecorder recorder;
+  EXPECT_EQ(&recorder, LoadPhaseRecorder::Current());
+  {
+    ScopedLoadPhase outer("outer");
+    {
+      ScopedLoadPhase inner("inner");
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+  }
+  {
+    ScopedLoadPhase last("last");
+  }
+  ASSERT_EQ(3, recorder.phase_timings().size());
+  EXPECT_EQ("inner", recorder.phase_timings()[0].first);
+  EXPECT_GE(recorder.phase_timings()[0].second, 1000);
+  EXPECT_EQ("outer", recorder.phase_timings()[1].first);
+  EXPECT_GE(recorder.phase_timings()[1].second,
+            recorder.phase_timings()[0].second);
+  EXPECT_EQ("last", recorder.phase_timings()[2].first);
+
+  // Exporting must not disturb the timings.
+  recorder.ExportMetrics("model");
+  EXPECT_EQ(3, recorder.phase_timings().size());
+}
+
+TEST(LoadPhaseRecorderTest, NestedRecorders) {
+  LoadPhaseRecorder outer;
+  {
+    LoadPhaseRecorder inner;
+    EXPECT_EQ(&inner, LoadPhaseRecorder::Current());
+    ScopedLoadPhase phase("inner_phase");
+  }
+  EXPECT_EQ(&outer, LoadPhaseRecorder::Current());
+  EXPECT_THAT(outer.phase_timings(), IsEmpty());
+  {
+    ScopedLoadPhase phase("outer_phase");
+  }
+  EXPECT_THAT(outer.phase_timings(),
+              ElementsAre(Field(&std::pair<string, uint64>::first,
+                                Eq("outer_phase"))));
+}
+
+TEST(LoadPhaseRecorderTest, RecordersArePerThread) {
+  LoadPhaseRecorder recorder;
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread(ThreadOptions(), "other", [] {
+        EXPECT_EQ(nullptr, LoadPhaseRecorder::Current());
+        ScopedLoadPhase phase("other_thread_phase");
+      }));
+  thread.reset();
+  EXPECT_THAT(recorder.phase_timings(), IsEmpty());
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -17,8 +17,11 @@ limitations under the License.
 #define TENSORFLOW_SERVING_CORE_SERVABLE_STATE_H_
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow_serving/core/servable_id.h"
 
 namespace tensorflow {
@@ -86,11 +89,24 @@ struct ServableState {
   // the servable are reported here, regardless of origin.
   Status health;
 
+  // Wall time (in microseconds) spent in each phase of loading the servable,
+  // e.g. resource estimation, graph import and warmup, in the order in which
+  // the phases finished. Only populated for kAvailable states, and only for
+  // phases the servable's loader instruments (see load_phase_recorder.h).
+  //
+  // Informational only; not considered by operator==.
+  std::vector<std::pair<string, uint64>> load_phase_micros;
+
   // Returns a string representation of this object. Useful in logging.
   string DebugString() const {
-    return strings::StrCat("id: ", id.DebugString(), " manager_state: ",
-                           ManagerStateString(manager_state),
-                           " health: ", health.ToString());
+    string debug_string = strings::StrCat(
+        "id: ", id.DebugString(), " manager_state: ",
+        ManagerStateString(manager_state), " health: ", health.ToString());
+    for (const auto& phase : load_phase_micros) {
+      strings::StrAppend(&debug_string, " load_phase { ", phase.first, ": ",
+                         phase.second, "us }");
+    }
+    return debug_string;
   }
 };
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow_serving/core/servable_state_monitor.h"
 
+#include <utility>
+
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 
@@ -22,39 +24,99 @@ namespace tensorflow {
 namespace serving {
 namespace {
 
+// Same as ServableStateMonitor::SharedServableMap.
+using SharedServableMap =
+    std::map<ServableStateMonitor::ServableName,
+             std::shared_ptr<const ServableStateMonitor::VersionMap>>;
+
+// Sets the state of a servable version in 'states'. The version map of the
+// servable is copied rather than modified in place, since it may be shared with
+// a published snapshot.
+void SetState(const ServableStateMonitor::ServableStateAndTime& state_and_time,
+              SharedServableMap* const states) {
+  std::shared_ptr<const ServableStateMonitor::VersionMap>& version_map =
+      (*states)[state_and_time.state.id.name];
+  std::unique_ptr<ServableStateMonitor::VersionMap> new_version_map(
+      version_map == nullptr
+          ? new ServableStateMonitor::VersionMap()
+          : new ServableStateMonitor::VersionMap(*version_map));
+  (*new_version_map)[state_and_time.state.id.version] = state_and_time;
+  version_map = std::move(new_version_map);
+}
+
 void EraseLiveStatesEntry(
     const ServableStateMonitor::ServableStateAndTime& state_and_time,
-    ServableStateMonitor::ServableMap* const live_states) {
+    SharedServableMap* const live_states) {
   const string& servable_name = state_and_time.state.id.name;
   const int64 version = state_and_time.state.id.version;
   auto servable_map_it = live_states->find(servable_name);
   if (servable_map_it == live_states->end()) {
     return;
   }
-  auto& version_map = servable_map_it->second;
-  auto version_map_it = version_map.find(version);
-  if (version_map_it == version_map.end()) {
+  const ServableStateMonitor::VersionMap& version_map =
+      *servable_map_it->second;
+  if (version_map.find(version) == version_map.end()) {
     return;
   }
 
-  version_map.erase(version_map_it);
-  if (version_map.empty()) {
+  if (version_map.size() == 1) {
     live_states->erase(servable_map_it);
+    return;
   }
+  // Copy-on-write, as in SetState().
+  std::unique_ptr<ServableStateMonitor::VersionMap> new_version_map(
+      new ServableStateMonitor::VersionMap(version_map));
+  new_version_map->erase(version);
+  servable_map_it->second = std::move(new_version_map);
 }
 
 void UpdateLiveStates(
     const ServableStateMonitor::ServableStateAndTime& state_and_time,
-    ServableStateMonitor::ServableMap* const live_states) {
-  const string& servable_name = state_and_time.state.id.name;
-  const int64 version = state_and_time.state.id.version;
+    SharedServableMap* const live_states) {
   if (state_and_time.state.manager_state != ServableState::ManagerState::kEnd) {
-    (*live_states)[servable_name][version] = state_and_time;
+    SetState(state_and_time, live_states);
   } else {
     EraseLiveStatesEntry(state_and_time, live_states);
   }
 }
 
+// Returns the version map of 'servable_name' in 'states', or nullptr if there
+// is none.
+std::shared_ptr<const ServableStateMonitor::VersionMap> FindVersionMap(
+    const SharedServableMap& states, const string& servable_name) {
+  auto it = states.find(servable_name);
+  if (it == states.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+// Returns the state of 'version' in 'version_map' (which may be null), or
+// nullopt if there is none.
+optional<ServableStateMonitor::ServableStateAndTime> FindState(
+    const ServableStateMonitor::VersionMap* const version_map,
+    const int64 version) {
+  if (version_map == nullptr) {
+    return nullopt;
+  }
+  auto it = version_map->find(version);
+  if (it == version_map->end()) {
+    return nullopt;
+  }
+  return it->second;
+}
+
+// Makes a deep copy of 'states'.
+ServableStateMonitor::ServableMap ToServableMap(
+    const SharedServableMap& states) {
+  ServableStateMonitor::ServableMap servable_map;
+  for (const auto& servable_name_and_versions : states) {
+    servable_map.emplace(servable_name_and_versions.first,
+                         *servable_name_and_versions.second);
+  }
+  return servable_map;
+}
+
 // Returns the state reached iff the servable has reached 'goal_state' or kEnd,
 // otherwise nullopt.
 optional<ServableState::ManagerState> HasSpecificServableReachedState(
@@ -76,13 +138,12 @@ optional<ServableState::ManagerState> HasSpecificServableReachedState(
 // or kEnd. If no servable has done so, returns nullopt.
 optional<ServableId> HasAnyServableInStreamReachedState(
     const string& stream_name, const ServableState::ManagerState goal_state,
-    const ServableStateMonitor::ServableMap& states) {
-  optional<ServableId> opt_servable_id;
+    const SharedServableMap& states) {
   const auto found_it = states.find(stream_name);
   if (found_it == states.end()) {
     return {};
   }
-  const ServableStateMonitor::VersionMap& version_map = found_it->second;
+  const ServableStateMonitor::VersionMap& version_map = *found_it->second;
   for (const auto& version_and_state_time : version_map) {
     const ServableStateMonitor::ServableStateAndTime& state_and_time =
         version_and_state_time.second;
@@ -104,7 +165,7 @@ string ServableStateMonitor::ServableStateAndTime::DebugString() const {
 
 ServableStateMonitor::ServableStateMonitor(EventBus<ServableState>* bus,
                                            const Options& options)
-    : options_(options) {
+    : options_(options), states_snapshot_(new StatesSnapshot) {
   // Important: We must allow the state members ('states_', 'live_states_' and
   // so on) to be initialized *before* we start the bus subscription, in case an
   // event comes in while we are initializing.
@@ -120,25 +181,31 @@ ServableStateMonitor::~ServableStateMonitor() {
   bus_subscription_ = nullptr;
 }
 
+std::shared_ptr<const ServableStateMonitor::StatesSnapshot>
+ServableStateMonitor::GetStatesSnapshot() const {
+  return std::atomic_load(&states_snapshot_);
+}
+
+void ServableStateMonitor::PublishStatesSnapshot() {
+  std::shared_ptr<StatesSnapshot> snapshot(new StatesSnapshot);
+  snapshot->states = states_;
+  snapshot->live_states = live_states_;
+  std::atomic_store(&states_snapshot_,
+                    std::shared_ptr<const StatesSnapshot>(std::move(snapshot)));
+}
+
 optional<ServableStateMonitor::ServableStateAndTime>
 ServableStateMonitor::GetStateAndTimeInternal(
     const ServableId& servable_id) const {
-  auto it = states_.find(servable_id.name);
-  if (it == states_.end()) {
-    return nullopt;
-  }
-  const VersionMap& versions = it->second;
-  auto it2 = versions.find(servable_id.version);
-  if (it2 == versions.end()) {
-    return nullopt;
-  }
-  return it2->second;
+  return FindState(FindVersionMap(states_, servable_id.name).get(),
+                   servable_id.version);
 }
 
 optional<ServableStateMonitor::ServableStateAndTime>
 ServableStateMonitor::GetStateAndTime(const ServableId& servable_id) const {
-  mutex_lock l(mu_);
-  return GetStateAndTimeInternal(servable_id);
+  const std::shared_ptr<const VersionMap> version_map =
+      FindVersionMap(GetStatesSnapshot()->states, servable_id.name);
+  return FindState(version_map.get(), servable_id.version);
 }
 
 optional<ServableState> ServableStateMonitor::GetState(
@@ -153,24 +220,22 @@ optional<ServableState> ServableStateMonitor::GetState(
 
 ServableStateMonitor::VersionMap ServableStateMonitor::GetVersionStates(
     const string& servable_name) const {
-  mutex_lock l(mu_);
-  auto it = states_.find(servable_name);
-  if (it == states_.end()) {
+  const std::shared_ptr<const VersionMap> version_map =
+      FindVersionMap(GetStatesSnapshot()->states, servable_name);
+  if (version_map == nullptr) {
     return {};
   }
-  return it->second;
+  return *version_map;
 }
 
 ServableStateMonitor::ServableMap ServableStateMonitor::GetAllServableStates()
     const {
-  mutex_lock l(mu_);
-  return states_;
+  return ToServableMap(GetStatesSnapshot()->states);
 }
 
 ServableStateMonitor::ServableMap ServableStateMonitor::GetLiveServableStates()
     const {
-  mutex_lock l(mu_);
-  return live_states_;
+  return ToServableMap(GetStatesSnapshot()->live_states);
 }
 
 ServableStateMonitor::BoundedLog ServableStateMonitor::GetBoundedLog() const {
@@ -227,9 +292,10 @@ void ServableStateMonitor::HandleEvent(
   mutex_lock l(mu_);
   const ServableStateAndTime state_and_time = {
       event_and_time.event, event_and_time.event_time_micros};
-  states_[state_and_time.state.id.name][state_and_time.state.id.version] =
-      state_and_time;
+  SetState(state_and_time, &states_);
   UpdateLiveStates(state_and_time, &live_states_);
+  // Copies only the servable maps; the version maps are shared.
+  PublishStatesSnapshot();
   MaybeSendStateReachedNotifications();
 
   if (options_.max_count_log_events == 0) {
@@ -19,6 +19,7 @@ limitations under the License.
 #include <deque>
 #include <functional>
 #include <map>
+#include <memory>
 
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
@@ -40,6 +41,10 @@ namespace serving {
 /// Offers an interface for querying the servable states. It may be useful as
 /// the basis for dashboards, as well as for testing a manager.
 ///
+/// The state queries are served from immutable snapshots, published by each
+/// event, so frequent polling (e.g. by health checkers) does not contend with
+/// event handling.
+///
 /// IMPORTANT: You must create this monitor before arranging for events to be
 /// published on the event bus, e.g. giving the event bus to a Manager.
 class ServableStateMonitor {
@@ -156,6 +161,24 @@ class ServableStateMonitor {
   void Notify(const NotifyFn& notify_fn) LOCKS_EXCLUDED(notify_mu_);
 
  private:
+  // Like ServableMap, but with each VersionMap held by an immutable, shared
+  // pointer. Copying one is cheap: the version maps are shared, not copied. An
+  // event only copies the version map of the servable it pertains to.
+  using SharedServableMap =
+      std::map<ServableName, std::shared_ptr<const VersionMap>>;
+
+  // A consistent view of 'states_' and 'live_states_'.
+  struct StatesSnapshot {
+    SharedServableMap states;
+    SharedServableMap live_states;
+  };
+
+  // Returns the most recently published snapshot of the states. Never blocks.
+  std::shared_ptr<const StatesSnapshot> GetStatesSnapshot() const;
+
+  // Publishes a snapshot of the current 'states_' and 'live_states_'.
+  void PublishStatesSnapshot() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   optional<ServableStateMonitor::ServableStateAndTime> GetStateAndTimeInternal(
       const ServableId& servable_id) const EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -203,11 +226,17 @@ class ServableStateMonitor {
 
   // The current state of each servable version that has appeared on the bus.
   // (Entries are never removed, even when they enter state kEnd.)
-  ServableMap states_ GUARDED_BY(mu_);
+  SharedServableMap states_ GUARDED_BY(mu_);
 
   // The current state of each servable version that has not transitioned to
   // state ServableState::ManagerState::kEnd.
-  ServableMap live_states_ GUARDED_BY(mu_);
+  SharedServableMap live_states_ GUARDED_BY(mu_);
+
+  // Snapshot of 'states_' and 'live_states_' from which the state queries are
+  // served. Published by the event handler, under 'mu_' (so that snapshots are
+  // published in event order), and read without it. Only accessed through
+  // std::atomic_load() and std::atomic_store().
+  std::shared_ptr<const StatesSnapshot> states_snapshot_;
 
   // Deque of pairs of timestamp and ServableState, corresponding to the most
   // recent servable state events handled by the monitor. The size of this deque
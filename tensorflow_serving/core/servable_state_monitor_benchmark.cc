@@ -0,0 +1,226 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Run with:
+// bazel run -c opt --dynamic_mode=off \
+// tensorflow_serving/core:servable_state_monitor_benchmark --
+// --benchmarks=.
+// For a longer run time and more consistent results, consider a min time
+// e.g.: --benchmark_min_time=60.0
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/kernels/batching_util/periodic_function.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow_serving/core/servable_id.h"
+#include "tensorflow_serving/core/servable_state.h"
+#include "tensorflow_serving/core/servable_state_monitor.h"
+#include "tensorflow_serving/util/event_bus.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+constexpr char kServableName[] = "kServableName";
+
+// Number of different servable streams tracked by the monitor.
+constexpr int kNumServableStreams = 100;
+
+// Benchmarks for status polling (GetVersionStates(), as done for each model
+// status request) on a ServableStateMonitor, both with and without concurrent
+// servable state changes ("churn"), as during a rollout.
+//
+// This class maintains all state for a benchmark and handles the concurrency
+// concerns around the concurrent read and update threads.
+class BenchmarkState {
+ public:
+  explicit BenchmarkState(const int interval_micros)
+      : interval_micros_(interval_micros),
+        bus_(EventBus<ServableState>::CreateEventBus({})),
+        monitor_(bus_.get()) {}
+
+  // Actually perform iters reads on the monitor.
+  void RunBenchmark(int iters, int num_threads);
+
+ private:
+  void SetUp();
+  void TearDown();
+
+  // Runs iters number of reads.
+  void RunReads(int iters);
+
+  // Runs continuously after setup and until teardown, if interval_micros was
+  // greater than 0. Each run moves the next servable stream to a new version,
+  // publishing the same sequence of events a manager would.
+  void RunUpdate();
+
+  // To avoid having the benchmark timing include time spent scheduling threads,
+  // we use this notification to notify when the read threads should begin.
+  // This is notified immediately after the benchmark timing is started.
+  Notification all_read_threads_scheduled_;
+
+  // Store the update thread as it is only safe to complete teardown and
+  // destruct state after it has exited.
+  std::unique_ptr<PeriodicFunction> update_thread_;
+
+  // Interval in microseconds for running the update thread.
+  const int interval_micros_;
+
+  std::shared_ptr<EventBus<ServableState>> bus_;
+
+  // The ServableStateMonitor being benchmarked for read performance.
+  ServableStateMonitor monitor_;
+
+  // Only accessed by the update thread.
+  int64 num_updates_ = 0;
+};
+
+void BenchmarkState::RunUpdate() {
+  const string servable_name =
+      strings::StrCat(kServableName, num_updates_ % kNumServableStreams);
+  const int64 version = 1 + num_updates_ / kNumServableStreams;
+  ++num_updates_;
+
+  using ManagerState = ServableState::ManagerState;
+  const ServableId new_id = {servable_name, version};
+  const ServableId old_id = {servable_name, version - 1};
+  bus_->Publish({new_id, ManagerState::kStart, Status::OK()});
+  bus_->Publish({new_id, ManagerState::kLoading, Status::OK()});
+  bus_->Publish({new_id, ManagerState::kAvailable, Status::OK()});
+  bus_->Publish({old_id, ManagerState::kUnloading, Status::OK()});
+  bus_->Publish({old_id, ManagerState::kEnd, Status::OK()});
+}
+
+void BenchmarkState::SetUp() {
+  testing::StopTiming();
+
+  for (int i = 0; i < kNumServableStreams; ++i) {
+    bus_->Publish({{strings::StrCat(kServableName, i), 0},
+                   ServableState::ManagerState::kAvailable,
+                   Status::OK()});
+  }
+
+  if (interval_micros_ > 0) {
+    PeriodicFunction::Options pf_options;
+    pf_options.thread_name_prefix =
+        "ServableStateMonitor_Benchmark_Update_Thread";
+    update_thread_.reset(new PeriodicFunction([this] { RunUpdate(); },
+                                              interval_micros_, pf_options));
+  }
+
+  testing::StartTiming();
+}
+
+void BenchmarkState::TearDown() {
+  testing::StopTiming();
+
+  // Destruct the update thread which blocks until it exits.
+  update_thread_.reset();
+
+  testing::StartTiming();
+}
+
+void BenchmarkState::RunReads(int iters) {
+  for (int i = 0; i < iters; i++) {
+    const ServableStateMonitor::VersionMap versions = monitor_.GetVersionStates(
+        strings::StrCat(kServableName, i % kNumServableStreams));
+    // Prevents the compiler from optimizing this away.
+    CHECK(!versions.empty());
+  }
+}
+
+void BenchmarkState::RunBenchmark(int iters, int num_threads) {
+  SetUp();
+
+  testing::StopTiming();
+
+  // The benchmarking system by default uses cpu time to calculate items per
+  // second, which would include time spent by all the threads on the cpu.
+  // Instead of that we use real-time here so that we can see items/s increasing
+  // with increasing threads, which is easier to understand.
+  testing::UseRealTime();
+  testing::ItemsProcessed(num_threads * iters);
+
+  std::unique_ptr<thread::ThreadPool> pool(new thread::ThreadPool(
+      Env::Default(), "RunBenchmarkReadThread", num_threads));
+  for (int thread_index = 0; thread_index < num_threads; ++thread_index) {
+    std::function<void()> run_reads_fn = [&]() {
+      // Wait until all_read_threads_scheduled_ has been notified.
+      all_read_threads_scheduled_.WaitForNotification();
+      RunReads(iters);
+    };
+    pool->Schedule(run_reads_fn);
+  }
+  testing::StartTiming();
+  all_read_threads_scheduled_.Notify();
+
+  // Note that destructing the threadpool blocks on completion of all scheduled
+  // execution.  This is intentional as we want all threads to complete iters
+  // iterations.
+  pool.reset();
+
+  TearDown();
+}
+
+static void BM_NoUpdates_GetVersionStates(int iters, int num_threads) {
+  // No updates. 0 interval_micros signals not to update at all.
+  BenchmarkState state(0);
+  state.RunBenchmark(iters, num_threads);
+}
+
+static void BM_FrequentUpdates_GetVersionStates(int iters, int num_threads) {
+  // Frequent updates: a version transition every millisecond, i.e. 5000
+  // events per second.
+  BenchmarkState state(1000);
+  state.RunBenchmark(iters, num_threads);
+}
+
+BENCHMARK(BM_NoUpdates_GetVersionStates)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16)
+    ->Arg(32)
+    ->Arg(64);
+
+BENCHMARK(BM_FrequentUpdates_GetVersionStates)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16)
+    ->Arg(32)
+    ->Arg(64);
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
+
+int main(int argc, char** argv) {
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  tensorflow::testing::RunBenchmarks();
+  return 0;
+}
@@ -25,6 +25,7 @@ namespace tensorflow {
 namespace serving {
 namespace {
 
+using ::testing::_;
 using ::testing::ElementsAre;
 using ::testing::IsEmpty;
 using ::testing::Pair;
@@ -278,6 +279,35 @@ TEST(ServableStateMonitorTest, VersionMapDescendingOrder) {
                                                   Pair(7, state_1_and_time)))));
 }
 
+// State queries are served from snapshots, so they can be made from within a
+// notifier function, and observe the event that triggered it.
+TEST(ServableStateMonitorTest, GetStateFromNotifierFn) {
+  auto bus = EventBus<ServableState>::CreateEventBus({});
+  ServableStateMonitor monitor(bus.get());
+  const ServableId specific_goal_state_id = {"specific_goal_state", 42};
+
+  using ManagerState = ServableState::ManagerState;
+
+  Notification notified;
+  monitor.NotifyWhenServablesReachState(
+      {ServableRequest::FromId(specific_goal_state_id)},
+      ManagerState::kAvailable,
+      [&](const bool reached,
+          std::map<ServableId, ManagerState> states_reached) {
+        EXPECT_TRUE(reached);
+        const optional<ServableState> state =
+            monitor.GetState(specific_goal_state_id);
+        ASSERT_TRUE(state);
+        EXPECT_EQ(ManagerState::kAvailable, state->manager_state);
+        EXPECT_THAT(monitor.GetLiveServableStates(),
+                    ElementsAre(Pair("specific_goal_state", _)));
+        notified.Notify();
+      });
+  bus->Publish(
+      {specific_goal_state_id, ManagerState::kAvailable, Status::OK()});
+  notified.WaitForNotification();
+}
+
 TEST(ServableStateMonitorTest, NotifyWhenServablesReachStateZeroServables) {
   auto bus = EventBus<ServableState>::CreateEventBus({});
   ServableStateMonitor monitor(bus.get());
@@ -130,5 +130,14 @@ Status ServerRequestLogger::Log(const google::protobuf::Message& request,
   return status;
 }
 
+bool ServerRequestLogger::IsLoggingEnabled(const string& model_name) {
+  auto model_to_loggers_map = model_to_loggers_map_.get();
+  if (!model_to_loggers_map) {
+    return false;
+  }
+  auto found_it = model_to_loggers_map->find(model_name);
+  return found_it != model_to_loggers_map->end() && !found_it->second.empty();
+}
+
 }  // namespace serving
 }  // namespace tensorflow
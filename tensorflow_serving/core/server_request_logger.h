@@ -68,6 +68,11 @@ class ServerRequestLogger {
                      const google::protobuf::Message& response,
                      const LogMetadata& log_metadata);
 
+  // Returns true if requests to the model 'model_name' may be logged, i.e. it
+  // has at least one RequestLogger. Lets callers skip work only needed for
+  // logging.
+  virtual bool IsLoggingEnabled(const string& model_name);
+
  protected:
   explicit ServerRequestLogger(LoggerCreator request_logger_creator);
 
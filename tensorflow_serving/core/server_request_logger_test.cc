@@ -186,6 +186,14 @@ TEST_F(ServerRequestLoggerTest, MultipleModels) {
   EXPECT_EQ(1, log_collector_map_["/file/model1"]->collect_count());
 }
 
+TEST_F(ServerRequestLoggerTest, IsLoggingEnabled) {
+  EXPECT_FALSE(server_request_logger_->IsLoggingEnabled("model0"));
+  TF_ASSERT_OK(server_request_logger_->Update(
+      CreateLoggingConfigMap({CreateLoggingConfigForModel("model0")})));
+  EXPECT_TRUE(server_request_logger_->IsLoggingEnabled("model0"));
+  EXPECT_FALSE(server_request_logger_->IsLoggingEnabled("model1"));
+}
+
 TEST_F(ServerRequestLoggerTest, CreateAndDeleteLogger) {
   auto model_logging_configs =
       CreateLoggingConfigMap({CreateLoggingConfigForModel("model0")});
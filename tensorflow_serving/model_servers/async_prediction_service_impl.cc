@@ -0,0 +1,464 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/model_servers/async_prediction_service_impl.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "grpc/grpc.h"
+#include "grpcpp/impl/codegen/proto_utils.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/async_unary_call.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "grpcpp/support/slice.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow_serving/servables/tensorflow/predict_util.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+constexpr char kPredictMethod[] =
+    "/tensorflow.serving.PredictionService/Predict";
+
+// Reads the slices of a ::grpc::ByteBuffer, without copying them.
+class SliceInputStream : public protobuf::io::ZeroCopyInputStream {
+ public:
+  explicit SliceInputStream(const std::vector<::grpc::Slice>* slices)
+      : slices_(slices) {}
+
+  bool Next(const void** data, int* size) override {
+    if (backed_up_ > 0) {
+      const ::grpc::Slice& slice = (*slices_)[next_slice_ - 1];
+      *data = slice.begin() + slice.size() - backed_up_;
+      *size = backed_up_;
+      byte_count_ += backed_up_;
+      backed_up_ = 0;
+      return true;
+    }
+    while (next_slice_ < slices_->size()) {
+      const ::grpc::Slice& slice = (*slices_)[next_slice_++];
+      if (slice.size() == 0) {
+        continue;
+      }
+      *data = slice.begin();
+      *size = slice.size();
+      byte_count_ += slice.size();
+      return true;
+    }
+    return false;
+  }
+
+  void BackUp(const int count) override {
+    backed_up_ = count;
+    byte_count_ -= count;
+  }
+
+  bool Skip(int count) override {
+    const void* data;
+    int size;
+    while (Next(&data, &size)) {
+      if (size >= count) {
+        BackUp(size - count);
+        return true;
+      }
+      count -= size;
+    }
+    return false;
+  }
+
+  protobuf_int64 ByteCount() const override { return byte_count_; }
+
+ private:
+  const std::vector<::grpc::Slice>* const slices_;
+  size_t next_slice_ = 0;
+  // The number of bytes at the end of the last returned slice that were
+  // backed up, i.e. are returned again by the next call to Next().
+  int backed_up_ = 0;
+  protobuf_int64 byte_count_ = 0;
+};
+
+}  // namespace
+
+// An in-flight call. Used as the tag of the completion queue operations it
+// issues.
+class AsyncPredictionServiceImpl::CallBase {
+ public:
+  virtual ~CallBase() = default;
+
+  // Invoked by a polling thread when the operation tagged with this call
+  // completes. 'ok' is false if the operation failed, e.g. because the server
+  // is shutting down.
+  virtual void Proceed(bool ok) = 0;
+};
+
+// A call of one PredictionService method. Goes through two states:
+//  1. kRequested: waiting for a client to issue a call. Once one does, a new
+//     Call is requested in its place, and the call is handled.
+//  2. kFinishing: the response has been handed to gRPC. Once it has been
+//     sent, the call is deleted.
+template <typename Request, typename Response>
+class AsyncPredictionServiceImpl::Call final : public CallBase {
+ public:
+  using RequestMethod = void (AsyncService::*)(
+      ::grpc::ServerContext*, Request*,
+      ::grpc::ServerAsyncResponseWriter<Response>*, ::grpc::CompletionQueue*,
+      ::grpc::ServerCompletionQueue*, void*);
+  using HandlerMethod = ::grpc::Status (PredictionServiceImpl::*)(
+      ::grpc::ServerContext*, const Request*, Response*);
+
+  // Requests the next call of a method on 'cq'. If 'run_inline' is true, the
+  // call is handled by the polling thread rather than an inference thread
+  // (for methods that do not run the model).
+  static void RequestNext(AsyncPredictionServiceImpl* parent,
+                          RequestMethod request_method,
+                          HandlerMethod handler_method, bool run_inline,
+                          ::grpc::ServerCompletionQueue* cq) {
+    // Owns itself from here on; see Proceed().
+    Call* call =
+        new Call(parent, request_method, handler_method, run_inline, cq);
+    (parent->service_.*request_method)(&call->context_, call->request_,
+                                       &call->responder_, cq, cq, call);
+  }
+
+  ~Call() override { parent_->DecrementLiveCalls(); }
+
+  void Proceed(const bool ok) override {
+    switch (state_) {
+      case State::kRequested: {
+        if (!ok) {
+          // The server is shutting down; no call was received.
+          delete this;
+          return;
+        }
+        RequestNext(parent_, request_method_, handler_method_, run_inline_,
+                    cq_);
+        // Set before handing the call off, since it may be finished (and
+        // Proceed() invoked again) before Schedule() returns.
+        state_ = State::kFinishing;
+        if (run_inline_) {
+          Handle();
+        } else {
+          parent_->inference_pool_->Schedule([this]() { Handle(); });
+        }
+        return;
+      }
+      case State::kFinishing:
+        delete this;
+        return;
+    }
+  }
+
+ private:
+  enum class State { kRequested, kFinishing };
+
+  Call(AsyncPredictionServiceImpl* parent, RequestMethod request_method,
+       HandlerMethod handler_method, bool run_inline,
+       ::grpc::ServerCompletionQueue* cq)
+      : parent_(parent),
+        request_method_(request_method),
+        handler_method_(handler_method),
+        run_inline_(run_inline),
+        cq_(cq),
+        request_(protobuf::Arena::CreateMessage<Request>(&arena_)),
+        response_(protobuf::Arena::CreateMessage<Response>(&arena_)),
+        responder_(&context_) {
+    parent_->IncrementLiveCalls();
+  }
+
+  // Runs the handler and finishes the call with its result.
+  void Handle() {
+    // A call whose deadline expired while it waited for an inference thread
+    // has been abandoned by its client; don't spend an inference on it.
+    const gpr_timespec deadline = context_.raw_deadline();
+    if (gpr_time_cmp(deadline, gpr_now(deadline.clock_type)) < 0) {
+      responder_.FinishWithError(
+          ::grpc::Status(::grpc::StatusCode::DEADLINE_EXCEEDED,
+                         "Deadline exceeded before the request was processed"),
+          this);
+      return;
+    }
+    const ::grpc::Status status =
+        (parent_->options_.prediction_service->*handler_method_)(
+            &context_, request_, response_);
+    responder_.Finish(*response_, status, this);
+  }
+
+  AsyncPredictionServiceImpl* const parent_;
+  const RequestMethod request_method_;
+  const HandlerMethod handler_method_;
+  const bool run_inline_;
+  ::grpc::ServerCompletionQueue* const cq_;
+
+  State state_ = State::kRequested;
+  ::grpc::ServerContext context_;
+  // Holds the request and response, so that their (many, for large messages)
+  // allocations are cheap and all freed at once with the call.
+  protobuf::Arena arena_;
+  Request* const request_;
+  Response* const response_;
+  ::grpc::ServerAsyncResponseWriter<Response> responder_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Call);
+};
+
+// A Predict call, served as a generic method so that its request can be
+// parsed with ParsePredictRequest(). Goes through three states:
+//  1. kRequested: waiting for a client to issue a call. Once one does, a new
+//     PredictCall is requested in its place, and the request is read.
+//  2. kReading: the request is being read. Once it has been, the call is
+//     handled.
+//  3. kFinishing: the response has been handed to gRPC. Once it has been
+//     sent, the call is deleted.
+class AsyncPredictionServiceImpl::PredictCall final : public CallBase {
+ public:
+  // Requests the next Predict call on 'cq'.
+  static void RequestNext(AsyncPredictionServiceImpl* parent,
+                          ::grpc::ServerCompletionQueue* cq) {
+    // Owns itself from here on; see Proceed().
+    PredictCall* call = new PredictCall(parent, cq);
+    parent->generic_service_.RequestCall(&call->context_, &call->stream_, cq,
+                                         cq, call);
+  }
+
+  ~PredictCall() override { parent_->DecrementLiveCalls(); }
+
+  void Proceed(const bool ok) override {
+    switch (state_) {
+      case State::kRequested:
+        if (!ok) {
+          // The server is shutting down; no call was received.
+          delete this;
+          return;
+        }
+        RequestNext(parent_, cq_);
+        if (context_.method() != kPredictMethod) {
+          state_ = State::kFinishing;
+          stream_.Finish(
+              ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED,
+                             strings::StrCat("Unknown method: ",
+                                             context_.method())),
+              this);
+          return;
+        }
+        state_ = State::kReading;
+        stream_.Read(&request_buffer_, this);
+        return;
+      case State::kReading:
+        // Set before handing the call off, since it may be finished (and
+        // Proceed() invoked again) before Schedule() returns.
+        state_ = State::kFinishing;
+        if (!ok) {
+          stream_.Finish(::grpc::Status(::grpc::StatusCode::INTERNAL,
+                                        "Failed to read the request"),
+                         this);
+          return;
+        }
+        parent_->inference_pool_->Schedule([this]() { Handle(); });
+        return;
+      case State::kFinishing:
+        delete this;
+        return;
+    }
+  }
+
+ private:
+  enum class State { kRequested, kReading, kFinishing };
+
+  PredictCall(AsyncPredictionServiceImpl* parent,
+              ::grpc::ServerCompletionQueue* cq)
+      : parent_(parent), cq_(cq), stream_(&context_) {
+    parent_->IncrementLiveCalls();
+  }
+
+  // Parses the request, runs it and finishes the call with its result.
+  void Handle() {
+    // See Call::Handle().
+    const gpr_timespec deadline = context_.raw_deadline();
+    if (gpr_time_cmp(deadline, gpr_now(deadline.clock_type)) < 0) {
+      stream_.Finish(
+          ::grpc::Status(::grpc::StatusCode::DEADLINE_EXCEEDED,
+                         "Deadline exceeded before the request was processed"),
+          this);
+      return;
+    }
+
+    // See Call::arena_.
+    protobuf::Arena arena;
+    PredictRequest* const request =
+        protobuf::Arena::CreateMessage<PredictRequest>(&arena);
+    std::map<string, Tensor> parsed_inputs;
+    {
+      // Each slice holds a reference to the received bytes it spans.
+      auto slices = std::make_shared<std::vector<::grpc::Slice>>();
+      if (!request_buffer_.Dump(slices.get()).ok()) {
+        stream_.Finish(::grpc::Status(::grpc::StatusCode::INTERNAL,
+                                      "Failed to read the request"),
+                       this);
+        return;
+      }
+      SliceInputStream input(slices.get());
+      // If aliasing, the input Tensors keep the slices alive.
+      const std::shared_ptr<void> input_owner =
+          parent_->options_.alias_request_buffers ? slices : nullptr;
+      const Status status =
+          ParsePredictRequest(&input, input_owner, request, &parsed_inputs);
+      if (!status.ok()) {
+        stream_.Finish(::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT,
+                                      status.error_message()),
+                       this);
+        return;
+      }
+    }
+    // The request's values are now held by 'parsed_inputs'.
+    request_buffer_.Clear();
+
+    PredictResponse* const response =
+        protobuf::Arena::CreateMessage<PredictResponse>(&arena);
+    ::grpc::Status status =
+        parent_->options_.prediction_service->PredictWithParsedInputs(
+            &context_, parsed_inputs, request, response);
+    if (status.ok()) {
+      bool own_buffer;
+      status = ::grpc::SerializationTraits<PredictResponse>::Serialize(
+          *response, &response_buffer_, &own_buffer);
+    }
+    if (!status.ok()) {
+      stream_.Finish(status, this);
+      return;
+    }
+    stream_.WriteAndFinish(response_buffer_, ::grpc::WriteOptions(),
+                           ::grpc::Status::OK, this);
+  }
+
+  AsyncPredictionServiceImpl* const parent_;
+  ::grpc::ServerCompletionQueue* const cq_;
+
+  State state_ = State::kRequested;
+  ::grpc::GenericServerContext context_;
+  ::grpc::GenericServerAsyncReaderWriter stream_;
+  ::grpc::ByteBuffer request_buffer_;
+  ::grpc::ByteBuffer response_buffer_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PredictCall);
+};
+
+AsyncPredictionServiceImpl::AsyncPredictionServiceImpl(const Options& options)
+    : options_(options),
+      inference_pool_(new thread::ThreadPool(
+          Env::Default(), "async_prediction_service_inference",
+          options.num_inference_threads)) {}
+
+AsyncPredictionServiceImpl::~AsyncPredictionServiceImpl() { Shutdown(); }
+
+void AsyncPredictionServiceImpl::RegisterWith(
+    ::grpc::ServerBuilder* const builder) {
+  builder->RegisterService(&service_);
+  builder->RegisterAsyncGenericService(&generic_service_);
+  for (int i = 0; i < options_.num_completion_queues; ++i) {
+    cqs_.push_back(builder->AddCompletionQueue());
+  }
+}
+
+void AsyncPredictionServiceImpl::Start() {
+  for (int i = 0; i < cqs_.size(); ++i) {
+    ::grpc::ServerCompletionQueue* const cq = cqs_[i].get();
+    RequestCalls(cq);
+    for (int j = 0; j < options_.num_polling_threads_per_queue; ++j) {
+      polling_threads_.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(),
+          strings::StrCat("async_prediction_service_cq_", i, "_", j),
+          [this, cq]() { PollCompletionQueue(cq); }));
+    }
+  }
+}
+
+void AsyncPredictionServiceImpl::Shutdown() {
+  {
+    mutex_lock l(mu_);
+    if (shut_down_) {
+      return;
+    }
+    shut_down_ = true;
+    // Once the server is shut down, every outstanding call either fails (if
+    // it was never received) or is finished by the inference pool, so this
+    // terminates.
+    while (num_live_calls_ > 0) {
+      live_calls_cv_.wait(l);
+    }
+  }
+  for (const auto& cq : cqs_) {
+    cq->Shutdown();
+  }
+  if (polling_threads_.empty()) {
+    // Never started; drain the queues here.
+    for (const auto& cq : cqs_) {
+      PollCompletionQueue(cq.get());
+    }
+  }
+  // Joins the polling threads, which return once their queue is drained.
+  polling_threads_.clear();
+  inference_pool_.reset();
+}
+
+void AsyncPredictionServiceImpl::RequestCalls(
+    ::grpc::ServerCompletionQueue* const cq) {
+  for (int i = 0; i < options_.num_pending_calls_per_method; ++i) {
+    PredictCall::RequestNext(this, cq);
+    Call<ClassificationRequest, ClassificationResponse>::RequestNext(
+        this, &AsyncService::RequestClassify, &PredictionServiceImpl::Classify,
+        false /* run_inline */, cq);
+    Call<RegressionRequest, RegressionResponse>::RequestNext(
+        this, &AsyncService::RequestRegress, &PredictionServiceImpl::Regress,
+        false /* run_inline */, cq);
+    Call<MultiInferenceRequest, MultiInferenceResponse>::RequestNext(
+        this, &AsyncService::RequestMultiInference,
+        &PredictionServiceImpl::MultiInference, false /* run_inline */, cq);
+    // Only reads the model's signatures, so is cheap enough to serve from the
+    // polling thread.
+    Call<GetModelMetadataRequest, GetModelMetadataResponse>::RequestNext(
+        this, &AsyncService::RequestGetModelMetadata,
+        &PredictionServiceImpl::GetModelMetadata, true /* run_inline */, cq);
+  }
+}
+
+void AsyncPredictionServiceImpl::PollCompletionQueue(
+    ::grpc::ServerCompletionQueue* const cq) {
+  void* tag;
+  bool ok;
+  while (cq->Next(&tag, &ok)) {
+    static_cast<CallBase*>(tag)->Proceed(ok);
+  }
+}
+
+void AsyncPredictionServiceImpl::IncrementLiveCalls() {
+  mutex_lock l(mu_);
+  ++num_live_calls_;
+}
+
+void AsyncPredictionServiceImpl::DecrementLiveCalls() {
+  mutex_lock l(mu_);
+  if (--num_live_calls_ == 0) {
+    live_calls_cv_.notify_all();
+  }
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,161 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_MODEL_SERVERS_ASYNC_PREDICTION_SERVICE_IMPL_H_
+#define TENSORFLOW_SERVING_MODEL_SERVERS_ASYNC_PREDICTION_SERVICE_IMPL_H_
+
+#include <memory>
+#include <vector>
+
+#include "grpcpp/completion_queue.h"
+#include "grpcpp/generic/async_generic_service.h"
+#include "grpcpp/server_builder.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
+#include "tensorflow_serving/model_servers/prediction_service_impl.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Serves the PredictionService API using gRPC's asynchronous (completion
+// queue) API, rather than the synchronous API used by PredictionServiceImpl.
+//
+// The synchronous API dedicates a gRPC thread to each in-flight call for the
+// whole duration of the call, including the time spent waiting in batching
+// queues and in Session::Run(). Under many concurrent streams this means
+// either many thousands of mostly-idle threads or calls queued inside gRPC.
+// Here, a small number of polling threads per completion queue only accept
+// calls and dispatch them; the (blocking) inference runs on a bounded pool of
+// inference threads, and each call is finished from that pool when the
+// inference completes. Calls that are accepted but not yet running cost only
+// memory, not threads.
+//
+// Predict is served as a generic (raw bytes) method: its requests are parsed
+// with ParsePredictRequest() straight from gRPC's receive buffers, so that
+// large packed inputs (tensor_content) are copied once, into their Tensors,
+// rather than into the request proto and then again into Tensors. With
+// Options::alias_request_buffers, they need not be copied at all.
+//
+// Request handling itself (timeouts, request logging, error conversion) is
+// delegated to a PredictionServiceImpl, so both APIs behave identically.
+//
+// Typical usage:
+//
+//   AsyncPredictionServiceImpl async_service(options);
+//   ::grpc::ServerBuilder builder;
+//   ...
+//   async_service.RegisterWith(&builder);
+//   std::unique_ptr<::grpc::Server> server = builder.BuildAndStart();
+//   async_service.Start();
+//   ...
+//   server->Shutdown();
+//   async_service.Shutdown();
+class AsyncPredictionServiceImpl {
+ public:
+  struct Options {
+    // The handlers used to serve each call. Not owned. Must outlive this
+    // object.
+    PredictionServiceImpl* prediction_service = nullptr;
+
+    // The number of completion queues used to accept and complete calls, and
+    // the number of threads polling each of them.
+    int num_completion_queues = 1;
+    int num_polling_threads_per_queue = 1;
+
+    // The number of threads running inference, i.e. the maximum number of
+    // calls that are processed concurrently. Other accepted calls wait for a
+    // free thread.
+    int num_inference_threads = 64;
+
+    // The number of calls of each method that are requested up-front on each
+    // completion queue, i.e. the number of calls of a method that can be
+    // accepted simultaneously on a queue.
+    int num_pending_calls_per_method = 16;
+
+    // If true, Predict inputs held in tensor_content are not copied at all if
+    // gRPC received them contiguously and suitably aligned: their Tensors
+    // refer to gRPC's receive buffers, and keep them alive, instead. Saves a
+    // copy of large inputs, but keeps the whole request in memory for as long
+    // as any of its input Tensors lives, and lets kernels that update their
+    // inputs in place write to the receive buffers.
+    bool alias_request_buffers = false;
+  };
+
+  explicit AsyncPredictionServiceImpl(const Options& options);
+
+  // Calls Shutdown().
+  ~AsyncPredictionServiceImpl();
+
+  // Registers the service, and its completion queues, with 'builder'. Must be
+  // called exactly once, before the server is built.
+  void RegisterWith(::grpc::ServerBuilder* builder);
+
+  // Starts accepting calls. Must be called after the server built by the
+  // builder passed to RegisterWith() has been started.
+  void Start();
+
+  // Finishes all in-flight calls, and stops the polling and inference
+  // threads. Must be called after the server has been shut down. Idempotent.
+  void Shutdown();
+
+ private:
+  class CallBase;
+  template <typename Request, typename Response>
+  class Call;
+  class PredictCall;
+
+  // All methods but Predict, which is served by 'generic_service_'.
+  using AsyncService = PredictionService::WithAsyncMethod_Classify<
+      PredictionService::WithAsyncMethod_Regress<
+          PredictionService::WithGenericMethod_Predict<
+              PredictionService::WithAsyncMethod_MultiInference<
+                  PredictionService::WithAsyncMethod_GetModelMetadata<
+                      PredictionService::Service>>>>>;
+
+  // Requests the first calls of every method on 'cq'.
+  void RequestCalls(::grpc::ServerCompletionQueue* cq);
+
+  // Processes the events of 'cq' until it is shut down and drained.
+  void PollCompletionQueue(::grpc::ServerCompletionQueue* cq);
+
+  // Tracks the number of live calls, so that Shutdown() can wait for them to
+  // finish before shutting down the completion queues.
+  void IncrementLiveCalls();
+  void DecrementLiveCalls();
+
+  const Options options_;
+  AsyncService service_;
+  ::grpc::AsyncGenericService generic_service_;
+  std::vector<std::unique_ptr<::grpc::ServerCompletionQueue>> cqs_;
+  std::unique_ptr<thread::ThreadPool> inference_pool_;
+  std::vector<std::unique_ptr<Thread>> polling_threads_;
+
+  mutex mu_;
+  condition_variable live_calls_cv_;
+  int64 num_live_calls_ GUARDED_BY(mu_) = 0;
+  bool shut_down_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AsyncPredictionServiceImpl);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_MODEL_SERVERS_ASYNC_PREDICTION_SERVICE_IMPL_H_
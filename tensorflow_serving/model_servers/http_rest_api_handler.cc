@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/cc/saved_model/loader.h"
 #include "tensorflow/cc/saved_model/signature_constants.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow_serving/apis/model.pb.h"
 #include "tensorflow_serving/apis/predict.pb.h"
 #include "tensorflow_serving/core/servable_handle.h"
@@ -81,6 +82,20 @@ Status HttpRestApiHandler::ProcessRequest(
     const absl::string_view http_method, const absl::string_view request_path,
     const absl::string_view request_body,
     std::vector<std::pair<string, string>>* headers, string* output) {
+  absl::string_view unread_body = request_body;
+  return ProcessRequest(http_method, request_path,
+                        [&unread_body]() {
+                          const absl::string_view chunk = unread_body;
+                          unread_body = absl::string_view();
+                          return chunk;
+                        },
+                        headers, output);
+}
+
+Status HttpRestApiHandler::ProcessRequest(
+    const absl::string_view http_method, const absl::string_view request_path,
+    const JsonChunkReader& read_request_body,
+    std::vector<std::pair<string, string>>* headers, string* output) {
   headers->clear();
   output->clear();
   AddHeaders(headers);
@@ -103,14 +118,14 @@ Status HttpRestApiHandler::ProcessRequest(
       model_version = version;
     }
     if (method == "classify") {
-      status = ProcessClassifyRequest(model_name, model_version, request_body,
-                                      output);
+      status = ProcessClassifyRequest(model_name, model_version,
+                                      read_request_body, output);
     } else if (method == "regress") {
-      status = ProcessRegressRequest(model_name, model_version, request_body,
-                                     output);
+      status = ProcessRegressRequest(model_name, model_version,
+                                     read_request_body, output);
     } else if (method == "predict") {
-      status = ProcessPredictRequest(model_name, model_version, request_body,
-                                     output);
+      status = ProcessPredictRequest(model_name, model_version,
+                                     read_request_body, output);
     }
   } else if (http_method == "GET" &&
              RE2::FullMatch(string(request_path), modelstatus_api_regex_,
@@ -133,65 +148,79 @@ Status HttpRestApiHandler::ProcessRequest(
 Status HttpRestApiHandler::ProcessClassifyRequest(
     const absl::string_view model_name,
     const absl::optional<int64>& model_version,
-    const absl::string_view request_body, string* output) {
-  ClassificationRequest request;
-  request.mutable_model_spec()->set_name(string(model_name));
+    const JsonChunkReader& read_request_body, string* output) {
+  // The request and response are built on an arena, and freed with it at
+  // once (classification results have a message per class per example).
+  protobuf::Arena arena;
+  auto* const request =
+      protobuf::Arena::CreateMessage<ClassificationRequest>(&arena);
+  request->mutable_model_spec()->set_name(string(model_name));
   if (model_version.has_value()) {
-    request.mutable_model_spec()->mutable_version()->set_value(
+    request->mutable_model_spec()->mutable_version()->set_value(
         model_version.value());
   }
-  TF_RETURN_IF_ERROR(FillClassificationRequestFromJson(request_body, &request));
+  TF_RETURN_IF_ERROR(
+      FillClassificationRequestFromJson(read_request_body, request));
 
-  ClassificationResponse response;
+  auto* const response =
+      protobuf::Arena::CreateMessage<ClassificationResponse>(&arena);
   TF_RETURN_IF_ERROR(TensorflowClassificationServiceImpl::Classify(
-      run_options_, core_, request, &response));
+      run_options_, core_, *request, response));
   TF_RETURN_IF_ERROR(
-      MakeJsonFromClassificationResult(response.result(), output));
+      MakeJsonFromClassificationResult(response->result(), output));
   return Status::OK();
 }
 
 Status HttpRestApiHandler::ProcessRegressRequest(
     const absl::string_view model_name,
     const absl::optional<int64>& model_version,
-    const absl::string_view request_body, string* output) {
-  RegressionRequest request;
-  request.mutable_model_spec()->set_name(string(model_name));
+    const JsonChunkReader& read_request_body, string* output) {
+  // See ProcessClassifyRequest().
+  protobuf::Arena arena;
+  auto* const request =
+      protobuf::Arena::CreateMessage<RegressionRequest>(&arena);
+  request->mutable_model_spec()->set_name(string(model_name));
   if (model_version.has_value()) {
-    request.mutable_model_spec()->mutable_version()->set_value(
+    request->mutable_model_spec()->mutable_version()->set_value(
         model_version.value());
   }
-  TF_RETURN_IF_ERROR(FillRegressionRequestFromJson(request_body, &request));
+  TF_RETURN_IF_ERROR(FillRegressionRequestFromJson(read_request_body, request));
 
-  RegressionResponse response;
+  auto* const response =
+      protobuf::Arena::CreateMessage<RegressionResponse>(&arena);
   TF_RETURN_IF_ERROR(TensorflowRegressionServiceImpl::Regress(
-      run_options_, core_, request, &response));
-  TF_RETURN_IF_ERROR(MakeJsonFromRegressionResult(response.result(), output));
+      run_options_, core_, *request, response));
+  TF_RETURN_IF_ERROR(MakeJsonFromRegressionResult(response->result(), output));
   return Status::OK();
 }
 
 Status HttpRestApiHandler::ProcessPredictRequest(
     const absl::string_view model_name,
     const absl::optional<int64>& model_version,
-    const absl::string_view request_body, string* output) {
-  PredictRequest request;
-  request.mutable_model_spec()->set_name(string(model_name));
+    const JsonChunkReader& read_request_body, string* output) {
+  // See ProcessClassifyRequest(). The TensorProtos of the inputs are filled
+  // in place, and so are on the arena too.
+  protobuf::Arena arena;
+  auto* const request = protobuf::Arena::CreateMessage<PredictRequest>(&arena);
+  request->mutable_model_spec()->set_name(string(model_name));
   if (model_version.has_value()) {
-    request.mutable_model_spec()->mutable_version()->set_value(
+    request->mutable_model_spec()->mutable_version()->set_value(
         model_version.value());
   }
   JsonPredictRequestFormat format;
   TF_RETURN_IF_ERROR(FillPredictRequestFromJson(
-      request_body,
-      [this, &request](const string& sig,
-                       ::google::protobuf::Map<string, TensorInfo>* map) {
-        return this->GetInfoMap(request.model_spec(), sig, map);
+      read_request_body,
+      [this, request](const string& sig,
+                      ::google::protobuf::Map<string, TensorInfo>* map) {
+        return this->GetInfoMap(request->model_spec(), sig, map);
       },
-      &request, &format));
+      request, &format));
 
-  PredictResponse response;
+  auto* const response =
+      protobuf::Arena::CreateMessage<PredictResponse>(&arena);
   TF_RETURN_IF_ERROR(
-      predictor_->Predict(run_options_, core_, request, &response));
-  TF_RETURN_IF_ERROR(MakeJsonFromTensors(response.outputs(), format, output));
+      predictor_->Predict(run_options_, core_, *request, response));
+  TF_RETURN_IF_ERROR(MakeJsonFromTensors(response->outputs(), format, output));
   return Status::OK();
 }
 
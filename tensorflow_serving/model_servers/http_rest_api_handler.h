@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow_serving/util/json_tensor.h"
 
 namespace tensorflow {
 
@@ -84,18 +85,26 @@ class HttpRestApiHandler {
                         std::vector<std::pair<string, string>>* headers,
                         string* output);
 
+  // Same as above, but the request body is parsed as it is read, one chunk
+  // at a time, from `read_request_body`.
+  Status ProcessRequest(const absl::string_view http_method,
+                        const absl::string_view request_path,
+                        const JsonChunkReader& read_request_body,
+                        std::vector<std::pair<string, string>>* headers,
+                        string* output);
+
  private:
   Status ProcessClassifyRequest(const absl::string_view model_name,
                                 const absl::optional<int64>& model_version,
-                                const absl::string_view request_body,
+                                const JsonChunkReader& read_request_body,
                                 string* output);
   Status ProcessRegressRequest(const absl::string_view model_name,
                                const absl::optional<int64>& model_version,
-                               const absl::string_view request_body,
+                               const JsonChunkReader& read_request_body,
                                string* output);
   Status ProcessPredictRequest(const absl::string_view model_name,
                                const absl::optional<int64>& model_version,
-                               const absl::string_view request_body,
+                               const JsonChunkReader& read_request_body,
                                string* output);
   Status ProcessModelStatusRequest(const absl::string_view model_name,
                                    const absl::string_view model_version_str,
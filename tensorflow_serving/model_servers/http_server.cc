@@ -16,7 +16,6 @@ limitations under the License.
 #include <cstdint>
 #include <memory>
 
-#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "re2/re2.h"
@@ -143,20 +142,29 @@ class RestApiRequestDispatcher {
 
  private:
   void ProcessRequest(net_http::ServerRequestInterface* req) {
-    string body;
-    int64_t num_bytes = 0;
-    auto request_chunk = req->ReadRequestBytes(&num_bytes);
-    while (request_chunk != nullptr) {
-      absl::StrAppend(&body, absl::string_view(request_chunk.get(), num_bytes));
+    // The body is parsed as it is read, and each chunk of it is freed once
+    // the next one is read, instead of first being gathered in a string.
+    std::unique_ptr<char[], net_http::BlockDeleter> request_chunk;
+    int64_t body_size = 0;
+    auto read_request_body = [req, &request_chunk, &body_size]() {
+      int64_t num_bytes = 0;
       request_chunk = req->ReadRequestBytes(&num_bytes);
-    }
+      if (request_chunk == nullptr) {
+        return absl::string_view();
+      }
+      body_size += num_bytes;
+      return absl::string_view(request_chunk.get(), num_bytes);
+    };
 
     std::vector<std::pair<string, string>> headers;
     string output;
     VLOG(1) << "Processing HTTP request: " << req->http_method() << " "
-            << req->uri_path() << " body: " << body.size() << " bytes.";
-    const auto status = handler_->ProcessRequest(
-        req->http_method(), req->uri_path(), body, &headers, &output);
+            << req->uri_path();
+    const auto status =
+        handler_->ProcessRequest(req->http_method(), req->uri_path(),
+                                 read_request_body, &headers, &output);
+    VLOG(1) << "Processed HTTP request: " << req->http_method() << " "
+            << req->uri_path() << " body: " << body_size << " bytes.";
     const auto http_status = ToHTTPStatusCode(status);
     // Note: we add headers+output for non successful status too, in case the
     // output contains details about the error (e.g. error messages).
@@ -178,11 +186,15 @@ class RestApiRequestDispatcher {
 }  // namespace
 
 std::unique_ptr<net_http::HTTPServerInterface> CreateAndStartHttpServer(
-    int port, int num_threads, int timeout_in_ms,
+    int port, int num_threads, int num_event_loops, int timeout_in_ms,
     const MonitoringConfig& monitoring_config, ServerCore* core) {
   auto options = absl::make_unique<net_http::ServerOptions>();
   options->AddPort(static_cast<uint32_t>(port));
-  options->SetExecutor(absl::make_unique<RequestExecutor>(num_threads));
+  options->SetNumEventLoops(num_event_loops);
+  // The event loops run on the executor too. The first one shares the
+  // request threads, as it always has; the others get threads of their own.
+  options->SetExecutor(absl::make_unique<RequestExecutor>(
+      num_threads + num_event_loops - 1));
 
   auto server = net_http::CreateEvHTTPServer(std::move(options));
   if (server == nullptr) {
@@ -209,6 +221,8 @@ std::unique_ptr<net_http::HTTPServerInterface> CreateAndStartHttpServer(
   std::shared_ptr<RestApiRequestDispatcher> dispatcher =
       std::make_shared<RestApiRequestDispatcher>(timeout_in_ms, core);
   net_http::RequestHandlerOptions handler_options;
+  // JSON tensor output compresses well; gzip it for clients that accept it.
+  handler_options.set_auto_compress_output(true);
   server->RegisterRequestDispatcher(
       [dispatcher](net_http::ServerRequestInterface* req) {
         return dispatcher->Dispatch(req);
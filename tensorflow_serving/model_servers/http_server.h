@@ -29,9 +29,11 @@ class ServerCore;
 //
 //   o HTTP/REST API (under /v1/models/...)
 //
-// The returned server is in a state of accepting new requests.
+// The returned server is in a state of accepting new requests. Requests are
+// handled on 'num_threads' threads; connections are served by
+// 'num_event_loops' event loops, each running on a thread of its own.
 std::unique_ptr<net_http::HTTPServerInterface> CreateAndStartHttpServer(
-    int port, int num_threads, int timeout_in_ms,
+    int port, int num_threads, int num_event_loops, int timeout_in_ms,
     const MonitoringConfig& monitoring_config, ServerCore* core);
 
 }  // namespace serving
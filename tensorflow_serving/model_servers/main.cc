@@ -63,6 +63,29 @@ int main(int argc, char** argv) {
                        "If non-empty, listen to a UNIX socket for gRPC API "
                        "on the given path. Can be either relative or absolute "
                        "path."),
+      tensorflow::Flag("grpc_num_completion_queues",
+                       &options.grpc_num_completion_queues,
+                       "If positive, serve the PredictionService with gRPC's "
+                       "asynchronous API using this many completion queues, "
+                       "so that in-flight requests do not each hold a gRPC "
+                       "thread. If zero, the synchronous API is used."),
+      tensorflow::Flag("grpc_num_polling_threads_per_queue",
+                       &options.grpc_num_polling_threads_per_queue,
+                       "Number of threads polling each gRPC completion queue. "
+                       "Only used if --grpc_num_completion_queues > 0."),
+      tensorflow::Flag("grpc_num_inference_threads",
+                       &options.grpc_num_inference_threads,
+                       "Maximum number of gRPC requests processed "
+                       "concurrently. Only used if "
+                       "--grpc_num_completion_queues > 0. If not set, will be "
+                       "auto set based on number of CPUs."),
+      tensorflow::Flag("grpc_alias_request_buffers",
+                       &options.grpc_alias_request_buffers,
+                       "If true, Predict inputs in tensor_content are fed to "
+                       "the model straight from gRPC's receive buffers where "
+                       "possible, rather than copied. The buffers then stay "
+                       "in memory for as long as the inputs do. Only used if "
+                       "--grpc_num_completion_queues > 0."),
       tensorflow::Flag("rest_api_port", &options.http_port,
                        "Port to listen on for HTTP/REST API. If set to zero "
                        "HTTP/REST API will not be exported. This port must be "
@@ -70,6 +93,12 @@ int main(int argc, char** argv) {
       tensorflow::Flag("rest_api_num_threads", &options.http_num_threads,
                        "Number of threads for HTTP/REST API processing. If not "
                        "set, will be auto set based on number of CPUs."),
+      tensorflow::Flag("rest_api_num_event_loops",
+                       &options.http_num_event_loops,
+                       "Number of event loops accepting and reading HTTP/REST "
+                       "API connections. Values above 1 open one SO_REUSEPORT "
+                       "listener per loop on --rest_api_port, letting the "
+                       "kernel balance connections across them."),
       tensorflow::Flag("rest_api_timeout_in_ms", &options.http_timeout_in_ms,
                        "Timeout for HTTP/REST API calls."),
       tensorflow::Flag("enable_batching", &options.enable_batching,
@@ -86,6 +115,12 @@ int main(int argc, char** argv) {
                        "specify multiple models to serve and other advanced "
                        "parameters including non-default version policy. (If "
                        "used, --model_name, --model_base_path are ignored.)"),
+      tensorflow::Flag("model_config_file_poll_wait_seconds",
+                       &options.model_config_file_poll_wait_seconds,
+                       "If positive, --model_config_file is re-read this "
+                       "often, in seconds, and changes to it are applied "
+                       "without restarting the server. Only the models whose "
+                       "config changed are touched."),
       tensorflow::Flag("model_name", &options.model_name,
                        "name of model (ignored "
                        "if --model_config_file flag is set)"),
@@ -106,6 +141,20 @@ int main(int argc, char** argv) {
                        &options.file_system_poll_wait_seconds,
                        "interval in seconds between each poll of the file "
                        "system for new model version"),
+      tensorflow::Flag("watch_file_system", &options.watch_file_system,
+                       "If true, model base paths on the local file system "
+                       "are watched (using inotify, on Linux), and new model "
+                       "versions are picked up as soon as they appear rather "
+                       "than at the next file system poll"),
+      tensorflow::Flag("model_cache_dir", &options.model_cache_dir,
+                       "If non-empty, a local directory that model versions "
+                       "are copied into as soon as they appear under their "
+                       "base path, and loaded from. Useful when model base "
+                       "paths are on a slow or remote file system"),
+      tensorflow::Flag("model_cache_max_bytes", &options.model_cache_max_bytes,
+                       "The maximum total size of the model versions in "
+                       "--model_cache_dir. Least recently used versions are "
+                       "evicted first. 0 means no limit"),
       tensorflow::Flag("flush_filesystem_caches",
                        &options.flush_filesystem_caches,
                        "If true (the default), filesystem caches will be "
@@ -161,6 +210,21 @@ int main(int argc, char** argv) {
                        "Enables model warmup, which triggers lazy "
                        "initializations (such as TF optimizations) at load "
                        "time, to reduce first request latency."),
+      tensorflow::Flag("enable_session_service",
+                       &options.enable_session_service,
+                       "If true, exports the SessionService gRPC API, which "
+                       "runs the model's session with the feeds and fetches "
+                       "of a request. Only tensors of the model's signatures "
+                       "may be fed or fetched."),
+      tensorflow::Flag("predict_response_use_tensor_content",
+                       &options.predict_response_use_tensor_content,
+                       "If true, Predict responses return output tensors "
+                       "packed into TensorProto.tensor_content instead of the "
+                       "typed repeated fields (e.g. float_val). Much cheaper "
+                       "to serialize and parse for large outputs, but "
+                       "requires clients that read tensor_content. Requests "
+                       "can also opt in with PredictRequest."
+                       "use_tensor_content."),
       tensorflow::Flag("version", &display_version, "Display version"),
       tensorflow::Flag(
           "monitoring_config_file", &options.monitoring_config_file,
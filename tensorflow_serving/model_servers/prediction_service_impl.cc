@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow_serving/model_servers/prediction_service_impl.h"
 
 #include "grpc/grpc.h"
+#include "tensorflow_serving/core/logging.pb.h"
 #include "tensorflow_serving/model_servers/grpc_status_util.h"
 #include "tensorflow_serving/servables/tensorflow/classification_service.h"
 #include "tensorflow_serving/servables/tensorflow/get_model_metadata_impl.h"
@@ -33,6 +34,20 @@ int DeadlineToTimeoutMillis(const gpr_timespec deadline) {
                    gpr_now(GPR_CLOCK_MONOTONIC)));
 }
 
+// Offers a successfully served request to the server's request logger, which
+// samples the requests of models configured with a logging_config (e.g. to
+// capture warmup requests).
+void LogRequest(ServerCore *core, const ModelSpec &model_spec,
+                const google::protobuf::Message &request,
+                const google::protobuf::Message &response) {
+  LogMetadata log_metadata;
+  *log_metadata.mutable_model_spec() = model_spec;
+  const Status status = core->Log(request, response, log_metadata);
+  if (!status.ok()) {
+    VLOG(1) << "Failed to log request: " << status.error_message();
+  }
+}
+
 }  // namespace
 
 ::grpc::Status PredictionServiceImpl::Predict(::grpc::ServerContext *context,
@@ -49,6 +64,31 @@ int DeadlineToTimeoutMillis(const gpr_timespec deadline) {
 
   if (!status.ok()) {
     VLOG(1) << "Predict failed: " << status.error_message();
+  } else {
+    LogRequest(core_, response->model_spec(), *request, *response);
+  }
+  return status;
+}
+
+::grpc::Status PredictionServiceImpl::PredictWithParsedInputs(
+    ::grpc::ServerContext *context,
+    const std::map<string, Tensor> &parsed_inputs, PredictRequest *request,
+    PredictResponse *response) {
+  tensorflow::RunOptions run_options = tensorflow::RunOptions();
+  if (enforce_session_run_timeout_) {
+    run_options.set_timeout_in_ms(
+        DeadlineToTimeoutMillis(context->raw_deadline()));
+  }
+
+  const ::grpc::Status status =
+      ToGRPCStatus(predictor_->PredictWithParsedInputs(
+          run_options, core_, parsed_inputs, *request, response));
+
+  if (!status.ok()) {
+    VLOG(1) << "Predict failed: " << status.error_message();
+  } else if (core_->IsRequestLoggingEnabled(response->model_spec().name())) {
+    RestoreParsedInputs(parsed_inputs, request);
+    LogRequest(core_, response->model_spec(), *request, *response);
   }
   return status;
 }
@@ -83,6 +123,8 @@ int DeadlineToTimeoutMillis(const gpr_timespec deadline) {
           run_options, core_, *request, response));
   if (!status.ok()) {
     VLOG(1) << "Classify request failed: " << status.error_message();
+  } else {
+    LogRequest(core_, response->model_spec(), *request, *response);
   }
   return status;
 }
@@ -101,6 +143,8 @@ int DeadlineToTimeoutMillis(const gpr_timespec deadline) {
           run_options, core_, *request, response));
   if (!status.ok()) {
     VLOG(1) << "Regress request failed: " << status.error_message();
+  } else {
+    LogRequest(core_, response->model_spec(), *request, *response);
   }
   return status;
 }
@@ -118,6 +162,8 @@ int DeadlineToTimeoutMillis(const gpr_timespec deadline) {
       RunMultiInferenceWithServerCore(run_options, core_, *request, response));
   if (!status.ok()) {
     VLOG(1) << "MultiInference request failed: " << status.error_message();
+  } else if (request->tasks_size() > 0) {
+    LogRequest(core_, request->tasks(0).model_spec(), *request, *response);
   }
   return status;
 }
@@ -16,9 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_SERVING_MODEL_SERVERS_PREDICTION_SERVICE_IMPL_H_
 #define TENSORFLOW_SERVING_MODEL_SERVERS_PREDICTION_SERVICE_IMPL_H_
 
+#include <map>
+
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow_serving/apis/prediction_service.grpc.pb.h"
 #include "tensorflow_serving/model_servers/server_core.h"
 #include "tensorflow_serving/servables/tensorflow/predict_impl.h"
+#include "tensorflow_serving/servables/tensorflow/predict_util.h"
 
 namespace tensorflow {
 namespace serving {
@@ -30,11 +34,18 @@ class PredictionServiceImpl final : public PredictionService::Service {
     ServerCore* server_core;
     bool use_saved_model;
     bool enforce_session_run_timeout;
+    // How Predict encodes output tensors (requests may additionally opt into
+    // tensor_content).
+    PredictResponseTensorSerializationOption
+        predict_response_tensor_serialization_option =
+            PredictResponseTensorSerializationOption::kAsProtoField;
   };
 
   explicit PredictionServiceImpl(const Options& options)
       : core_(options.server_core),
-        predictor_(new TensorflowPredictor(options.use_saved_model)),
+        predictor_(new TensorflowPredictor(
+            options.use_saved_model,
+            options.predict_response_tensor_serialization_option)),
         use_saved_model_(options.use_saved_model),
         enforce_session_run_timeout_(options.enforce_session_run_timeout) {}
 
@@ -42,6 +53,14 @@ class PredictionServiceImpl final : public PredictionService::Service {
                          const PredictRequest* request,
                          PredictResponse* response) override;
 
+  // Like Predict(), for a request parsed with ParsePredictRequest(). The
+  // values of 'parsed_inputs' are put back into 'request' only if the request
+  // is going to be logged.
+  ::grpc::Status PredictWithParsedInputs(
+      ::grpc::ServerContext* context,
+      const std::map<string, Tensor>& parsed_inputs, PredictRequest* request,
+      PredictResponse* response);
+
   ::grpc::Status GetModelMetadata(::grpc::ServerContext* context,
                                   const GetModelMetadataRequest* request,
                                   GetModelMetadataResponse* response) override;
@@ -39,10 +39,12 @@ limitations under the License.
 #include "tensorflow_serving/config/monitoring_config.pb.h"
 #include "tensorflow_serving/config/ssl_config.pb.h"
 #include "tensorflow_serving/core/availability_preserving_policy.h"
+#include "tensorflow_serving/core/server_request_logger.h"
 #include "tensorflow_serving/model_servers/grpc_status_util.h"
 #include "tensorflow_serving/model_servers/model_platform_types.h"
 #include "tensorflow_serving/model_servers/platform_config_util.h"
 #include "tensorflow_serving/model_servers/server_core.h"
+#include "tensorflow_serving/servables/tensorflow/prediction_log_request_logger.h"
 #include "tensorflow_serving/servables/tensorflow/session_bundle_config.pb.h"
 
 namespace tensorflow {
@@ -169,7 +171,14 @@ Server::Options::Options()
     : model_name("default"),
       saved_model_tags(tensorflow::kSavedModelTagServe) {}
 
-Server::~Server() { WaitForTermination(); }
+Server::~Server() {
+  WaitForTermination();
+  // The gRPC server has shut down, so the asynchronous service's calls can
+  // now be drained.
+  if (async_prediction_service_ != nullptr) {
+    async_prediction_service_->Shutdown();
+  }
+}
 
 Status Server::BuildAndStart(const Options& server_options) {
   const bool use_saved_model = true;
@@ -185,6 +194,11 @@ Status Server::BuildAndStart(const Options& server_options) {
         "server_options.model_config_file are empty!");
   }
 
+  if (server_options.http_num_event_loops < 1) {
+    return errors::InvalidArgument(
+        "server_options.http_num_event_loops must be positive.");
+  }
+
   // For ServerCore Options, we leave servable_state_monitor_creator unspecified
   // so the default servable_state_monitor_creator will be used.
   ServerCore::Options options;
@@ -194,6 +208,10 @@ Status Server::BuildAndStart(const Options& server_options) {
     options.model_server_config = BuildSingleModelConfig(
         server_options.model_name, server_options.model_base_path);
   } else {
+    FileStatistics stat;
+    if (Env::Default()->Stat(server_options.model_config_file, &stat).ok()) {
+      model_config_file_mtime_nsec_ = stat.mtime_nsec;
+    }
     options.model_server_config =
         ReadProtoFromFile<ModelServerConfig>(server_options.model_config_file);
   }
@@ -269,10 +287,32 @@ Status Server::BuildAndStart(const Options& server_options) {
       server_options.load_retry_interval_micros;
   options.file_system_poll_wait_seconds =
       server_options.file_system_poll_wait_seconds;
+  options.watch_file_system = server_options.watch_file_system;
+  options.model_cache_config.set_cache_dir(server_options.model_cache_dir);
+  options.model_cache_config.set_max_cache_bytes(
+      server_options.model_cache_max_bytes);
   options.flush_filesystem_caches = server_options.flush_filesystem_caches;
+  // Models configured with a logging_config have their requests logged as
+  // PredictionLogs, e.g. to the "warmup_capture" log collector.
+  TF_RETURN_IF_ERROR(
+      ServerRequestLogger::Create(&PredictionLogRequestLogger::Create,
+                                  &options.server_request_logger));
 
   TF_RETURN_IF_ERROR(ServerCore::Create(std::move(options), &server_core_));
 
+  if (!server_options.model_config_file.empty() &&
+      server_options.model_config_file_poll_wait_seconds > 0) {
+    PeriodicFunction::Options pf_options;
+    pf_options.thread_name_prefix = "Server_model_config_file_polling_thread";
+    const string model_config_file = server_options.model_config_file;
+    model_config_file_poller_.reset(new PeriodicFunction(
+        [this, model_config_file] {
+          PollModelConfigFileAndReloadConfig(model_config_file);
+        },
+        server_options.model_config_file_poll_wait_seconds * 1000000LL,
+        pf_options));
+  }
+
   // 0.0.0.0" is the way to listen on localhost in gRPC.
   const string server_address =
       "0.0.0.0:" + std::to_string(server_options.grpc_port);
@@ -283,8 +323,21 @@ Status Server::BuildAndStart(const Options& server_options) {
   predict_server_options.use_saved_model = use_saved_model;
   predict_server_options.enforce_session_run_timeout =
       server_options.enforce_session_run_timeout;
+  predict_server_options.predict_response_tensor_serialization_option =
+      server_options.predict_response_use_tensor_content
+          ? PredictResponseTensorSerializationOption::kAsProtoContent
+          : PredictResponseTensorSerializationOption::kAsProtoField;
   prediction_service_ =
       absl::make_unique<PredictionServiceImpl>(predict_server_options);
+
+  if (server_options.enable_session_service) {
+    SessionServiceImpl::Options session_service_options;
+    session_service_options.server_core = server_core_.get();
+    session_service_options.enforce_session_run_timeout =
+        server_options.enforce_session_run_timeout;
+    session_service_ =
+        absl::make_unique<SessionServiceImpl>(session_service_options);
+  }
   ::grpc::ServerBuilder builder;
   builder.AddListeningPort(
       server_address,
@@ -297,7 +350,26 @@ Status Server::BuildAndStart(const Options& server_options) {
                                  server_options.ssl_config_file));
   }
   builder.RegisterService(model_service_.get());
-  builder.RegisterService(prediction_service_.get());
+  if (server_options.grpc_num_completion_queues > 0) {
+    AsyncPredictionServiceImpl::Options async_options;
+    async_options.prediction_service = prediction_service_.get();
+    async_options.num_completion_queues =
+        server_options.grpc_num_completion_queues;
+    async_options.num_polling_threads_per_queue =
+        server_options.grpc_num_polling_threads_per_queue;
+    async_options.num_inference_threads =
+        server_options.grpc_num_inference_threads;
+    async_options.alias_request_buffers =
+        server_options.grpc_alias_request_buffers;
+    async_prediction_service_ =
+        absl::make_unique<AsyncPredictionServiceImpl>(async_options);
+    async_prediction_service_->RegisterWith(&builder);
+  } else {
+    builder.RegisterService(prediction_service_.get());
+  }
+  if (session_service_ != nullptr) {
+    builder.RegisterService(session_service_.get());
+  }
   builder.SetMaxMessageSize(tensorflow::kint32max);
   const std::vector<GrpcChannelArgument> channel_arguments =
       parseGrpcChannelArgs(server_options.grpc_channel_arguments);
@@ -316,6 +388,9 @@ Status Server::BuildAndStart(const Options& server_options) {
   if (grpc_server_ == nullptr) {
     return errors::InvalidArgument("Failed to BuildAndStart gRPC server");
   }
+  if (async_prediction_service_ != nullptr) {
+    async_prediction_service_->Start();
+  }
   LOG(INFO) << "Running gRPC ModelServer at " << server_address << " ...";
   if (!server_options.grpc_socket_path.empty()) {
     LOG(INFO) << "Running gRPC ModelServer at UNIX socket "
@@ -333,6 +408,7 @@ Status Server::BuildAndStart(const Options& server_options) {
       }
       http_server_ = CreateAndStartHttpServer(
           server_options.http_port, server_options.http_num_threads,
+          server_options.http_num_event_loops,
           server_options.http_timeout_in_ms, monitoring_config,
           server_core_.get());
       if (http_server_ != nullptr) {
@@ -349,6 +425,34 @@ Status Server::BuildAndStart(const Options& server_options) {
   return Status::OK();
 }
 
+void Server::PollModelConfigFileAndReloadConfig(
+    const string& model_config_file) {
+  FileStatistics stat;
+  const Status stat_status = Env::Default()->Stat(model_config_file, &stat);
+  if (!stat_status.ok()) {
+    LOG(ERROR) << "Unable to stat model config file " << model_config_file
+               << ": " << stat_status;
+    return;
+  }
+  if (stat.mtime_nsec == model_config_file_mtime_nsec_) {
+    return;
+  }
+  model_config_file_mtime_nsec_ = stat.mtime_nsec;
+
+  LOG(INFO) << "Model config file " << model_config_file
+            << " changed; reloading it";
+  ModelServerConfig config;
+  Status status = ParseProtoTextFile(model_config_file, &config);
+  if (status.ok()) {
+    // Only the models that changed are touched.
+    status = server_core_->ReloadConfig(config);
+  }
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to reload model config file " << model_config_file
+               << ": " << status;
+  }
+}
+
 void Server::WaitForTermination() {
   if (http_server_ != nullptr) {
     http_server_->WaitForTermination();
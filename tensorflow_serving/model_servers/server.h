@@ -19,13 +19,16 @@ limitations under the License.
 #include <memory>
 
 #include "grpcpp/server.h"
+#include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow_serving/model_servers/async_prediction_service_impl.h"
 #include "tensorflow_serving/model_servers/http_server.h"
 #include "tensorflow_serving/model_servers/model_service_impl.h"
 #include "tensorflow_serving/model_servers/prediction_service_impl.h"
 #include "tensorflow_serving/model_servers/server_core.h"
+#include "tensorflow_serving/model_servers/session_service_impl.h"
 
 namespace tensorflow {
 namespace serving {
@@ -40,12 +43,22 @@ class Server {
     tensorflow::int32 grpc_port = 8500;
     tensorflow::string grpc_channel_arguments;
     tensorflow::string grpc_socket_path;
+    // If positive, the PredictionService is served with gRPC's asynchronous
+    // API, using this many completion queues (see AsyncPredictionServiceImpl).
+    // Otherwise the synchronous API is used.
+    tensorflow::int32 grpc_num_completion_queues = 0;
+    tensorflow::int32 grpc_num_polling_threads_per_queue = 1;
+    tensorflow::int32 grpc_num_inference_threads =
+        4.0 * port::NumSchedulableCPUs();
+    // See AsyncPredictionServiceImpl::Options::alias_request_buffers.
+    bool grpc_alias_request_buffers = false;
 
     //
     // HTTP Server options.
     //
     tensorflow::int32 http_port = 0;
     tensorflow::int32 http_num_threads = 4.0 * port::NumSchedulableCPUs();
+    tensorflow::int32 http_num_event_loops = 1;
     tensorflow::int32 http_timeout_in_ms = 30000;  // 30 seconds.
 
     //
@@ -58,6 +71,9 @@ class Server {
     tensorflow::int32 max_num_load_retries = 5;
     tensorflow::int64 load_retry_interval_micros = 1LL * 60 * 1000 * 1000;
     tensorflow::int32 file_system_poll_wait_seconds = 1;
+    bool watch_file_system = false;
+    tensorflow::string model_cache_dir;
+    tensorflow::int64 model_cache_max_bytes = 0;
     bool flush_filesystem_caches = true;
     tensorflow::string model_base_path;
     tensorflow::string saved_model_tags;
@@ -71,10 +87,19 @@ class Server {
     tensorflow::string platform_config_file;
     tensorflow::string ssl_config_file;
     string model_config_file;
+    // If positive, 'model_config_file' is re-read this often, and any changes
+    // to it are applied (as by ModelService/HandleReloadConfigRequest).
+    tensorflow::int32 model_config_file_poll_wait_seconds = 0;
     bool enable_model_warmup = true;
+    // If true, SessionService is exported, letting clients feed and fetch
+    // the tensors of models' signatures directly.
+    bool enable_session_service = false;
     tensorflow::string monitoring_config_file;
     // Tensorflow session run options.
     bool enforce_session_run_timeout = true;
+    // If true, Predict returns output tensors of fixed-size types packed into
+    // TensorProto.tensor_content rather than the typed repeated fields.
+    bool predict_response_use_tensor_content = false;
 
     Options();
   };
@@ -92,11 +117,26 @@ class Server {
   void WaitForTermination();
 
  private:
+  // Re-reads the model config file if it has been modified since it was last
+  // read, and reloads the ServerCore's config from it.
+  void PollModelConfigFileAndReloadConfig(const string& model_config_file);
+
   std::unique_ptr<ServerCore> server_core_;
   std::unique_ptr<ModelServiceImpl> model_service_;
   std::unique_ptr<PredictionServiceImpl> prediction_service_;
+  // Set iff the PredictionService is served asynchronously, in which case it
+  // handles calls using 'prediction_service_'.
+  std::unique_ptr<AsyncPredictionServiceImpl> async_prediction_service_;
+  std::unique_ptr<SessionServiceImpl> session_service_;
   std::unique_ptr<::grpc::Server> grpc_server_;
   std::unique_ptr<net_http::HTTPServerInterface> http_server_;
+
+  // The modification time of the model config file when it was last read.
+  // Only accessed by 'model_config_file_poller_'.
+  tensorflow::int64 model_config_file_mtime_nsec_ = 0;
+  // Declared last, so that it stops before the state it accesses is
+  // destroyed.
+  std::unique_ptr<PeriodicFunction> model_config_file_poller_;
 };
 
 }  // namespace main
@@ -15,13 +15,17 @@ limitations under the License.
 
 #include "tensorflow_serving/model_servers/server_core.h"
 
+#include <map>
+#include <set>
 #include <utility>
 #include <vector>
 
 #include "google/protobuf/any.pb.h"
 #include "google/protobuf/wrappers.pb.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow_serving/core/load_servables_fast.h"
@@ -30,6 +34,7 @@ limitations under the License.
 #include "tensorflow_serving/servables/tensorflow/saved_model_bundle_source_adapter.h"
 #include "tensorflow_serving/servables/tensorflow/session_bundle_source_adapter.h"
 #include "tensorflow_serving/servables/tensorflow/session_bundle_source_adapter.pb.h"
+#include "tensorflow_serving/sources/storage_path/caching_storage_path_source_adapter.h"
 #include "tensorflow_serving/sources/storage_path/file_system_storage_path_source.h"
 #include "tensorflow_serving/sources/storage_path/file_system_storage_path_source.pb.h"
 
@@ -42,6 +47,15 @@ namespace serving {
 
 namespace {
 
+// Enables or disables the load governance of 'saved_model_adapters'.
+void SetLoadGovernanceEnabled(
+    const std::vector<SavedModelBundleSourceAdapter*>& saved_model_adapters,
+    const bool enabled) {
+  for (SavedModelBundleSourceAdapter* adapter : saved_model_adapters) {
+    adapter->SetLoadGovernanceEnabled(enabled);
+  }
+}
+
 // Gets the platform associated with a model.
 Status GetPlatform(const ModelConfig& model_config, string* platform) {
   if (model_config.model_type() != ModelType::MODEL_TYPE_UNSPECIFIED) {
@@ -187,6 +201,28 @@ std::set<string> NewModelNamesInSourceConfig(
   return new_models;
 }
 
+// Returns whether two messages have the same contents.
+bool ProtosEqual(const protobuf::Message& a, const protobuf::Message& b) {
+  string serialized_a, serialized_b;
+  return SerializeToStringDeterministic(a, &serialized_a) &&
+         SerializeToStringDeterministic(b, &serialized_b) &&
+         serialized_a == serialized_b;
+}
+
+// Returns whether two models are assigned the same version labels.
+bool SameVersionLabels(const ModelConfig& a, const ModelConfig& b) {
+  if (a.version_labels().size() != b.version_labels().size()) {
+    return false;
+  }
+  for (const auto& entry : a.version_labels()) {
+    auto it = b.version_labels().find(entry.first);
+    if (it == b.version_labels().end() || it->second != entry.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // Updates the base_path fields in each ModelConfig, prepending an
 // absolute model_config_list_root_dir.
 // It is assumed that initially, all the base_path fields are relative.
@@ -216,6 +252,15 @@ Status UpdateModelConfigListRelativePaths(
   return Status::OK();
 }
 
+// Gets the options for the servable event bus.
+EventBus<ServableState>::Options GetServableEventBusOptions(
+    const ServerCore::Options& options) {
+  EventBus<ServableState>::Options bus_options;
+  bus_options.max_queued_events = options.servable_event_bus_max_queued_events;
+  bus_options.name = "servable_state";
+  return bus_options;
+}
+
 }  // namespace
 
 // ************************************************************************
@@ -255,7 +300,8 @@ Status ServerCore::Create(Options options,
 
 ServerCore::ServerCore(Options options)
     : options_(std::move(options)),
-      servable_event_bus_(EventBus<ServableState>::CreateEventBus()) {
+      servable_event_bus_(EventBus<ServableState>::CreateEventBus(
+          GetServableEventBusOptions(options_))) {
   // Number the platforms. (The proto map iteration order is nondeterministic,
   // but we don't care since the numbering is arbitrary.)
   int port_num = 0;
@@ -321,34 +367,115 @@ Status ServerCore::WaitUntilModelsAvailable(const std::set<string>& models,
   return Status::OK();
 }
 
-Status ServerCore::AddModelsViaModelConfigList() {
+// static
+ServerCore::ModelConfigListDiff ServerCore::DiffModelConfigLists(
+    const ModelConfigList& old_list, const ModelConfigList& new_list) {
+  std::map<string, const ModelConfig*> old_configs;
+  for (const ModelConfig& old_config : old_list.config()) {
+    old_configs[old_config.name()] = &old_config;
+  }
+
+  ModelConfigListDiff diff;
+  for (const ModelConfig& new_config : new_list.config()) {
+    const string& name = new_config.name();
+    auto it = old_configs.find(name);
+    if (it == old_configs.end()) {
+      diff.added_models.insert(name);
+      if (!new_config.version_labels().empty()) {
+        diff.relabeled_models.insert(name);
+      }
+      diff.logging_changed |= new_config.has_logging_config();
+      continue;
+    }
+    const ModelConfig& old_config = *it->second;
+    if (old_config.base_path() != new_config.base_path() ||
+        !ProtosEqual(old_config.model_version_policy(),
+                     new_config.model_version_policy())) {
+      diff.reloaded_models.insert(name);
+    }
+    if (!SameVersionLabels(old_config, new_config)) {
+      diff.relabeled_models.insert(name);
+    }
+    diff.logging_changed |=
+        old_config.has_logging_config() != new_config.has_logging_config() ||
+        !ProtosEqual(old_config.logging_config(), new_config.logging_config());
+    old_configs.erase(it);
+  }
+  for (const auto& entry : old_configs) {
+    const ModelConfig& old_config = *entry.second;
+    diff.removed_models.insert(old_config.name());
+    if (!old_config.version_labels().empty()) {
+      diff.relabeled_models.insert(old_config.name());
+    }
+    diff.logging_changed |= old_config.has_logging_config();
+  }
+  return diff;
+}
+
+Status ServerCore::AddModelsViaModelConfigList(
+    const ModelConfigListDiff& diff) {
   const bool is_first_config = storage_path_source_and_router_ == nullopt;
 
+  for (const string& model : diff.added_models) {
+    LOG(INFO) << " Adding model: " << model;
+  }
+  for (const string& model : diff.reloaded_models) {
+    LOG(INFO) << " Updating model: " << model;
+  }
+  for (const string& model : diff.removed_models) {
+    LOG(INFO) << " Removing model: " << model;
+  }
+  // The routes only depend on the set of models (whose platforms can't
+  // change), and the source config only on their base paths and version
+  // policies. Leave them alone unless those changed, so that e.g. relabeling
+  // a model doesn't cost as much as reloading the whole config.
+  const bool models_added_or_removed =
+      !diff.added_models.empty() || !diff.removed_models.empty();
+  const bool source_config_changed =
+      models_added_or_removed || !diff.reloaded_models.empty();
+  if (!is_first_config && !source_config_changed) {
+    return Status::OK();
+  }
+
   // Create/reload the source, source router and source adapters.
   const FileSystemStoragePathSourceConfig source_config =
       CreateStoragePathSourceConfig(config_);
   DynamicSourceRouter<StoragePath>::Routes routes;
-  TF_RETURN_IF_ERROR(CreateStoragePathRoutes(config_, &routes));
+  if (is_first_config || models_added_or_removed) {
+    TF_RETURN_IF_ERROR(CreateStoragePathRoutes(config_, &routes));
+  }
   if (is_first_config) {
     // Construct the following source topology:
-    //   Source -> Router -> Adapter_0 (for models using platform 0)
-    //                    -> Adapter_1 (for models using platform 1)
-    //                    -> ...
-    //                    -> ErrorAdapter (for unrecognized models)
+    //   Source [-> Cache] -> Router -> Adapter_0 (for models using platform 0)
+    //                               -> Adapter_1 (for models using platform 1)
+    //                               -> ...
+    //                               -> ErrorAdapter (for unrecognized models)
     SourceAdapters adapters;
     TF_RETURN_IF_ERROR(CreateAdapters(&adapters));
     std::unique_ptr<DynamicSourceRouter<StoragePath>> router;
     TF_RETURN_IF_ERROR(CreateRouter(routes, &adapters, &router));
+    Target<StoragePath>* source_target = router.get();
+    std::unique_ptr<CachingStoragePathSourceAdapter> cache;
+    if (!options_.model_cache_config.cache_dir().empty()) {
+      TF_RETURN_IF_ERROR(CachingStoragePathSourceAdapter::Create(
+          options_.model_cache_config, &cache));
+      ConnectSourceToTarget(cache.get(), router.get());
+      source_target = cache.get();
+    }
     std::unique_ptr<FileSystemStoragePathSource> source;
     TF_RETURN_IF_ERROR(
-        CreateStoragePathSource(source_config, router.get(), &source));
+        CreateStoragePathSource(source_config, source_target, &source));
 
     // Connect the adapters to the manager, and wait for the models to load.
     TF_RETURN_IF_ERROR(ConnectAdaptersToManagerAndAwaitModelLoads(&adapters));
 
     // Stow the source components.
     storage_path_source_and_router_ = {source.get(), router.get()};
+    saved_model_adapters_ = adapters.saved_model_adapters;
     manager_.AddDependency(std::move(source));
+    if (cache != nullptr) {
+      manager_.AddDependency(std::move(cache));
+    }
     manager_.AddDependency(std::move(router));
     for (auto& entry : adapters.platform_adapters) {
       auto& adapter = entry.second;
@@ -356,12 +483,24 @@ Status ServerCore::AddModelsViaModelConfigList() {
     }
     manager_.AddDependency(std::move(adapters.error_adapter));
   } else {
+    // As with the initial models, let the loads this config causes run flat
+    // out if the server isn't serving anything yet (e.g. because its previous
+    // configs had no models).
+    const std::vector<SavedModelBundleSourceAdapter*>& saved_model_adapters =
+        saved_model_adapters_;
+    SetLoadGovernanceEnabled(saved_model_adapters,
+                             !manager_->ListAvailableServableIds().empty());
+    auto enable_load_governance = gtl::MakeCleanup([&saved_model_adapters]() {
+      SetLoadGovernanceEnabled(saved_model_adapters, true);
+    });
+
     // Create a fresh servable state monitor, to avoid getting confused if we're
     // re-loading a model-version that has previously been unloaded.
     ServableStateMonitor fresh_servable_state_monitor(
         servable_event_bus_.get());
 
-    // Figure out which models are new.
+    // Figure out which models are new. (These are the added models, unless a
+    // previous config was only partially applied.)
     const std::set<string> new_models = NewModelNamesInSourceConfig(
         storage_path_source_and_router_->source->config(), source_config);
 
@@ -369,23 +508,27 @@ Status ServerCore::AddModelsViaModelConfigList() {
     // Manager pipeline ...
 
     // First, add the new routes without removing the old ones.
-    DynamicSourceRouter<StoragePath>::Routes old_and_new_routes;
-    const Status union_status =
-        UnionRoutes(storage_path_source_and_router_->router->GetRoutes(),
-                    routes, &old_and_new_routes);
-    if (!union_status.ok()) {
-      // ValidateNoModelsChangePlatforms() should have detected any conflict.
-      DCHECK(false);
-      return errors::Internal("Old and new routes conflict.");
+    if (models_added_or_removed) {
+      DynamicSourceRouter<StoragePath>::Routes old_and_new_routes;
+      const Status union_status =
+          UnionRoutes(storage_path_source_and_router_->router->GetRoutes(),
+                      routes, &old_and_new_routes);
+      if (!union_status.ok()) {
+        // ValidateNoModelsChangePlatforms() should have detected any conflict.
+        DCHECK(false);
+        return errors::Internal("Old and new routes conflict.");
+      }
+      TF_RETURN_IF_ERROR(ReloadRoutes(old_and_new_routes));
     }
-    TF_RETURN_IF_ERROR(ReloadRoutes(old_and_new_routes));
 
     // Change the source config. Among other things this will cause it to emit
     // tear-downs of any models that aren't present in the new config.
     TF_RETURN_IF_ERROR(ReloadStoragePathSourceConfig(source_config));
 
     // Now that any old models are out of the picture, remove the old routes.
-    TF_RETURN_IF_ERROR(ReloadRoutes(routes));
+    if (models_added_or_removed) {
+      TF_RETURN_IF_ERROR(ReloadRoutes(routes));
+    }
 
     // Wait for any new models to get loaded and become available.
     TF_RETURN_IF_ERROR(
@@ -455,19 +598,34 @@ Status ServerCore::ReloadConfig(const ModelServerConfig& new_config) {
     TF_RETURN_IF_ERROR(ValidateNoModelsChangePlatforms(
         config_.model_config_list(), new_config.model_config_list()));
   }
-  config_ = new_config;
+  ModelServerConfig resolved_config = new_config;
+  if (resolved_config.config_case() == ModelServerConfig::kModelConfigList &&
+      options_.model_config_list_root_dir) {
+    TF_RETURN_IF_ERROR(UpdateModelConfigListRelativePaths(
+        *options_.model_config_list_root_dir,
+        resolved_config.mutable_model_config_list()));
+  }
+
+  // Only apply what changed since the previous config, unless applying that
+  // one failed part way, in which case everything is (re-)applied.
+  const bool full_reload = is_first_config || !config_fully_applied_;
+  const ModelConfigListDiff diff = DiffModelConfigLists(
+      full_reload ? ModelConfigList() : config_.model_config_list(),
+      resolved_config.model_config_list());
+  if (!full_reload && diff.empty()) {
+    LOG(INFO) << "No model changes in the new config; nothing to do.";
+    return Status::OK();
+  }
+  config_ = std::move(resolved_config);
+  config_fully_applied_ = false;
 
-  TF_RETURN_IF_ERROR(UpdateModelVersionLabelMap());
+  TF_RETURN_IF_ERROR(UpdateModelVersionLabelMap(
+      full_reload ? nullptr : &diff.relabeled_models));
 
   LOG(INFO) << "Adding/updating models.";
   switch (config_.config_case()) {
     case ModelServerConfig::kModelConfigList: {
-      if (options_.model_config_list_root_dir) {
-        TF_RETURN_IF_ERROR(UpdateModelConfigListRelativePaths(
-            *options_.model_config_list_root_dir,
-            config_.mutable_model_config_list()));
-      }
-      TF_RETURN_IF_ERROR(AddModelsViaModelConfigList());
+      TF_RETURN_IF_ERROR(AddModelsViaModelConfigList(diff));
       break;
     }
     case ModelServerConfig::kCustomModelConfig: {
@@ -480,19 +638,43 @@ Status ServerCore::ReloadConfig(const ModelServerConfig& new_config) {
     default:
       return errors::InvalidArgument("Invalid ServerModelConfig");
   }
-  TF_RETURN_IF_ERROR(MaybeUpdateServerRequestLogger(config_.config_case()));
+  if (full_reload || diff.logging_changed ||
+      options_.server_request_logger_updater) {
+    TF_RETURN_IF_ERROR(MaybeUpdateServerRequestLogger(config_.config_case()));
+  }
+  config_fully_applied_ = true;
 
-  if (options_.flush_filesystem_caches) {
+  if (options_.flush_filesystem_caches &&
+      (full_reload || !diff.added_models.empty() ||
+       !diff.reloaded_models.empty())) {
     return Env::Default()->FlushFileSystemCaches();
   }
 
   return Status::OK();
 }
 
-Status ServerCore::UpdateModelVersionLabelMap() {
-  std::unique_ptr<std::map<string, std::map<string, int64>>> new_label_map(
-      new std::map<string, std::map<string, int64>>);
+Status ServerCore::UpdateModelVersionLabelMap(
+    const std::set<string>* models) {
+  if (models != nullptr && models->empty()) {
+    return Status::OK();
+  }
+  std::unique_ptr<ModelLabelsToVersions> new_label_map(
+      new ModelLabelsToVersions);
+  if (models != nullptr) {
+    // Start from the current labels, minus those of the models to update.
+    auto current_label_map = model_labels_to_versions_.get();
+    if (current_label_map != nullptr) {
+      *new_label_map = *current_label_map;
+    }
+    for (const string& model : *models) {
+      new_label_map->erase(model);
+    }
+  }
   for (const ModelConfig& model_config : config_.model_config_list().config()) {
+    if (model_config.version_labels().empty() ||
+        (models != nullptr && models->count(model_config.name()) == 0)) {
+      continue;
+    }
     ServableStateMonitor::VersionMap serving_states =
         servable_state_monitor_->GetVersionStates(model_config.name());
 
@@ -523,15 +705,18 @@ Status ServerCore::UpdateModelVersionLabelMap() {
     return Status::OK();
   }
 
-  mutex_lock l(model_labels_to_versions_mu_);
-  model_labels_to_versions_.swap(new_label_map);
+  // Waits for in-flight lookups in the previous map, if any, to finish. They
+  // are short, and no ReadPtr is held by this thread.
+  model_labels_to_versions_.Update(std::move(new_label_map));
 
   return Status::OK();
 }
 
 Status ServerCore::CreateAdapter(
     const string& model_platform,
-    std::unique_ptr<StoragePathSourceAdapter>* adapter) const {
+    std::unique_ptr<StoragePathSourceAdapter>* adapter,
+    SavedModelBundleSourceAdapter** saved_model_adapter) const {
+  *saved_model_adapter = nullptr;
   auto config_it =
       options_.platform_config_map.platform_configs().find(model_platform);
   if (config_it == options_.platform_config_map.platform_configs().end()) {
@@ -540,8 +725,29 @@ Status ServerCore::CreateAdapter(
   }
   const ::google::protobuf::Any& adapter_config =
       config_it->second.source_adapter_config();
-  const tensorflow::Status status =
-      StoragePathSourceAdapterRegistry::CreateFromAny(adapter_config, adapter);
+  tensorflow::Status status;
+  if (adapter_config.Is<SavedModelBundleSourceAdapterConfig>()) {
+    // Create SavedModel adapters directly, rather than via the registry, to
+    // keep hold of them for SetLoadGovernanceEnabled().
+    SavedModelBundleSourceAdapterConfig saved_model_config;
+    if (!adapter_config.UnpackTo(&saved_model_config)) {
+      return errors::InvalidArgument(
+          "Malformed SavedModelBundleSourceAdapterConfig for platform ",
+          model_platform);
+    }
+    SessionBundleSourceAdapterConfig legacy_config;
+    *legacy_config.mutable_config() = saved_model_config.legacy_config();
+    std::unique_ptr<SavedModelBundleSourceAdapter> typed_adapter;
+    status =
+        SavedModelBundleSourceAdapter::Create(legacy_config, &typed_adapter);
+    if (status.ok()) {
+      *saved_model_adapter = typed_adapter.get();
+      *adapter = std::move(typed_adapter);
+    }
+  } else {
+    status = StoragePathSourceAdapterRegistry::CreateFromAny(adapter_config,
+                                                              adapter);
+  }
   if (!status.ok()) {
     VLOG(1) << "Source adapter creation failed: " << status;
   }
@@ -553,10 +759,13 @@ FileSystemStoragePathSourceConfig ServerCore::CreateStoragePathSourceConfig(
   FileSystemStoragePathSourceConfig source_config;
   source_config.set_file_system_poll_wait_seconds(
       options_.file_system_poll_wait_seconds);
+  source_config.set_watch_file_system(options_.watch_file_system);
+  source_config.set_num_poll_threads(options_.num_file_system_poll_threads);
+  source_config.set_skip_unchanged_base_paths(
+      options_.skip_unchanged_model_base_paths);
   source_config.set_fail_if_zero_versions_at_startup(
       options_.fail_if_no_model_versions_found);
   for (const auto& model : config.model_config_list().config()) {
-    LOG(INFO) << " (Re-)adding model: " << model.name();
     FileSystemStoragePathSourceConfig::ServableToMonitor* servable =
         source_config.add_servables();
     servable->set_servable_name(model.name());
@@ -634,8 +843,12 @@ Status ServerCore::CreateAdapters(SourceAdapters* adapters) const {
   for (const auto& entry : platform_to_router_port_) {
     const string& platform = entry.first;
     std::unique_ptr<StoragePathSourceAdapter> adapter;
-    TF_RETURN_IF_ERROR(CreateAdapter(platform, &adapter));
+    SavedModelBundleSourceAdapter* saved_model_adapter;
+    TF_RETURN_IF_ERROR(CreateAdapter(platform, &adapter, &saved_model_adapter));
     adapters->platform_adapters[platform] = std::move(adapter);
+    if (saved_model_adapter != nullptr) {
+      adapters->saved_model_adapters.push_back(saved_model_adapter);
+    }
   }
   adapters->error_adapter.reset(
       new ErrorInjectingSourceAdapter<StoragePath, std::unique_ptr<Loader>>(
@@ -656,9 +869,14 @@ Status ServerCore::ConnectAdaptersToManagerAndAwaitModelLoads(
   }
   adapter_list.push_back(adapters->error_adapter.get());
 
+  // The server takes no traffic until its initial models have loaded, so let
+  // those loads run flat out rather than under the (TensorFlow platform's)
+  // load governance limits.
+  SetLoadGovernanceEnabled(adapters->saved_model_adapters, false);
   const Status status = ConnectSourcesWithFastInitialLoad(
       manager_.get(), adapter_list, servable_state_monitor_.get(),
       models_to_await, options_.num_initial_load_threads);
+  SetLoadGovernanceEnabled(adapters->saved_model_adapters, true);
   if (!status.ok()) {
     VLOG(1) << "Unable to ConnectSourcesWithFastInitialLoad due to: " << status;
     return status;
@@ -704,6 +922,8 @@ Status ServerCore::CreateAspiredVersionsManager(
       options_.load_retry_interval_micros;
   manager_options.pre_load_hook = std::move(options_.pre_load_hook);
   manager_options.flush_filesystem_caches = options_.flush_filesystem_caches;
+  manager_options.enable_optimistic_load_admission =
+      options_.enable_optimistic_load_admission;
   const tensorflow::Status status =
       AspiredVersionsManager::Create(std::move(manager_options), manager);
   if (!status.ok()) {
@@ -770,14 +990,18 @@ Status ServerCore::ServableRequestFromModelSpec(
 Status ServerCore::GetModelVersionForLabel(const string& model_name,
                                            const string& label,
                                            int64* version) const {
-  mutex_lock l(model_labels_to_versions_mu_);
-  auto version_map_it = model_labels_to_versions_->find(model_name);
-  if (version_map_it != model_labels_to_versions_->end()) {
-    const std::map<string, int64>& version_map = version_map_it->second;
-    auto version_it = version_map.find(label);
-    if (version_it != version_map.end()) {
-      *version = version_it->second;
-      return Status::OK();
+  const FastReadDynamicPtr<ModelLabelsToVersions>::ReadPtr
+      model_labels_to_versions = model_labels_to_versions_.get();
+  if (model_labels_to_versions != nullptr) {
+    auto version_map_it = model_labels_to_versions->find(model_name);
+    if (version_map_it != model_labels_to_versions->end()) {
+      const std::unordered_map<string, int64>& version_map =
+          version_map_it->second;
+      auto version_it = version_map.find(label);
+      if (version_it != version_map.end()) {
+        *version = version_it->second;
+        return Status::OK();
+      }
     }
   }
   return errors::InvalidArgument(
@@ -19,8 +19,11 @@ limitations under the License.
 #include <limits>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "google/protobuf/any.pb.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -39,8 +42,11 @@ limitations under the License.
 #include "tensorflow_serving/core/source.h"
 #include "tensorflow_serving/core/source_adapter.h"
 #include "tensorflow_serving/core/storage_path.h"
+#include "tensorflow_serving/servables/tensorflow/saved_model_bundle_source_adapter.h"
+#include "tensorflow_serving/sources/storage_path/caching_storage_path_source_adapter.pb.h"
 #include "tensorflow_serving/sources/storage_path/file_system_storage_path_source.h"
 #include "tensorflow_serving/util/event_bus.h"
+#include "tensorflow_serving/util/fast_read_dynamic_ptr.h"
 #include "tensorflow_serving/util/optional.h"
 #include "tensorflow_serving/util/unique_ptr_with_deps.h"
 
@@ -125,6 +131,26 @@ class ServerCore : public Manager {
     // Time interval between file-system polls, in seconds.
     int32 file_system_poll_wait_seconds = 30;
 
+    // If true, local model base paths are watched for new versions, which are
+    // then picked up immediately instead of at the next file-system poll. See
+    // FileSystemStoragePathSourceConfig::watch_file_system.
+    bool watch_file_system = false;
+
+    // Number of threads on which model base paths are polled concurrently.
+    // Values <= 1 poll sequentially.
+    int32 num_file_system_poll_threads = 1;
+
+    // If true, model base paths whose modification time hasn't changed since
+    // the previous poll are not listed again. See
+    // FileSystemStoragePathSourceConfig::skip_unchanged_base_paths.
+    bool skip_unchanged_model_base_paths = false;
+
+    // If 'model_cache_config.cache_dir' is set, model versions are copied into
+    // that local directory as soon as they are found, and loaded from there.
+    // Useful when model base paths are on a slow or remote file system. See
+    // CachingStoragePathSourceAdapter.
+    CachingStoragePathSourceAdapterConfig model_cache_config;
+
     // If true, filesystem caches are flushed in the following cases:
     //
     // 1) After the initial models are loaded.
@@ -165,6 +191,18 @@ class ServerCore : public Manager {
     // Callback to be called just before a servable is to be loaded. This will
     // called on the same manager load thread which starts the load.
     PreLoadHook pre_load_hook;
+
+    // If true, model loads that have to wait for other loads/unloads to free up
+    // resources don't hold up the approval of loads that already fit. See
+    // BasicManager::Options::enable_optimistic_load_admission.
+    bool enable_optimistic_load_admission = false;
+
+    // If positive, servable state changes are delivered to the
+    // ServableStateMonitor (and other subscribers) asynchronously, with at most
+    // this many state changes queued, so that slow subscribers don't hold up
+    // model loading. If 0, they are delivered synchronously on the manager
+    // threads. See EventBus::Options::max_queued_events.
+    int32 servable_event_bus_max_queued_events = 0;
   };
 
   virtual ~ServerCore() = default;
@@ -235,6 +273,12 @@ class ServerCore : public Manager {
     return options_.server_request_logger->Log(request, response, log_metadata);
   }
 
+  /// Returns true if requests to the model 'model_name' may be logged, i.e.
+  /// request-logging was configured for it.
+  bool IsRequestLoggingEnabled(const string& model_name) {
+    return options_.server_request_logger->IsLoggingEnabled(model_name);
+  }
+
  protected:
   ServerCore(Options options);
 
@@ -259,10 +303,12 @@ class ServerCore : public Manager {
   Status CreateResourceTracker(
       std::unique_ptr<ResourceTracker>* resource_tracker);
 
-  // Creates a platform-specific source adapter.
+  // Creates a platform-specific source adapter. If it is a SavedModel adapter,
+  // also sets 'saved_model_adapter' to it; otherwise to null.
   Status CreateAdapter(
       const string& model_platform,
-      std::unique_ptr<StoragePathSourceAdapter>* adapter) const;
+      std::unique_ptr<StoragePathSourceAdapter>* adapter,
+      SavedModelBundleSourceAdapter** saved_model_adapter) const;
 
   // Creates a FileSystemStoragePathSourceConfig from the ModelConfigList of
   // 'config'.
@@ -301,6 +347,10 @@ class ServerCore : public Manager {
 
     // An extra adapter to report errors for models with no configured platform.
     std::unique_ptr<StoragePathSourceAdapter> error_adapter;
+
+    // The members of 'platform_adapters' that are SavedModel adapters, whose
+    // loads are subject to load governance.
+    std::vector<SavedModelBundleSourceAdapter*> saved_model_adapters;
   };
 
   // Creates a source router and connects it to the supplied adapter targets.
@@ -326,8 +376,35 @@ class ServerCore : public Manager {
   Status ReloadRoutes(const DynamicSourceRouter<StoragePath>::Routes& routes)
       EXCLUSIVE_LOCKS_REQUIRED(config_mu_);
 
-  // Adds/reloads models through ModelConfigList of 'config_'.
-  Status AddModelsViaModelConfigList() EXCLUSIVE_LOCKS_REQUIRED(config_mu_);
+  // The differences between two ModelConfigLists, by model name.
+  struct ModelConfigListDiff {
+    // Models only in the new list.
+    std::set<string> added_models;
+    // Models only in the old list.
+    std::set<string> removed_models;
+    // Models in both lists, with a different base path or version policy.
+    std::set<string> reloaded_models;
+    // Models (in either list) whose version labels differ.
+    std::set<string> relabeled_models;
+    // Whether any model's logging config differs.
+    bool logging_changed = false;
+
+    bool empty() const {
+      return added_models.empty() && removed_models.empty() &&
+             reloaded_models.empty() && relabeled_models.empty() &&
+             !logging_changed;
+    }
+  };
+
+  // Computes the differences between 'old_list' and 'new_list'.
+  static ModelConfigListDiff DiffModelConfigLists(
+      const ModelConfigList& old_list, const ModelConfigList& new_list);
+
+  // Adds/reloads models through ModelConfigList of 'config_'. Only the models
+  // in 'diff', which describes the changes since the previous config, are
+  // touched.
+  Status AddModelsViaModelConfigList(const ModelConfigListDiff& diff)
+      EXCLUSIVE_LOCKS_REQUIRED(config_mu_);
 
   // Adds/reloads models through custom model config of 'config_'.
   Status AddModelsViaCustomModelConfig() EXCLUSIVE_LOCKS_REQUIRED(config_mu_);
@@ -337,10 +414,11 @@ class ServerCore : public Manager {
       ModelServerConfig::ConfigCase config_case)
       EXCLUSIVE_LOCKS_REQUIRED(config_mu_);
 
-  // Updates 'model_labels_to_versions_' based on 'config_'. Throws an error if
+  // Updates 'model_labels_to_versions_' based on 'config_', for the given
+  // models only, or for all models if 'models' is null. Throws an error if
   // requesting to assign a label to a version not in state kAvailable.
-  Status UpdateModelVersionLabelMap() EXCLUSIVE_LOCKS_REQUIRED(config_mu_)
-      LOCKS_EXCLUDED(model_labels_to_versions_mu_);
+  Status UpdateModelVersionLabelMap(const std::set<string>* models)
+      EXCLUSIVE_LOCKS_REQUIRED(config_mu_);
 
   // ************************************************************************
   // Request Processing.
@@ -352,8 +430,7 @@ class ServerCore : public Manager {
 
   // Gets the version associated with 'label', for the given model name.
   Status GetModelVersionForLabel(const string& model_name, const string& label,
-                                 int64* version) const
-      LOCKS_EXCLUDED(model_labels_to_versions_mu_);
+                                 int64* version) const;
 
   Status GetUntypedServableHandle(
       const ServableRequest& request,
@@ -381,9 +458,19 @@ class ServerCore : public Manager {
   // The most recent config supplied to ReloadConfig().
   ModelServerConfig config_ GUARDED_BY(config_mu_);
 
+  // Whether 'config_' was applied successfully. If not, the next config is
+  // applied in full, rather than just its differences from 'config_'.
+  bool config_fully_applied_ GUARDED_BY(config_mu_) = false;
+
   // A model_name->label->version# map.
-  std::unique_ptr<std::map<string, std::map<string, int64>>>
-      model_labels_to_versions_ GUARDED_BY(model_labels_to_versions_mu_);
+  using ModelLabelsToVersions =
+      std::unordered_map<string, std::unordered_map<string, int64>>;
+
+  // The current model version label map. Looked up on every request that
+  // specifies a version label, so it is published as an immutable snapshot
+  // that is swapped out wholesale by UpdateModelVersionLabelMap(), rather than
+  // guarded by a mutex. Null until the first update.
+  FastReadDynamicPtr<ModelLabelsToVersions> model_labels_to_versions_;
 
   struct StoragePathSourceAndRouter {
     FileSystemStoragePathSource* source;
@@ -396,12 +483,13 @@ class ServerCore : public Manager {
   optional<StoragePathSourceAndRouter> storage_path_source_and_router_
       GUARDED_BY(config_mu_);
 
+  // The SavedModel source adapters, whose load governance we disable while we
+  // serve no traffic. Owned by 'manager_'.
+  std::vector<SavedModelBundleSourceAdapter*> saved_model_adapters_
+      GUARDED_BY(config_mu_);
+
   // A mutex for reconfiguration, used by ReloadConfig().
   mutable mutex config_mu_;
-
-  // A mutex for swapping the model version label map. Should only be held for
-  // a short time (i.e. pointer swap) to avoid holding up inference requests.
-  mutable mutex model_labels_to_versions_mu_;
 };
 
 }  // namespace serving
@@ -45,6 +45,7 @@ using ::testing::_;
 using ::testing::Invoke;
 using ::testing::MockFunction;
 using ::testing::NiceMock;
+using ::testing::UnorderedElementsAre;
 using test_util::ServerCoreTest;
 
 TEST_P(ServerCoreTest, PreLoadHook) {
@@ -184,6 +185,38 @@ TEST_P(ServerCoreTest, ReloadConfigChangeModelBasePath) {
            available_servables.at(0).version != test_util::kTestModelVersion);
 }
 
+TEST_P(ServerCoreTest, ReloadConfigAppliesOnlyChanges) {
+  ModelServerConfig config = GetTestModelServerConfigForFakePlatform();
+  std::unique_ptr<ServerCore> server_core;
+  TF_ASSERT_OK(CreateServerCore(config, &server_core));
+
+  // Reloading an unchanged config is a no-op.
+  TF_ASSERT_OK(server_core->ReloadConfig(config));
+  EXPECT_EQ(1, server_core->ListAvailableServableIds().size());
+
+  // Adding a model loads it, and waits for it, without touching the other.
+  ModelConfig added_model = config.model_config_list().config(0);
+  added_model.set_name("added_model");
+  *config.mutable_model_config_list()->add_config() = added_model;
+  TF_ASSERT_OK(server_core->ReloadConfig(config));
+  EXPECT_THAT(server_core->ListAvailableServableIds(),
+              UnorderedElementsAre(
+                  ServableId{test_util::kTestModelName,
+                             test_util::kTestModelVersion},
+                  ServableId{"added_model", test_util::kTestModelVersion}));
+
+  // Removing it unloads just that model.
+  config.mutable_model_config_list()->mutable_config()->RemoveLast();
+  TF_ASSERT_OK(server_core->ReloadConfig(config));
+  test_util::WaitUntilServableManagerStateIsOneOf(
+      *server_core->servable_state_monitor(),
+      {"added_model", test_util::kTestModelVersion},
+      {ServableState::ManagerState::kEnd});
+  EXPECT_THAT(server_core->ListAvailableServableIds(),
+              UnorderedElementsAre(ServableId{test_util::kTestModelName,
+                                              test_util::kTestModelVersion}));
+}
+
 class RelativePathsServerCoreTest : public ServerCoreTest {
  protected:
   // Creates a ModelServerConfig instance where the directory name has
@@ -0,0 +1,64 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/model_servers/session_service_impl.h"
+
+#include "grpc/grpc.h"
+#include "tensorflow_serving/core/logging.pb.h"
+#include "tensorflow_serving/model_servers/grpc_status_util.h"
+#include "tensorflow_serving/servables/tensorflow/session_run_service.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+int DeadlineToTimeoutMillis(const gpr_timespec deadline) {
+  return gpr_time_to_millis(
+      gpr_time_sub(gpr_convert_clock_type(deadline, GPR_CLOCK_MONOTONIC),
+                   gpr_now(GPR_CLOCK_MONOTONIC)));
+}
+
+}  // namespace
+
+::grpc::Status SessionServiceImpl::SessionRun(
+    ::grpc::ServerContext* context, const SessionRunRequest* request,
+    SessionRunResponse* response) {
+  tensorflow::RunOptions run_options = tensorflow::RunOptions();
+  if (enforce_session_run_timeout_) {
+    run_options.set_timeout_in_ms(
+        DeadlineToTimeoutMillis(context->raw_deadline()));
+  }
+
+  const ::grpc::Status status =
+      ToGRPCStatus(TensorflowSessionRunServiceImpl::SessionRun(
+          run_options, core_, *request, response));
+
+  if (!status.ok()) {
+    VLOG(1) << "SessionRun failed: " << status.error_message();
+  } else {
+    // Offer the request to the request logger (see LoggingConfig).
+    LogMetadata log_metadata;
+    *log_metadata.mutable_model_spec() = response->model_spec();
+    const Status log_status = core_->Log(*request, *response, log_metadata);
+    if (!log_status.ok()) {
+      VLOG(1) << "Failed to log request: " << log_status.error_message();
+    }
+  }
+  return status;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,51 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_MODEL_SERVERS_SESSION_SERVICE_IMPL_H_
+#define TENSORFLOW_SERVING_MODEL_SERVERS_SESSION_SERVICE_IMPL_H_
+
+#include "tensorflow_serving/apis/session_service.grpc.pb.h"
+#include "tensorflow_serving/model_servers/server_core.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Serves SessionService::SessionRun, which runs raw feeds and fetches against
+// a model's session, for clients that already speak TensorFlow tensors.
+class SessionServiceImpl final : public SessionService::Service {
+ public:
+  // Options for configuring a SessionServiceImpl object.
+  struct Options {
+    ServerCore* server_core;
+    bool enforce_session_run_timeout;
+  };
+
+  explicit SessionServiceImpl(const Options& options)
+      : core_(options.server_core),
+        enforce_session_run_timeout_(options.enforce_session_run_timeout) {}
+
+  ::grpc::Status SessionRun(::grpc::ServerContext* context,
+                            const SessionRunRequest* request,
+                            SessionRunResponse* response) override;
+
+ private:
+  ServerCore* core_;
+  const bool enforce_session_run_timeout_;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_MODEL_SERVERS_SESSION_SERVICE_IMPL_H_
@@ -39,6 +39,7 @@ from tensorflow.core.framework import types_pb2
 from tensorflow.python.platform import flags
 from tensorflow.python.saved_model import signature_constants
 from tensorflow_serving.apis import classification_pb2
+from tensorflow_serving.apis import get_model_metadata_pb2
 from tensorflow_serving.apis import get_model_status_pb2
 from tensorflow_serving.apis import inference_pb2
 from tensorflow_serving.apis import model_service_pb2_grpc
@@ -125,6 +126,7 @@ class TensorflowModelServerTest(tf.test.TestCase):
                 monitoring_config_file=None,
                 batching_parameters_file=None,
                 grpc_channel_arguments='',
+                grpc_num_completion_queues=0,
                 wait_for_server_ready=True,
                 pipe=None):
     """Run tensorflow_model_server using test config.
@@ -140,6 +142,8 @@ class TensorflowModelServerTest(tf.test.TestCase):
       monitoring_config_file: Path to the monitoring config file.
       batching_parameters_file: Path to batching parameters.
       grpc_channel_arguments: Custom gRPC args for server.
+      grpc_num_completion_queues: If positive, serve the PredictionService
+        asynchronously using this many completion queues.
       wait_for_server_ready: Wait for gRPC port to be ready.
       pipe: subpipe.PIPE object to read stderr from server.
 
@@ -181,6 +185,9 @@ class TensorflowModelServerTest(tf.test.TestCase):
       command += ' --batching_parameters_file=' + batching_parameters_file
     if grpc_channel_arguments:
       command += ' --grpc_channel_arguments=' + grpc_channel_arguments
+    if grpc_num_completion_queues:
+      command += (' --grpc_num_completion_queues=' +
+                  str(grpc_num_completion_queues))
     print(command)
     proc = subprocess.Popen(shlex.split(command), stderr=pipe)
     atexit.register(proc.kill)
@@ -555,6 +562,28 @@ class TensorflowModelServerTest(tf.test.TestCase):
         expected_version=self._GetModelVersion(
             self._GetSavedModelHalfPlusThreePath()))
 
+  def testPredictAsyncGrpc(self):
+    """Test Predict and GetModelMetadata over the asynchronous gRPC API."""
+    model_path = self._GetSavedModelBundlePath()
+    model_server_address = TensorflowModelServerTest.RunServer(
+        'default', model_path, grpc_num_completion_queues=2)[1]
+    expected_version = self._GetModelVersion(model_path)
+    for _ in range(3):
+      self.VerifyPredictRequest(
+          model_server_address,
+          expected_output=3.0,
+          specify_output=False,
+          expected_version=expected_version)
+
+    channel = grpc.insecure_channel(model_server_address)
+    stub = prediction_service_pb2_grpc.PredictionServiceStub(channel)
+    request = get_model_metadata_pb2.GetModelMetadataRequest()
+    request.model_spec.name = 'default'
+    request.metadata_field.append('signature_def')
+    result = stub.GetModelMetadata(request, RPC_TIMEOUT)
+    self.assertEqual('default', result.model_spec.name)
+    self.assertEqual(expected_version, result.model_spec.version.value)
+
   def testClassifyREST(self):
     """Test Classify implementation over REST API."""
     model_path = self._GetSavedModelBundlePath()
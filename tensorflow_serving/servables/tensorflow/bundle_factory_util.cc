@@ -15,12 +15,35 @@ limitations under the License.
 
 #include "tensorflow_serving/servables/tensorflow/bundle_factory_util.h"
 
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "google/protobuf/wrappers.pb.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow_serving/core/load_phase_recorder.h"
 #include "tensorflow_serving/resources/resource_values.h"
 #include "tensorflow_serving/servables/tensorflow/serving_session.h"
 
@@ -66,8 +89,224 @@ Status GetAllDescendants(const string& dirname, FileProbingEnv* env,
   return Status::OK();
 }
 
+// Number of threads on which EstimateResourceFromPath() probes files. Probing
+// is dominated by file system latency, so this exceeds the number of cores on
+// most machines.
+constexpr int kNumFileProbingThreads = 16;
+
+thread::ThreadPool* GetFileProbingThreadPool() {
+  static thread::ThreadPool* const thread_pool = new thread::ThreadPool(
+      Env::Default(), "file_probing", kNumFileProbingThreads);
+  return thread_pool;
+}
+
+// Runs fn(0), ..., fn(n - 1) concurrently, and waits for them to finish.
+void RunConcurrently(const int n, const std::function<void(int)>& fn) {
+  if (n == 1) {
+    fn(0);
+    return;
+  }
+  BlockingCounter num_pending(n);
+  for (int i = 0; i < n; ++i) {
+    GetFileProbingThreadPool()->Schedule([&, i]() {
+      fn(i);
+      num_pending.DecrementCount();
+    });
+  }
+  num_pending.Wait();
+}
+
+// The result of probing the children of a directory.
+struct DirectorySummary {
+  // The modification time of the directory, or 0 if unknown.
+  int64 mtime_nsec = 0;
+  // The combined size of the files in the directory (excluding those in its
+  // subdirectories).
+  uint64 file_bytes = 0;
+  // The paths of its subdirectories.
+  std::vector<string> subdirs;
+};
+
+// A directory whose modification time is this close to the time it was probed
+// may change again within the file system's timestamp granularity, so its
+// summary is not cached.
+constexpr int64 kMinDirectoryCacheAgeNanos = 2LL * 1000 * 1000 * 1000;
+
+// Bounds the number of cached directory summaries. The cache is cleared when
+// it would exceed this.
+constexpr size_t kMaxCachedDirectories = 100 * 1000;
+
+// Caches directory summaries by path, to reuse while a directory's
+// modification time doesn't change. This assumes, as is the case for model
+// exports, that files are not rewritten in place once the directory holding
+// them is complete.
+class DirectorySummaryCache {
+ public:
+  static DirectorySummaryCache* Get() {
+    static DirectorySummaryCache* const cache = new DirectorySummaryCache;
+    return cache;
+  }
+
+  bool Lookup(const string& dir, const int64 mtime_nsec,
+              DirectorySummary* summary) {
+    mutex_lock l(mu_);
+    auto it = summaries_.find(dir);
+    if (it == summaries_.end() || it->second.mtime_nsec != mtime_nsec) {
+      return false;
+    }
+    *summary = it->second;
+    return true;
+  }
+
+  void Insert(const string& dir, const DirectorySummary& summary) {
+    mutex_lock l(mu_);
+    if (summaries_.size() >= kMaxCachedDirectories) {
+      summaries_.clear();
+    }
+    summaries_[dir] = summary;
+  }
+
+ private:
+  mutex mu_;
+  std::unordered_map<string, DirectorySummary> summaries_ GUARDED_BY(mu_);
+};
+
+// Returns the combined size of the files under 'dirname' (recursively). Each
+// level of the directory tree is probed concurrently: first all of its
+// directories are listed, then all of their children are probed. Directories
+// that haven't changed since they were last probed are not probed again.
+Status GetTotalFileSize(const string& dirname, FileProbingEnv* env,
+                        uint64* total_file_size) {
+  TF_RETURN_IF_ERROR(env->FileExists(dirname));
+  *total_file_size = 0;
+  std::vector<string> dirs = {dirname};
+  while (!dirs.empty()) {
+    struct Listing {
+      DirectorySummary summary;
+      bool cached = false;
+      std::vector<string> children;
+      Status status;
+    };
+    std::vector<Listing> listings(dirs.size());
+    RunConcurrently(dirs.size(), [&](const int i) {
+      Listing& listing = listings[i];
+      int64 mtime_nsec = 0;
+      if (env->GetModificationTime(dirs[i], &mtime_nsec).ok() &&
+          mtime_nsec > 0) {
+        listing.summary.mtime_nsec = mtime_nsec;
+        listing.cached = DirectorySummaryCache::Get()->Lookup(
+            dirs[i], mtime_nsec, &listing.summary);
+      }
+      if (!listing.cached) {
+        // GetChildren might fail if we don't have appropriate permissions.
+        listing.status = env->GetChildren(dirs[i], &listing.children);
+      }
+    });
+    for (const Listing& listing : listings) {
+      TF_RETURN_IF_ERROR(listing.status);
+    }
+
+    // Probe the children of the directories that weren't cached.
+    struct Probe {
+      Listing* listing;
+      string path;
+      bool is_dir = false;
+      uint64 file_size = 0;
+      Status status;
+    };
+    std::vector<Probe> probes;
+    for (int i = 0; i < dirs.size(); ++i) {
+      for (const string& child : listings[i].children) {
+        Probe probe;
+        probe.listing = &listings[i];
+        probe.path = io::JoinPath(dirs[i], child);
+        probes.push_back(std::move(probe));
+      }
+    }
+    RunConcurrently(probes.size(), [&](const int i) {
+      Probe& probe = probes[i];
+      probe.is_dir = env->IsDirectory(probe.path).ok();
+      if (!probe.is_dir) {
+        probe.status = env->GetFileSize(probe.path, &probe.file_size);
+      }
+    });
+    for (const Probe& probe : probes) {
+      TF_RETURN_IF_ERROR(probe.status);
+      DirectorySummary& summary = probe.listing->summary;
+      if (probe.is_dir) {
+        summary.subdirs.push_back(probe.path);
+      } else {
+        summary.file_bytes += probe.file_size;
+      }
+    }
+
+    const int64 now_nanos = Env::Default()->NowMicros() * 1000;
+    std::vector<string> next_dirs;
+    for (int i = 0; i < dirs.size(); ++i) {
+      const Listing& listing = listings[i];
+      if (!listing.cached && listing.summary.mtime_nsec > 0 &&
+          listing.summary.mtime_nsec < now_nanos - kMinDirectoryCacheAgeNanos) {
+        DirectorySummaryCache::Get()->Insert(dirs[i], listing.summary);
+      }
+      *total_file_size += listing.summary.file_bytes;
+      next_dirs.insert(next_dirs.end(), listing.summary.subdirs.begin(),
+                       listing.summary.subdirs.end());
+    }
+    dirs = std::move(next_dirs);
+  }
+  return Status::OK();
+}
+
+// Returns the path of the export-size manifest of the export at 'path'.
+string GetExportSizeManifestPath(const string& path) {
+  return io::JoinPath(path, "assets.extra", kExportSizeManifestFilename);
+}
+
+// Returns the directory under 'dir' that holds the RAM usage measurements of
+// the servable stream that the version at 'path' belongs to. It is named after
+// a hash of the stream's base path, which may contain any character.
+string GetMeasuredRamUsageDir(const string& dir, const string& path) {
+  return io::JoinPath(
+      dir, strings::StrCat(strings::Hex(Hash64(io::Dirname(path).ToString()))));
+}
+
+// Reads a measurement written by WriteMeasuredRamUsage() from 'file'.
+Status ReadMeasuredRamUsageFile(const string& file, uint64* measured_ram_bytes,
+                                uint64* estimated_ram_bytes) {
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), file, &contents));
+  const std::vector<string> fields = str_util::Split(contents, ' ');
+  if (fields.size() != 2 ||
+      !strings::safe_strtou64(fields[0], measured_ram_bytes) ||
+      !strings::safe_strtou64(fields[1], estimated_ram_bytes) ||
+      *estimated_ram_bytes == 0) {
+    return errors::DataLoss("Malformed RAM usage measurement in ", file);
+  }
+  return Status::OK();
+}
+
+// Lowers the scheduling priority of the calling thread by 'nice_increment'.
+void LowerCurrentThreadPriority(const int nice_increment) {
+#if defined(__linux__)
+  // On Linux, PRIO_PROCESS with a thread id applies to just that thread.
+  const id_t thread_id = static_cast<id_t>(syscall(SYS_gettid));
+  errno = 0;
+  const int nice_value = getpriority(PRIO_PROCESS, thread_id);
+  if (errno != 0 ||
+      setpriority(PRIO_PROCESS, thread_id, nice_value + nice_increment) != 0) {
+    LOG(WARNING) << "Unable to lower the priority of the load thread: "
+                 << strerror(errno);
+  }
+#else
+  LOG(WARNING) << "Lowering the priority of load threads is not supported on "
+                  "this platform";
+#endif
+}
+
 }  // namespace
 
+const char* const kExportSizeManifestFilename = "export_size_bytes";
+
 SessionOptions GetSessionOptions(const SessionBundleConfig& config) {
   SessionOptions options;
   options.target = config.session_target();
@@ -113,6 +352,16 @@ Status CreateBatchScheduler(const BatchingParameters& batching_config,
 
 Status EstimateResourceFromPath(const string& path,
                                 ResourceAllocation* estimate) {
+  uint64 total_file_size;
+  const Status manifest_status = ReadExportSizeManifest(path, &total_file_size);
+  if (manifest_status.ok()) {
+    EstimateResourceFromTotalFileSize(total_file_size, estimate);
+    return Status::OK();
+  }
+  if (manifest_status.code() != error::NOT_FOUND) {
+    LOG(WARNING) << "Ignoring unreadable export-size manifest for " << path
+                 << ": " << manifest_status;
+  }
   TensorflowFileProbingEnv env(Env::Default());
   return EstimateResourceFromPath(path, &env, estimate);
 }
@@ -122,17 +371,16 @@ Status EstimateResourceFromPath(const string& path, FileProbingEnv* env,
   if (env == nullptr) {
     return errors::Internal("FileProbingEnv not set");
   }
+  ScopedLoadPhase load_phase("estimate_resources");
 
-  std::vector<string> descendants;
-  TF_RETURN_IF_ERROR(GetAllDescendants(path, env, &descendants));
-  uint64 total_file_size = 0;
-  for (const string& descendant : descendants) {
-    if (!(env->IsDirectory(descendant).ok())) {
-      uint64 file_size;
-      TF_RETURN_IF_ERROR(env->GetFileSize(descendant, &file_size));
-      total_file_size += file_size;
-    }
-  }
+  uint64 total_file_size;
+  TF_RETURN_IF_ERROR(GetTotalFileSize(path, env, &total_file_size));
+  EstimateResourceFromTotalFileSize(total_file_size, estimate);
+  return Status::OK();
+}
+
+void EstimateResourceFromTotalFileSize(const uint64 total_file_size,
+                                       ResourceAllocation* estimate) {
   const uint64 ram_requirement =
       total_file_size * kResourceEstimateRAMMultiplier +
       kResourceEstimateRAMPadBytes;
@@ -142,10 +390,122 @@ Status EstimateResourceFromPath(const string& path, FileProbingEnv* env,
   ram_resource->set_device(device_types::kMain);
   ram_resource->set_kind(resource_kinds::kRamBytes);
   ram_entry->set_quantity(ram_requirement);
+}
 
+Status ReadExportSizeManifest(const string& path, uint64* total_file_size) {
+  const string manifest_path = GetExportSizeManifestPath(path);
+  TF_RETURN_IF_ERROR(Env::Default()->FileExists(manifest_path));
+  string contents;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(Env::Default(), manifest_path, &contents));
+  if (!strings::safe_strtou64(contents, total_file_size)) {
+    return errors::DataLoss("Malformed export-size manifest ", manifest_path);
+  }
   return Status::OK();
 }
 
+Status WriteExportSizeManifest(const string& path) {
+  TensorflowFileProbingEnv env(Env::Default());
+  uint64 total_file_size;
+  TF_RETURN_IF_ERROR(GetTotalFileSize(path, &env, &total_file_size));
+  const string manifest_path = GetExportSizeManifestPath(path);
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(
+      io::Dirname(manifest_path).ToString()));
+  return WriteStringToFile(Env::Default(), manifest_path,
+                           strings::StrCat(total_file_size, "\n"));
+}
+
+Status WriteMeasuredRamUsage(const string& dir, const string& path,
+                             const uint64 measured_ram_bytes,
+                             const uint64 estimated_ram_bytes) {
+  const string stream_dir = GetMeasuredRamUsageDir(dir, path);
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(stream_dir));
+  return WriteStringToFile(
+      Env::Default(), io::JoinPath(stream_dir, io::Basename(path)),
+      strings::StrCat(measured_ram_bytes, " ", estimated_ram_bytes, "\n"));
+}
+
+Status ApplyMeasuredRamUsage(const string& dir, const string& path,
+                             ResourceAllocation* estimate) {
+  const string stream_dir = GetMeasuredRamUsageDir(dir, path);
+  string file = io::JoinPath(stream_dir, io::Basename(path));
+  if (!Env::Default()->FileExists(file).ok()) {
+    // Go by the latest measured version instead.
+    std::vector<string> children;
+    const Status children_status =
+        Env::Default()->GetChildren(stream_dir, &children);
+    if (!children_status.ok() &&
+        children_status.code() != error::NOT_FOUND) {
+      return children_status;
+    }
+    int64 latest_version = -1;
+    for (const string& child : children) {
+      int64 version;
+      if (strings::safe_strto64(child, &version) && version > latest_version) {
+        latest_version = version;
+        file = io::JoinPath(stream_dir, child);
+      }
+    }
+    if (latest_version < 0) {
+      return errors::NotFound("No RAM usage measurement for ", path);
+    }
+  }
+
+  uint64 measured_ram_bytes;
+  uint64 estimated_ram_bytes;
+  TF_RETURN_IF_ERROR(ReadMeasuredRamUsageFile(file, &measured_ram_bytes,
+                                              &estimated_ram_bytes));
+  const double ratio = static_cast<double>(measured_ram_bytes) /
+                       static_cast<double>(estimated_ram_bytes);
+  for (ResourceAllocation::Entry& entry :
+       *estimate->mutable_resource_quantities()) {
+    if (entry.resource().device() == device_types::kMain &&
+        entry.resource().kind() == resource_kinds::kRamBytes) {
+      entry.set_quantity(static_cast<uint64>(entry.quantity() * ratio));
+    }
+  }
+  return Status::OK();
+}
+
+Status GetProcessResidentRamBytes(uint64* ram_bytes) {
+#if defined(__linux__)
+  // The second field of /proc/self/statm is the resident set size, in pages.
+  FILE* const statm = fopen("/proc/self/statm", "r");
+  if (statm == nullptr) {
+    return errors::Unavailable("Unable to open /proc/self/statm");
+  }
+  unsigned long long total_pages = 0;     // NOLINT(runtime/int)
+  unsigned long long resident_pages = 0;  // NOLINT(runtime/int)
+  const int num_parsed = fscanf(statm, "%llu %llu", &total_pages,
+                                &resident_pages);
+  fclose(statm);
+  if (num_parsed != 2) {
+    return errors::Internal("Unable to parse /proc/self/statm");
+  }
+  *ram_bytes = static_cast<uint64>(resident_pages) * sysconf(_SC_PAGESIZE);
+  return Status::OK();
+#else
+  return errors::Unimplemented(
+      "Resident memory measurement is not supported on this platform");
+#endif
+}
+
+Status RunInLowPriorityThread(const int nice_increment,
+                              const std::function<Status()>& fn) {
+  LoadPhaseRecorder* const load_phase_recorder = LoadPhaseRecorder::Current();
+  Status status;
+  {
+    std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+        ThreadOptions(), "LowPriorityLoad", [&]() {
+          LowerCurrentThreadPriority(nice_increment);
+          LoadPhaseRecorder::ScopedInstall install(load_phase_recorder);
+          status = fn();
+        }));
+    // The thread's destructor waits for it to finish.
+  }
+  return status;
+}
+
 Status WrapSessionForBatching(const BatchingParameters& batching_config,
                               std::shared_ptr<Batcher> batch_scheduler,
                               const std::vector<SignatureDef>& signatures,
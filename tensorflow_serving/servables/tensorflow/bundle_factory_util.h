@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_BUNDLE_FACTORY_UTIL_H_
 #define TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_BUNDLE_FACTORY_UTIL_H_
 
+#include <functional>
+
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -53,14 +55,70 @@ Status CreateBatchScheduler(
 // (combined size of all exported file(s)) * kResourceEstimateRAMMultiplier +
 // kResourceEstimateRAMPadBytes.
 // TODO(b/27694447): Improve the heuristic. At a minimum, account for GPU RAM.
+//
+// The combined file size is taken from the export's size manifest, if it has
+// one (see WriteExportSizeManifest()), and otherwise determined by probing the
+// export's files, concurrently. Directories whose modification time hasn't
+// changed since they were last probed are not probed again.
 Status EstimateResourceFromPath(const string& path,
                                 ResourceAllocation* estimate);
 
 // Similar to the above function, but also supplies a FileProbingEnv to use in
-// lieu of tensorflow::Env::Default().
+// lieu of tensorflow::Env::Default(). The size manifest is not consulted.
 Status EstimateResourceFromPath(const string& path, FileProbingEnv* env,
                                 ResourceAllocation* estimate);
 
+// Applies the heuristic of EstimateResourceFromPath() to the given combined
+// size of an export's files, and adds the result to 'estimate'.
+void EstimateResourceFromTotalFileSize(uint64 total_file_size,
+                                       ResourceAllocation* estimate);
+
+// Name of the optional file, in an export's assets.extra directory, holding the
+// combined size in bytes of the export's files, in decimal. Lets exports on
+// slow file systems skip probing every file in EstimateResourceFromPath().
+extern const char* const kExportSizeManifestFilename;
+
+// Reads the size manifest of the export at 'path'. Returns NotFound if it has
+// none.
+Status ReadExportSizeManifest(const string& path, uint64* total_file_size);
+
+// Writes a size manifest for the export at 'path', e.g. as the last step of
+// exporting it.
+Status WriteExportSizeManifest(const string& path);
+
+// Persists, under 'dir', 'measured_ram_bytes', the RAM usage measured while
+// loading the version at 'path', along with 'estimated_ram_bytes', the RAM
+// estimate that EstimateResourceFromPath() gives for it. Each version gets a
+// file of its own, so 'dir' should not lie in a model repository or in a
+// directory whose contents are managed by someone else (e.g. a model cache).
+Status WriteMeasuredRamUsage(const string& dir, const string& path,
+                             uint64 measured_ram_bytes,
+                             uint64 estimated_ram_bytes);
+
+// Scales the RAM in 'estimate', the EstimateResourceFromPath() estimate of the
+// version at 'path', by the ratio of measured to estimated RAM usage that
+// WriteMeasuredRamUsage() persisted under 'dir' for that version, or failing
+// that for the latest measured version of the same servable stream. Scaling,
+// rather than using the measurement as is, keeps the estimate of a version
+// that is much larger than the measured one in proportion. Returns NotFound,
+// leaving 'estimate' unchanged, if there is no measurement to go by.
+Status ApplyMeasuredRamUsage(const string& dir, const string& path,
+                             ResourceAllocation* estimate);
+
+// Gets the resident main-memory footprint of the current process, in bytes.
+// Returns Unimplemented on platforms that do not expose it.
+Status GetProcessResidentRamBytes(uint64* ram_bytes);
+
+// Runs 'fn' on a new thread whose scheduling priority is lowered by
+// 'nice_increment' (on platforms that support per-thread priorities), waits
+// for it to finish and returns its status. Phases of the load that 'fn'
+// records go to the calling thread's LoadPhaseRecorder, if any.
+//
+// A new thread is used because an unprivileged process cannot raise a
+// thread's priority back up once it has been lowered.
+Status RunInLowPriorityThread(int nice_increment,
+                              const std::function<Status()>& fn);
+
 // Wraps a session in a new session that automatically batches Run() calls, for
 // the given signatures.
 // TODO(b/33233998): Support batching for Run() calls that use a combination of
@@ -28,11 +28,13 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow_serving/batching/batching_session.h"
+#include "tensorflow_serving/core/load_phase_recorder.h"
 #include "tensorflow_serving/resources/resources.pb.h"
 #include "tensorflow_serving/servables/tensorflow/bundle_factory_test_util.h"
 #include "tensorflow_serving/servables/tensorflow/session_bundle_config.pb.h"
@@ -175,6 +177,130 @@ TEST_F(BundleFactoryUtilTest, EstimateResourceFromPathWithFileProbingEnv) {
   EXPECT_THAT(actual, EqualsProto(expected));
 }
 
+TEST_F(BundleFactoryUtilTest, EstimateResourceFromPathReusesUnchangedDirs) {
+  const string export_dir = "/unchanged/export";
+  const string child_path = io::JoinPath(export_dir, "child");
+  const double file_size = 100;
+
+  // The directory is listed, and its child probed, only once.
+  test_util::MockFileProbingEnv env;
+  EXPECT_CALL(env, FileExists(export_dir)).WillRepeatedly(Return(Status::OK()));
+  EXPECT_CALL(env, GetModificationTime(export_dir, _))
+      .WillRepeatedly(DoAll(SetArgPointee<1>(1000 * 1000 * 1000),
+                            Return(Status::OK())));
+  EXPECT_CALL(env, GetChildren(export_dir, _))
+      .WillOnce(DoAll(SetArgPointee<1>(std::vector<string>({"child"})),
+                      Return(Status::OK())));
+  EXPECT_CALL(env, IsDirectory(child_path))
+      .WillOnce(Return(errors::FailedPrecondition("")));
+  EXPECT_CALL(env, GetFileSize(child_path, _))
+      .WillOnce(DoAll(SetArgPointee<1>(file_size), Return(Status::OK())));
+
+  const ResourceAllocation expected =
+      test_util::GetExpectedResourceEstimate(file_size);
+  for (int i = 0; i < 2; ++i) {
+    ResourceAllocation actual;
+    TF_ASSERT_OK(EstimateResourceFromPath(export_dir, &env, &actual));
+    EXPECT_THAT(actual, EqualsProto(expected));
+  }
+}
+
+TEST_F(BundleFactoryUtilTest, EstimateResourceFromPathWithSizeManifest) {
+  const string export_dir =
+      io::JoinPath(testing::TmpDir(), "ExportWithSizeManifest");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(export_dir));
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(), io::JoinPath(export_dir, "file"), "0123456789"));
+
+  uint64 total_file_size;
+  EXPECT_EQ(error::NOT_FOUND,
+            ReadExportSizeManifest(export_dir, &total_file_size).code());
+  TF_ASSERT_OK(WriteExportSizeManifest(export_dir));
+  TF_ASSERT_OK(ReadExportSizeManifest(export_dir, &total_file_size));
+  EXPECT_EQ(10, total_file_size);
+
+  // The manifest is used in lieu of probing the export's files.
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(),
+      io::JoinPath(export_dir, "assets.extra", kExportSizeManifestFilename),
+      "1000"));
+  ResourceAllocation actual;
+  TF_ASSERT_OK(EstimateResourceFromPath(export_dir, &actual));
+  EXPECT_THAT(actual,
+              EqualsProto(test_util::GetExpectedResourceEstimate(1000)));
+}
+
+TEST_F(BundleFactoryUtilTest, ApplyMeasuredRamUsageNotFound) {
+  const string dir = io::JoinPath(testing::TmpDir(), "NoMeasuredRamUsage");
+  const string version_path = io::JoinPath(testing::TmpDir(), "model", "1");
+  ResourceAllocation estimate = test_util::GetExpectedResourceEstimate(1000);
+  EXPECT_EQ(error::NOT_FOUND,
+            ApplyMeasuredRamUsage(dir, version_path, &estimate).code());
+  EXPECT_THAT(estimate,
+              EqualsProto(test_util::GetExpectedResourceEstimate(1000)));
+}
+
+TEST_F(BundleFactoryUtilTest, WriteAndApplyMeasuredRamUsage) {
+  const string dir = io::JoinPath(testing::TmpDir(), "MeasuredRamUsage");
+  const string base_path =
+      io::JoinPath(testing::TmpDir(), "MeasuredRamUsageModel");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(base_path));
+  // Version 1 was estimated at 1200 bytes, but only used half of that.
+  TF_ASSERT_OK(WriteMeasuredRamUsage(dir, io::JoinPath(base_path, "1"), 600,
+                                     1200));
+  // Nothing is written to the model's base path.
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(base_path, &children));
+  EXPECT_TRUE(children.empty());
+
+  ResourceAllocation estimate = test_util::GetExpectedResourceEstimate(1000);
+  TF_ASSERT_OK(
+      ApplyMeasuredRamUsage(dir, io::JoinPath(base_path, "1"), &estimate));
+  EXPECT_THAT(estimate,
+              EqualsProto(test_util::GetExpectedResourceEstimate(500)));
+
+  // A larger, unmeasured version is scaled by the ratio measured for version 1,
+  // rather than taking on version 1's measurement.
+  estimate = test_util::GetExpectedResourceEstimate(3000);
+  TF_ASSERT_OK(
+      ApplyMeasuredRamUsage(dir, io::JoinPath(base_path, "2"), &estimate));
+  EXPECT_THAT(estimate,
+              EqualsProto(test_util::GetExpectedResourceEstimate(1500)));
+
+  // Once version 2 has a measurement of its own, version 1 keeps using its own.
+  TF_ASSERT_OK(WriteMeasuredRamUsage(dir, io::JoinPath(base_path, "2"), 3600,
+                                     3600));
+  estimate = test_util::GetExpectedResourceEstimate(1000);
+  TF_ASSERT_OK(
+      ApplyMeasuredRamUsage(dir, io::JoinPath(base_path, "1"), &estimate));
+  EXPECT_THAT(estimate,
+              EqualsProto(test_util::GetExpectedResourceEstimate(500)));
+  estimate = test_util::GetExpectedResourceEstimate(1000);
+  TF_ASSERT_OK(
+      ApplyMeasuredRamUsage(dir, io::JoinPath(base_path, "3"), &estimate));
+  EXPECT_THAT(estimate,
+              EqualsProto(test_util::GetExpectedResourceEstimate(1000)));
+}
+
+TEST_F(BundleFactoryUtilTest, RunInLowPriorityThread) {
+  LoadPhaseRecorder recorder;
+  EXPECT_EQ(errors::Internal("load failed"),
+            RunInLowPriorityThread(1, []() {
+              ScopedLoadPhase phase("phase");
+              return errors::Internal("load failed");
+            }));
+  ASSERT_EQ(1, recorder.phase_timings().size());
+  EXPECT_EQ("phase", recorder.phase_timings()[0].first);
+}
+
+#if defined(__linux__)
+TEST_F(BundleFactoryUtilTest, GetProcessResidentRamBytes) {
+  uint64 ram_bytes = 0;
+  TF_ASSERT_OK(GetProcessResidentRamBytes(&ram_bytes));
+  EXPECT_GT(ram_bytes, 0);
+}
+#endif
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
@@ -130,15 +130,22 @@ class TensorFlowClassifier : public ClassifierInterface {
 
     TRACELITERAL("ConvertToClassificationResult");
     // Convert the output to ClassificationResult format.
+    // Both Tensors are [num_examples, num_classes] and row-major.
+    const string* const labels =
+        classes ? classes->flat<string>().data() : nullptr;
+    const float* const score_values =
+        scores ? scores->flat<float>().data() : nullptr;
+    result->mutable_classifications()->Reserve(num_examples);
     for (int i = 0; i < num_examples; ++i) {
       serving::Classifications* classifications = result->add_classifications();
+      classifications->mutable_classes()->Reserve(num_classes);
       for (int c = 0; c < num_classes; ++c) {
         serving::Class* cl = classifications->add_classes();
         if (classes) {
-          cl->set_label((classes->matrix<string>())(i, c));
+          cl->set_label(labels[i * num_classes + c]);
         }
         if (scores) {
-          cl->set_score((scores->matrix<float>())(i, c));
+          cl->set_score(score_values[i * num_classes + c]);
         }
       }
     }
@@ -429,15 +436,22 @@ Status PostProcessClassificationResult(
   }
 
   // Convert the output to ClassificationResult format.
+  // Both Tensors are [num_examples, num_classes] and row-major.
+  const string* const labels =
+      classes ? classes->flat<string>().data() : nullptr;
+  const float* const score_values =
+      scores ? scores->flat<float>().data() : nullptr;
+  result->mutable_classifications()->Reserve(num_examples);
   for (int i = 0; i < num_examples; ++i) {
     serving::Classifications* classifications = result->add_classifications();
+    classifications->mutable_classes()->Reserve(num_classes);
     for (int c = 0; c < num_classes; ++c) {
       serving::Class* cl = classifications->add_classes();
       if (classes) {
-        cl->set_label((classes->matrix<string>())(i, c));
+        cl->set_label(labels[i * num_classes + c]);
       }
       if (scores) {
-        cl->set_score((scores->matrix<float>())(i, c));
+        cl->set_score(score_values[i * num_classes + c]);
       }
     }
   }
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow_serving/servables/tensorflow/multi_inference.h"
 
+#include <vector>
+
 #include "tensorflow/cc/saved_model/signature_constants.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -36,6 +38,9 @@ Status TensorFlowMultiInferenceRunner::Infer(
   string input_tensor_name = "";
   std::set<string> signature_names;
   std::set<string> output_tensor_name_set;
+  // The signature of each task, looked up once for both passes below.
+  std::vector<const SignatureDef*> signatures;
+  signatures.reserve(request.tasks_size());
   for (const auto& task : request.tasks()) {
     if (task.model_spec().name().empty()) {
       return errors::InvalidArgument(
@@ -64,6 +69,7 @@ Status TensorFlowMultiInferenceRunner::Infer(
       return errors::InvalidArgument(strings::StrCat(
           "Requested signature not found in model graph: ", signature_name));
     }
+    signatures.push_back(&iter->second);
     string input_name;
     std::vector<string> output_names;
 
@@ -100,22 +106,15 @@ Status TensorFlowMultiInferenceRunner::Infer(
   RecordRequestExampleCount(model_name, num_examples);
 
   TRACELITERAL("PostProcessResults");
-  for (const auto& task : request.tasks()) {
-    const string signature_name = task.model_spec().signature_name().empty()
-                                      ? kDefaultServingSignatureDefKey
-                                      : task.model_spec().signature_name();
-    auto iter = meta_graph_def_->signature_def().find(signature_name);
-    if (iter == meta_graph_def_->signature_def().end()) {
-      return errors::InvalidArgument(strings::StrCat(
-          "Requested signature not found in model graph: ", signature_name));
-    }
+  for (int i = 0; i < request.tasks_size(); ++i) {
+    const auto& task = request.tasks(i);
     if (task.method_name() == kClassifyMethodName) {
       TF_RETURN_IF_ERROR(PostProcessClassificationResult(
-          iter->second, num_examples, output_tensor_names, outputs,
+          *signatures[i], num_examples, output_tensor_names, outputs,
           response->add_results()->mutable_classification_result()));
     } else if (task.method_name() == kRegressMethodName) {
       TF_RETURN_IF_ERROR(PostProcessRegressionResult(
-          iter->second, num_examples, output_tensor_names, outputs,
+          *signatures[i], num_examples, output_tensor_names, outputs,
           response->add_results()->mutable_regression_result()));
     } else {
       return errors::InvalidArgument("Unrecognized signature method_name: ",
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow_serving/servables/tensorflow/predict_impl.h"
 
+#include <map>
 #include <string>
 #include <utility>
 
@@ -22,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow_serving/core/servable_handle.h"
 #include "tensorflow_serving/servables/tensorflow/predict_util.h"
+#include "tensorflow_serving/servables/tensorflow/tensor_proto_util.h"
 #include "tensorflow_serving/servables/tensorflow/util.h"
 
 namespace tensorflow {
@@ -32,6 +34,8 @@ namespace {
 Status SessionBundlePredict(const RunOptions& run_options,
                             const MetaGraphDef& meta_graph_def,
                             const optional<int64>& servable_version,
+                            const bool use_tensor_content,
+                            const std::map<string, Tensor>& parsed_inputs,
                             const PredictRequest& request,
                             PredictResponse* response, Session* session) {
   // Validate signatures.
@@ -66,11 +70,14 @@ Status SessionBundlePredict(const RunOptions& run_options,
           "input tensor alias not found in signature: " + alias);
     }
     Tensor tensor;
-    if (!tensor.FromProto(input.second)) {
+    const auto parsed_input = parsed_inputs.find(alias);
+    if (parsed_input != parsed_inputs.end()) {
+      tensor = parsed_input->second;
+    } else if (!tensor.FromProto(input.second)) {
       return tensorflow::Status(tensorflow::error::INVALID_ARGUMENT,
                                 "tensor parsing error: " + alias);
     }
-    inputs.emplace_back(std::make_pair(iter->second.tensor_name(), tensor));
+    inputs.emplace_back(iter->second.tensor_name(), std::move(tensor));
   }
 
   // Prepare run target.
@@ -118,8 +125,8 @@ Status SessionBundlePredict(const RunOptions& run_options,
                               "Predict internal error");
   }
   for (int i = 0; i < outputs.size(); i++) {
-    outputs[i].AsProtoField(
-        &((*response->mutable_outputs())[output_aliases[i]]));
+    TensorToProto(outputs[i], use_tensor_content,
+                  &((*response->mutable_outputs())[output_aliases[i]]));
   }
 
   return Status::OK();
@@ -144,16 +151,44 @@ Status TensorflowPredictor::PredictWithModelSpec(const RunOptions& run_options,
                                                  const ModelSpec& model_spec,
                                                  const PredictRequest& request,
                                                  PredictResponse* response) {
+  return PredictWithModelSpecAndParsedInputs(run_options, core, model_spec,
+                                             /*parsed_inputs=*/{}, request,
+                                             response);
+}
+
+Status TensorflowPredictor::PredictWithParsedInputs(
+    const RunOptions& run_options, ServerCore* core,
+    const std::map<string, Tensor>& parsed_inputs,
+    const PredictRequest& request, PredictResponse* response) {
+  if (!request.has_model_spec()) {
+    return tensorflow::Status(tensorflow::error::INVALID_ARGUMENT,
+                              "Missing ModelSpec");
+  }
+  return PredictWithModelSpecAndParsedInputs(
+      run_options, core, request.model_spec(), parsed_inputs, request,
+      response);
+}
+
+Status TensorflowPredictor::PredictWithModelSpecAndParsedInputs(
+    const RunOptions& run_options, ServerCore* core,
+    const ModelSpec& model_spec,
+    const std::map<string, Tensor>& parsed_inputs,
+    const PredictRequest& request, PredictResponse* response) {
   if (use_saved_model_) {
     ServableHandle<SavedModelBundle> bundle;
     TF_RETURN_IF_ERROR(core->GetServableHandle(model_spec, &bundle));
     return RunPredict(run_options, bundle->meta_graph_def, bundle.id().version,
-                      bundle->session.get(), request, response);
+                      option_, parsed_inputs, bundle->session.get(), request,
+                      response);
   }
   ServableHandle<SessionBundle> bundle;
   TF_RETURN_IF_ERROR(core->GetServableHandle(model_spec, &bundle));
+  const bool use_tensor_content =
+      option_ == PredictResponseTensorSerializationOption::kAsProtoContent ||
+      request.use_tensor_content();
   return SessionBundlePredict(run_options, bundle->meta_graph_def,
-                              bundle.id().version, request, response,
+                              bundle.id().version, use_tensor_content,
+                              parsed_inputs, request, response,
                               bundle->session.get());
 }
 
@@ -16,11 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_PREDICT_IMPL_H_
 #define TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_PREDICT_IMPL_H_
 
+#include <map>
+
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow_serving/apis/predict.pb.h"
 #include "tensorflow_serving/model_servers/server_core.h"
+#include "tensorflow_serving/servables/tensorflow/predict_util.h"
 
 namespace tensorflow {
 namespace serving {
@@ -29,7 +33,13 @@ namespace serving {
 class TensorflowPredictor {
  public:
   explicit TensorflowPredictor(bool use_saved_model)
-      : use_saved_model_(use_saved_model) {}
+      : TensorflowPredictor(
+            use_saved_model,
+            PredictResponseTensorSerializationOption::kAsProtoField) {}
+
+  TensorflowPredictor(bool use_saved_model,
+                      PredictResponseTensorSerializationOption option)
+      : use_saved_model_(use_saved_model), option_(option) {}
 
   Status Predict(const RunOptions& run_options, ServerCore* core,
                  const PredictRequest& request, PredictResponse* response);
@@ -41,11 +51,29 @@ class TensorflowPredictor {
                               const PredictRequest& request,
                               PredictResponse* response);
 
+  // Like Predict(), but the values of the inputs in 'parsed_inputs' are taken
+  // from there rather than from 'request', as returned by
+  // ParsePredictRequest().
+  Status PredictWithParsedInputs(const RunOptions& run_options,
+                                 ServerCore* core,
+                                 const std::map<string, Tensor>& parsed_inputs,
+                                 const PredictRequest& request,
+                                 PredictResponse* response);
+
  private:
+  Status PredictWithModelSpecAndParsedInputs(
+      const RunOptions& run_options, ServerCore* core,
+      const ModelSpec& model_spec,
+      const std::map<string, Tensor>& parsed_inputs,
+      const PredictRequest& request, PredictResponse* response);
+
   // If use_saved_model_ is true, a SavedModelBundle handle will be retrieved
   // from the ServerCore and the new SavedModel SignatureDef format will be
   // used.
   bool use_saved_model_;
+
+  // How output tensors are encoded in responses.
+  PredictResponseTensorSerializationOption option_;
 };
 
 }  // namespace serving
@@ -22,29 +22,20 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/str_join.h"
+#include "google/protobuf/wire_format_lite.h"
 #include "tensorflow/cc/saved_model/signature_constants.h"
 #include "tensorflow/contrib/session_bundle/signature.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/protobuf/named_tensor.pb.h"
+#include "tensorflow_serving/servables/tensorflow/signature_plan.h"
+#include "tensorflow_serving/servables/tensorflow/tensor_proto_util.h"
 #include "tensorflow_serving/servables/tensorflow/util.h"
 
 namespace tensorflow {
 namespace serving {
 namespace {
 
-Status VerifySignature(const SignatureDef& signature) {
-  if (signature.method_name() != kPredictMethodName &&
-      signature.method_name() != kClassifyMethodName &&
-      signature.method_name() != kRegressMethodName) {
-    return errors::Internal(strings::StrCat(
-        "Expected prediction signature method_name to be one of {",
-        kPredictMethodName, ", ", kClassifyMethodName, ", ", kRegressMethodName,
-        "}. Was: ", signature.method_name()));
-  }
-  return Status::OK();
-}
-
 template <typename T>
 std::set<string> GetMapKeys(const T& proto_map) {
   std::set<string> keys;
@@ -62,6 +53,19 @@ std::set<string> SetDifference(std::set<string> set_a, std::set<string> set_b) {
   return result;
 }
 
+// Returns whether a length-delimited field of 'size' bytes fits within the
+// current limit of 'coded_input'. PushLimit() takes an int, so sizes above
+// kint32max would otherwise wrap around and set no limit at all.
+bool FitsInLimit(const protobuf::io::CodedInputStream& coded_input,
+                 const uint32 size) {
+  if (size > static_cast<uint32>(kint32max)) {
+    return false;
+  }
+  const int bytes_until_limit = coded_input.BytesUntilLimit();
+  return bytes_until_limit < 0 ||
+         size <= static_cast<uint32>(bytes_until_limit);
+}
+
 Status VerifyRequestInputsSize(const SignatureDef& signature,
                                const PredictRequest& request) {
   if (request.inputs().size() != signature.inputs().size()) {
@@ -86,17 +90,19 @@ Status VerifyRequestInputsSize(const SignatureDef& signature,
 
 // Validate a SignatureDef to make sure it's compatible with prediction, and
 // if so, populate the input and output tensor names.
-Status PreProcessPrediction(const SignatureDef& signature,
+Status PreProcessPrediction(const SignaturePlan& plan,
                             const PredictRequest& request,
+                            const std::map<string, Tensor>& parsed_inputs,
                             std::vector<std::pair<string, Tensor>>* inputs,
                             std::vector<string>* output_tensor_names,
                             std::vector<string>* output_tensor_aliases) {
-  TF_RETURN_IF_ERROR(VerifySignature(signature));
+  const SignatureDef& signature = *plan.signature;
+  TF_RETURN_IF_ERROR(plan.predict_status);
   TF_RETURN_IF_ERROR(VerifyRequestInputsSize(signature, request));
   for (auto& input : request.inputs()) {
     const string& alias = input.first;
-    auto iter = signature.inputs().find(alias);
-    if (iter == signature.inputs().end()) {
+    auto iter = plan.inputs.find(alias);
+    if (iter == plan.inputs.end()) {
       return tensorflow::Status(
           tensorflow::error::INVALID_ARGUMENT,
           strings::StrCat("input tensor alias not found in signature: ", alias,
@@ -105,20 +111,21 @@ Status PreProcessPrediction(const SignatureDef& signature,
                           "}."));
     }
     Tensor tensor;
-    if (!tensor.FromProto(input.second)) {
+    const auto parsed_input = parsed_inputs.find(alias);
+    if (parsed_input != parsed_inputs.end()) {
+      tensor = parsed_input->second;
+    } else if (!tensor.FromProto(input.second)) {
       return tensorflow::Status(tensorflow::error::INVALID_ARGUMENT,
                                 "tensor parsing error: " + alias);
     }
-    inputs->emplace_back(std::make_pair(iter->second.name(), tensor));
+    inputs->emplace_back(iter->second->name(), std::move(tensor));
   }
 
   // Prepare run target.
   std::set<string> seen_outputs;
-  std::vector<string> output_filter(request.output_filter().begin(),
-                                    request.output_filter().end());
-  for (auto& alias : output_filter) {
-    auto iter = signature.outputs().find(alias);
-    if (iter == signature.outputs().end()) {
+  for (const string& alias : request.output_filter()) {
+    auto iter = plan.outputs.find(alias);
+    if (iter == plan.outputs.end()) {
       return tensorflow::Status(
           tensorflow::error::INVALID_ARGUMENT,
           strings::StrCat("output tensor alias not found in signature: ", alias,
@@ -131,33 +138,31 @@ Status PreProcessPrediction(const SignatureDef& signature,
                                 "duplicate output tensor alias: " + alias);
     }
     seen_outputs.insert(alias);
-    output_tensor_names->emplace_back(iter->second.name());
+    output_tensor_names->emplace_back(iter->second->name());
     output_tensor_aliases->emplace_back(alias);
   }
   // When no output is specified, fetch all output tensors specified in
   // the signature.
   if (output_tensor_names->empty()) {
-    for (auto& iter : signature.outputs()) {
-      output_tensor_names->emplace_back(iter.second.name());
-      output_tensor_aliases->emplace_back(iter.first);
-    }
+    *output_tensor_names = plan.output_tensor_names;
+    *output_tensor_aliases = plan.output_aliases;
   }
   return Status::OK();
 }
 
 // Validate results and populate a PredictResponse.
 Status PostProcessPredictionResult(
-    const SignatureDef& signature,
     const std::vector<string>& output_tensor_aliases,
-    const std::vector<Tensor>& output_tensors, PredictResponse* response) {
+    const std::vector<Tensor>& output_tensors, const bool use_tensor_content,
+    PredictResponse* response) {
   // Validate and return output.
   if (output_tensors.size() != output_tensor_aliases.size()) {
     return tensorflow::Status(tensorflow::error::UNKNOWN,
                               "Predict internal error");
   }
   for (int i = 0; i < output_tensors.size(); i++) {
-    output_tensors[i].AsProtoField(
-        &((*response->mutable_outputs())[output_tensor_aliases[i]]));
+    TensorToProto(output_tensors[i], use_tensor_content,
+                  &((*response->mutable_outputs())[output_tensor_aliases[i]]));
   }
   return Status::OK();
 }
@@ -166,18 +171,32 @@ Status PostProcessPredictionResult(
 
 Status RunPredict(const RunOptions& run_options,
                   const MetaGraphDef& meta_graph_def,
-                  const optional<int64>& servable_version, Session* session,
-                  const PredictRequest& request, PredictResponse* response) {
+                  const optional<int64>& servable_version,
+                  const PredictResponseTensorSerializationOption option,
+                  Session* session, const PredictRequest& request,
+                  PredictResponse* response) {
+  return RunPredict(run_options, meta_graph_def, servable_version, option,
+                    /*parsed_inputs=*/{}, session, request, response);
+}
+
+Status RunPredict(const RunOptions& run_options,
+                  const MetaGraphDef& meta_graph_def,
+                  const optional<int64>& servable_version,
+                  const PredictResponseTensorSerializationOption option,
+                  const std::map<string, Tensor>& parsed_inputs,
+                  Session* session, const PredictRequest& request,
+                  PredictResponse* response) {
   // Validate signatures.
   const string signature_name = request.model_spec().signature_name().empty()
                                     ? kDefaultServingSignatureDefKey
                                     : request.model_spec().signature_name();
-  auto iter = meta_graph_def.signature_def().find(signature_name);
-  if (iter == meta_graph_def.signature_def().end()) {
+  SignaturePlan fallback_plan;
+  const SignaturePlan* const plan =
+      FindSignaturePlan(meta_graph_def, signature_name, &fallback_plan);
+  if (plan == nullptr) {
     return errors::FailedPrecondition(strings::StrCat(
         "Serving signature key \"", signature_name, "\" not found."));
   }
-  SignatureDef signature = iter->second;
 
   MakeModelSpec(request.model_spec().name(), signature_name, servable_version,
                 response->mutable_model_spec());
@@ -185,17 +204,119 @@ Status RunPredict(const RunOptions& run_options,
   std::vector<std::pair<string, Tensor>> input_tensors;
   std::vector<string> output_tensor_names;
   std::vector<string> output_tensor_aliases;
-  TF_RETURN_IF_ERROR(PreProcessPrediction(signature, request, &input_tensors,
-                                          &output_tensor_names,
-                                          &output_tensor_aliases));
+  TF_RETURN_IF_ERROR(PreProcessPrediction(
+      *plan, request, parsed_inputs, &input_tensors, &output_tensor_names,
+      &output_tensor_aliases));
   std::vector<Tensor> outputs;
   RunMetadata run_metadata;
   TF_RETURN_IF_ERROR(session->Run(run_options, input_tensors,
                                   output_tensor_names, {}, &outputs,
                                   &run_metadata));
 
-  return PostProcessPredictionResult(signature, output_tensor_aliases, outputs,
-                                     response);
+  const bool use_tensor_content =
+      option == PredictResponseTensorSerializationOption::kAsProtoContent ||
+      request.use_tensor_content();
+  return PostProcessPredictionResult(output_tensor_aliases, outputs,
+                                     use_tensor_content, response);
+}
+
+Status ParsePredictRequest(protobuf::io::ZeroCopyInputStream* const input,
+                           const std::shared_ptr<void>& input_owner,
+                           PredictRequest* const request,
+                           std::map<string, Tensor>* const parsed_inputs) {
+  using protobuf::internal::WireFormatLite;
+  const uint32 inputs_tag =
+      WireFormatLite::MakeTag(PredictRequest::kInputsFieldNumber,
+                              WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  // The key and value of a map entry are its fields 1 and 2.
+  const uint32 key_tag =
+      WireFormatLite::MakeTag(1, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  const uint32 value_tag =
+      WireFormatLite::MakeTag(2, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  const Status parse_error =
+      errors::InvalidArgument("Unable to parse PredictRequest");
+
+  request->Clear();
+  parsed_inputs->clear();
+  protobuf::io::CodedInputStream coded_input(input);
+  // The server accepts messages of up to 2GB.
+  coded_input.SetTotalBytesLimit(kint32max, kint32max);
+
+  // The fields other than inputs are copied, as is, to 'other_fields', and
+  // parsed from there.
+  string other_fields;
+  {
+    protobuf::io::StringOutputStream other_stream(&other_fields);
+    protobuf::io::CodedOutputStream other_output(&other_stream);
+    for (uint32 tag = coded_input.ReadTag(); tag != 0;
+         tag = coded_input.ReadTag()) {
+      if (tag != inputs_tag) {
+        if (!WireFormatLite::SkipField(&coded_input, tag, &other_output)) {
+          return parse_error;
+        }
+        continue;
+      }
+      uint32 entry_size;
+      if (!coded_input.ReadVarint32(&entry_size)) {
+        return parse_error;
+      }
+      if (!FitsInLimit(coded_input, entry_size)) {
+        return parse_error;
+      }
+      const auto entry_limit = coded_input.PushLimit(entry_size);
+      string alias;
+      TensorProto tensor_proto;
+      Tensor tensor;
+      bool has_tensor = false;
+      for (uint32 entry_tag = coded_input.ReadTag(); entry_tag != 0;
+           entry_tag = coded_input.ReadTag()) {
+        if (entry_tag == key_tag) {
+          if (!WireFormatLite::ReadString(&coded_input, &alias)) {
+            return parse_error;
+          }
+        } else if (entry_tag == value_tag) {
+          uint32 value_size;
+          if (!coded_input.ReadVarint32(&value_size)) {
+            return parse_error;
+          }
+          if (!FitsInLimit(coded_input, value_size)) {
+            return parse_error;
+          }
+          const auto value_limit = coded_input.PushLimit(value_size);
+          TF_RETURN_IF_ERROR(ParseTensorProto(&coded_input, input_owner,
+                                              &tensor_proto, &tensor,
+                                              &has_tensor));
+          coded_input.PopLimit(value_limit);
+        } else if (!WireFormatLite::SkipField(&coded_input, entry_tag)) {
+          return parse_error;
+        }
+      }
+      if (!coded_input.ConsumedEntireMessage()) {
+        return parse_error;
+      }
+      coded_input.PopLimit(entry_limit);
+      // As when parsing, the last entry for a key wins.
+      (*request->mutable_inputs())[alias] = std::move(tensor_proto);
+      if (has_tensor) {
+        (*parsed_inputs)[alias] = std::move(tensor);
+      } else {
+        parsed_inputs->erase(alias);
+      }
+    }
+  }
+  if (!coded_input.ConsumedEntireMessage() ||
+      !request->MergeFromString(other_fields)) {
+    return parse_error;
+  }
+  return Status::OK();
+}
+
+void RestoreParsedInputs(const std::map<string, Tensor>& parsed_inputs,
+                         PredictRequest* const request) {
+  for (const auto& parsed_input : parsed_inputs) {
+    parsed_input.second.AsProtoTensorContent(
+        &(*request->mutable_inputs())[parsed_input.first]);
+  }
 }
 
 }  // namespace serving
@@ -16,22 +16,72 @@ limitations under the License.
 #ifndef TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_PREDICT_UTIL_H_
 #define TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_PREDICT_UTIL_H_
 
+#include <map>
+#include <memory>
+
 #include "tensorflow/contrib/session_bundle/session_bundle.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow_serving/apis/predict.pb.h"
 #include "tensorflow_serving/util/optional.h"
 
 namespace tensorflow {
 namespace serving {
 
+// How the output tensors of a PredictResponse are encoded.
+enum class PredictResponseTensorSerializationOption {
+  // Tensor::AsProtoField(), i.e. the typed repeated fields (e.g. float_val).
+  kAsProtoField = 0,
+  // Tensor::AsProtoTensorContent(), i.e. packed into tensor_content (for
+  // fixed-size types). Much cheaper to serialize and parse for large outputs.
+  kAsProtoContent = 1,
+};
+
 // Implementation of Predict using the SavedModel SignatureDef format.
+//
+// Outputs are encoded as per 'option', or packed into tensor_content if the
+// request sets use_tensor_content.
 Status RunPredict(const RunOptions& run_options,
                   const MetaGraphDef& meta_graph_def,
                   const optional<int64>& servable_version,
+                  PredictResponseTensorSerializationOption option,
                   Session* session,
                   const PredictRequest& request,
                   PredictResponse* response);
 
+// Like RunPredict(), but the values of the inputs in 'parsed_inputs' (keyed by
+// alias) are taken from there rather than from 'request'; see
+// ParsePredictRequest().
+Status RunPredict(const RunOptions& run_options,
+                  const MetaGraphDef& meta_graph_def,
+                  const optional<int64>& servable_version,
+                  PredictResponseTensorSerializationOption option,
+                  const std::map<string, Tensor>& parsed_inputs,
+                  Session* session, const PredictRequest& request,
+                  PredictResponse* response);
+
+// Parses a serialized PredictRequest from 'input' into '*request'. The values
+// of inputs held in tensor_content are read straight from 'input' into
+// aligned Tensor buffers (see ParseTensorProto()), instead of being copied
+// into the request and then again into Tensors. Those Tensors are returned in
+// '*parsed_inputs', keyed by input alias, and the corresponding inputs in
+// '*request' keep only their other fields (dtype, shape).
+//
+// If 'input_owner' is non-null, suitably aligned values are not copied at all,
+// but referenced in place by the Tensors, which keep 'input_owner' alive. See
+// ParseTensorProto() for the requirements.
+Status ParsePredictRequest(protobuf::io::ZeroCopyInputStream* input,
+                           const std::shared_ptr<void>& input_owner,
+                           PredictRequest* request,
+                           std::map<string, Tensor>* parsed_inputs);
+
+// Puts the values of 'parsed_inputs' back into the inputs of 'request', which
+// ParsePredictRequest() left without them (e.g. to log the request). Copies
+// the values.
+void RestoreParsedInputs(const std::map<string, Tensor>& parsed_inputs,
+                         PredictRequest* request);
+
 }  // namespace serving
 }  // namespace tensorflow
 
@@ -21,7 +21,9 @@ limitations under the License.
 #include "tensorflow/cc/saved_model/loader.h"
 #include "tensorflow/cc/saved_model/signature_constants.h"
 #include "tensorflow/contrib/session_bundle/session_bundle.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow_serving/core/availability_preserving_policy.h"
 #include "tensorflow_serving/model_servers/model_platform_types.h"
 #include "tensorflow_serving/model_servers/platform_config_util.h"
@@ -107,16 +109,29 @@ class PredictImplTest : public ::testing::Test {
     return server_core->GetServableHandle(model_spec, bundle);
   }
 
-  Status CallPredict(ServerCore* server_core,
-                     const PredictRequest& request, PredictResponse* response) {
+  Status CallPredict(ServerCore* server_core, const PredictRequest& request,
+                     PredictResponse* response,
+                     const PredictResponseTensorSerializationOption option =
+                         PredictResponseTensorSerializationOption::
+                             kAsProtoField) {
     ServableHandle<SavedModelBundle> bundle;
     TF_RETURN_IF_ERROR(GetSavedModelServableHandle(server_core, &bundle));
-    return RunPredict(GetRunOptions(),
-                      bundle->meta_graph_def,
-                      kTestModelVersion, bundle->session.get(),
+    return RunPredict(GetRunOptions(), bundle->meta_graph_def,
+                      kTestModelVersion, option, bundle->session.get(),
                       request, response);
   }
 
+  Status CallPredictWithParsedInputs(
+      ServerCore* server_core, const std::map<string, Tensor>& parsed_inputs,
+      const PredictRequest& request, PredictResponse* response) {
+    ServableHandle<SavedModelBundle> bundle;
+    TF_RETURN_IF_ERROR(GetSavedModelServableHandle(server_core, &bundle));
+    return RunPredict(
+        GetRunOptions(), bundle->meta_graph_def, kTestModelVersion,
+        PredictResponseTensorSerializationOption::kAsProtoField, parsed_inputs,
+        bundle->session.get(), request, response);
+  }
+
   RunOptions GetRunOptions() { return RunOptions(); }
 
  private:
@@ -291,6 +306,112 @@ TEST_F(PredictImplTest, PredictionSuccess) {
   EXPECT_THAT(response, test_util::EqualsProto(expected_response));
 }
 
+TEST_F(PredictImplTest, PredictionWithTensorContent) {
+  ModelSpec model_spec;
+  model_spec.set_name(kTestModelName);
+  model_spec.mutable_version()->set_value(kTestModelVersion);
+  const Tensor input = test::AsTensor<float>({2.0f, 4.0f}, {2});
+  const Tensor expected_output = test::AsTensor<float>({3.0f, 4.0f}, {2});
+
+  // Inputs may be given in tensor_content; outputs are packed into
+  // tensor_content if the server or the request asks for it.
+  for (const bool server_option : {false, true}) {
+    for (const bool request_option : {false, true}) {
+      PredictRequest request;
+      *request.mutable_model_spec() = model_spec;
+      input.AsProtoTensorContent(
+          &(*request.mutable_inputs())[kInputTensorKey]);
+      request.set_use_tensor_content(request_option);
+
+      PredictResponse response;
+      TF_ASSERT_OK(CallPredict(
+          GetServerCore(), request, &response,
+          server_option
+              ? PredictResponseTensorSerializationOption::kAsProtoContent
+              : PredictResponseTensorSerializationOption::kAsProtoField));
+      const TensorProto& output_proto =
+          response.outputs().at(kOutputTensorKey);
+      if (server_option || request_option) {
+        EXPECT_EQ(0, output_proto.float_val_size());
+        EXPECT_EQ(2 * sizeof(float), output_proto.tensor_content().size());
+      } else {
+        EXPECT_EQ(2, output_proto.float_val_size());
+        EXPECT_TRUE(output_proto.tensor_content().empty());
+      }
+      Tensor output;
+      ASSERT_TRUE(output.FromProto(output_proto));
+      test::ExpectTensorEqual<float>(expected_output, output);
+    }
+  }
+}
+
+TEST_F(PredictImplTest, PredictionWithParsedRequest) {
+  PredictRequest request;
+  ModelSpec* model_spec = request.mutable_model_spec();
+  model_spec->set_name(kTestModelName);
+  model_spec->mutable_version()->set_value(kTestModelVersion);
+  test::AsTensor<float>({2.0f, 4.0f}, {2}).AsProtoTensorContent(
+      &(*request.mutable_inputs())[kInputTensorKey]);
+  request.add_output_filter(kOutputTensorKey);
+  const string serialized = request.SerializeAsString();
+
+  PredictRequest parsed_request;
+  std::map<string, Tensor> parsed_inputs;
+  protobuf::io::ArrayInputStream input(serialized.data(), serialized.size());
+  TF_ASSERT_OK(ParsePredictRequest(&input, /*input_owner=*/nullptr,
+                                   &parsed_request, &parsed_inputs));
+  ASSERT_EQ(1, parsed_inputs.count(kInputTensorKey));
+  EXPECT_TRUE(
+      parsed_request.inputs().at(kInputTensorKey).tensor_content().empty());
+  EXPECT_EQ(request.model_spec().DebugString(),
+            parsed_request.model_spec().DebugString());
+  EXPECT_EQ(1, parsed_request.output_filter_size());
+
+  PredictResponse response;
+  TF_ASSERT_OK(CallPredictWithParsedInputs(GetServerCore(), parsed_inputs,
+                                           parsed_request, &response));
+  Tensor output;
+  ASSERT_TRUE(output.FromProto(response.outputs().at(kOutputTensorKey)));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({3.0f, 4.0f}, {2}),
+                                 output);
+
+  RestoreParsedInputs(parsed_inputs, &parsed_request);
+  EXPECT_EQ(request.DebugString(), parsed_request.DebugString());
+}
+
+TEST_F(PredictImplTest, ParsePredictRequestWithMalformedInput) {
+  PredictRequest request;
+  request.mutable_model_spec()->set_name(kTestModelName);
+  test::AsTensor<float>({2.0f, 4.0f}, {2}).AsProtoTensorContent(
+      &(*request.mutable_inputs())[kInputTensorKey]);
+  const string serialized = request.SerializeAsString();
+
+  PredictRequest parsed_request;
+  std::map<string, Tensor> parsed_inputs;
+  protobuf::io::ArrayInputStream input(serialized.data(),
+                                       serialized.size() - 1);
+  const Status status =
+      ParsePredictRequest(&input, /*input_owner=*/nullptr, &parsed_request,
+                          &parsed_inputs);
+  EXPECT_EQ(tensorflow::error::INVALID_ARGUMENT, status.code());
+}
+
+TEST_F(PredictImplTest, ParsePredictRequestWithBadLengthPrefix) {
+  // An inputs entry (field 2) with a length prefix above kint32max, and one
+  // whose value (field 2 of the entry) is longer than the entry itself.
+  for (const string& serialized :
+       {string("\x12\xff\xff\xff\xff\x0f\x0a\x01x", 9),
+        string("\x12\x05\x12\x64\x08\x01\x00", 7)}) {
+    PredictRequest parsed_request;
+    std::map<string, Tensor> parsed_inputs;
+    protobuf::io::ArrayInputStream input(serialized.data(), serialized.size());
+    const Status status =
+        ParsePredictRequest(&input, /*input_owner=*/nullptr,
+                            &parsed_request, &parsed_inputs);
+    EXPECT_EQ(tensorflow::error::INVALID_ARGUMENT, status.code());
+  }
+}
+
 // Test querying a model with a named regression signature (not default). This
 TEST_F(PredictImplTest, PredictionWithNamedRegressionSignature) {
   PredictRequest request;
@@ -0,0 +1,105 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/servables/tensorflow/prediction_log_request_logger.h"
+
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow_serving/apis/classification.pb.h"
+#include "tensorflow_serving/apis/inference.pb.h"
+#include "tensorflow_serving/apis/predict.pb.h"
+#include "tensorflow_serving/apis/prediction_log.pb.h"
+#include "tensorflow_serving/apis/regression.pb.h"
+#include "tensorflow_serving/apis/session_service.pb.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+// Copies 'request' and 'response' into the request and response of 'log'.
+// The type of 'request' must match that of the log's request.
+template <typename LogType>
+Status CopyToLog(const google::protobuf::Message& request,
+                 const google::protobuf::Message& response, LogType* log) {
+  if (response.GetDescriptor() != log->response().GetDescriptor()) {
+    return errors::InvalidArgument("Mismatched response type ",
+                                   response.GetDescriptor()->full_name(),
+                                   " for request type ",
+                                   request.GetDescriptor()->full_name());
+  }
+  log->mutable_request()->CopyFrom(request);
+  log->mutable_response()->CopyFrom(response);
+  return Status::OK();
+}
+
+}  // namespace
+
+Status PredictionLogRequestLogger::Create(
+    const LoggingConfig& logging_config,
+    std::unique_ptr<RequestLogger>* request_logger) {
+  std::unique_ptr<LogCollector> log_collector;
+  // The id disambiguates the logs of server processes sharing a collector.
+  TF_RETURN_IF_ERROR(LogCollector::Create(
+      logging_config.log_collector_config(),
+      static_cast<uint32>(Env::Default()->NowMicros()), &log_collector));
+  request_logger->reset(new PredictionLogRequestLogger(
+      logging_config, {}, std::move(log_collector)));
+  return Status::OK();
+}
+
+PredictionLogRequestLogger::PredictionLogRequestLogger(
+    const LoggingConfig& logging_config,
+    const std::vector<string>& saved_model_tags,
+    std::unique_ptr<LogCollector> log_collector)
+    : RequestLogger(logging_config, saved_model_tags,
+                    std::move(log_collector)) {}
+
+Status PredictionLogRequestLogger::CreateLogMessage(
+    const google::protobuf::Message& request,
+    const google::protobuf::Message& response,
+    const LogMetadata& log_metadata,
+    std::unique_ptr<google::protobuf::Message>* log) {
+  std::unique_ptr<PredictionLog> prediction_log(new PredictionLog);
+  *prediction_log->mutable_log_metadata() = log_metadata;
+  const auto* descriptor = request.GetDescriptor();
+  if (descriptor == ClassificationRequest::descriptor()) {
+    TF_RETURN_IF_ERROR(
+        CopyToLog(request, response, prediction_log->mutable_classify_log()));
+  } else if (descriptor == RegressionRequest::descriptor()) {
+    TF_RETURN_IF_ERROR(
+        CopyToLog(request, response, prediction_log->mutable_regress_log()));
+  } else if (descriptor == PredictRequest::descriptor()) {
+    TF_RETURN_IF_ERROR(
+        CopyToLog(request, response, prediction_log->mutable_predict_log()));
+  } else if (descriptor == MultiInferenceRequest::descriptor()) {
+    TF_RETURN_IF_ERROR(
+        CopyToLog(request, response,
+                  prediction_log->mutable_multi_inference_log()));
+  } else if (descriptor == SessionRunRequest::descriptor()) {
+    TF_RETURN_IF_ERROR(CopyToLog(request, response,
+                                 prediction_log->mutable_session_run_log()));
+  } else {
+    return errors::Unimplemented("Cannot log requests of type ",
+                                 descriptor->full_name());
+  }
+  *log = std::move(prediction_log);
+  return Status::OK();
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,61 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_PREDICTION_LOG_REQUEST_LOGGER_H_
+#define TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_PREDICTION_LOG_REQUEST_LOGGER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/message.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow_serving/config/logging_config.pb.h"
+#include "tensorflow_serving/core/log_collector.h"
+#include "tensorflow_serving/core/logging.pb.h"
+#include "tensorflow_serving/core/request_logger.h"
+
+namespace tensorflow {
+namespace serving {
+
+// A RequestLogger that logs Classify, Regress, Predict and MultiInference
+// requests, together with their responses, as PredictionLogs: the format of
+// warmup files (see saved_model_warmup.h).
+class PredictionLogRequestLogger : public RequestLogger {
+ public:
+  // Creates a logger for 'logging_config', with the LogCollector described by
+  // its log_collector_config. Can be used as a
+  // ServerRequestLogger::LoggerCreator.
+  static Status Create(const LoggingConfig& logging_config,
+                       std::unique_ptr<RequestLogger>* request_logger);
+
+  PredictionLogRequestLogger(const LoggingConfig& logging_config,
+                             const std::vector<string>& saved_model_tags,
+                             std::unique_ptr<LogCollector> log_collector);
+
+  ~PredictionLogRequestLogger() override = default;
+
+ private:
+  Status CreateLogMessage(
+      const google::protobuf::Message& request,
+      const google::protobuf::Message& response,
+      const LogMetadata& log_metadata,
+      std::unique_ptr<google::protobuf::Message>* log) override;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_PREDICTION_LOG_REQUEST_LOGGER_H_
@@ -15,21 +15,71 @@ limitations under the License.
 
 #include "tensorflow_serving/servables/tensorflow/saved_model_bundle_factory.h"
 
+#include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/tag_constants.h"
 #include "tensorflow/contrib/session_bundle/bundle_shim.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/named_tensor.pb.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
+#include "tensorflow_serving/core/load_phase_recorder.h"
 #include "tensorflow_serving/servables/tensorflow/bundle_factory_util.h"
 #include "tensorflow_serving/servables/tensorflow/curried_session.h"
+#include "tensorflow_serving/servables/tensorflow/serving_session.h"
 
 namespace tensorflow {
 namespace serving {
 
 namespace {
 
+// Name of the memory-mapped package file, in the SavedModel's assets.extra
+// directory, that sessions read their tensors from if
+// 'experimental_load_memmapped_package' is set.
+constexpr char kMemmappedPackageFilename[] = "memmapped_package";
+
+// A ServingSession that wraps a session which reads its tensors from a
+// memory-mapped package, and owns the MemmappedEnv that maps the package. The
+// env (and hence the mapping) is released only after the wrapped session.
+class MemmappedSession : public ServingSession {
+ public:
+  MemmappedSession(std::unique_ptr<MemmappedEnv> env,
+                   std::unique_ptr<Session> wrapped)
+      : env_(std::move(env)), wrapped_(std::move(wrapped)) {}
+
+  ~MemmappedSession() override = default;
+
+  Status Run(const std::vector<std::pair<string, Tensor>>& inputs,
+             const std::vector<string>& output_tensor_names,
+             const std::vector<string>& target_node_names,
+             std::vector<Tensor>* outputs) override {
+    return wrapped_->Run(inputs, output_tensor_names, target_node_names,
+                         outputs);
+  }
+
+  Status Run(const RunOptions& run_options,
+             const std::vector<std::pair<string, Tensor>>& inputs,
+             const std::vector<string>& output_tensor_names,
+             const std::vector<string>& target_node_names,
+             std::vector<Tensor>* outputs, RunMetadata* run_metadata) override {
+    return wrapped_->Run(run_options, inputs, output_tensor_names,
+                         target_node_names, outputs, run_metadata);
+  }
+
+  Status ListDevices(std::vector<DeviceAttributes>* response) override {
+    return wrapped_->ListDevices(response);
+  }
+
+ private:
+  // Declared before 'wrapped_', so that it is destroyed after it.
+  std::unique_ptr<MemmappedEnv> env_;
+  std::unique_ptr<Session> wrapped_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemmappedSession);
+};
+
 // Extracts the signatures from 'bundle'.
 std::vector<SignatureDef> GetSignatureDefs(const SavedModelBundle& bundle) {
   std::vector<SignatureDef> signature_defs;
@@ -72,7 +122,18 @@ Status SavedModelBundleFactory::Create(
 
 Status SavedModelBundleFactory::EstimateResourceRequirement(
     const string& path, ResourceAllocation* estimate) const {
-  return EstimateResourceFromPath(path, estimate);
+  TF_RETURN_IF_ERROR(EstimateResourceFromPath(path, estimate));
+  const string& measured_ram_usage_dir =
+      config_.experimental_measured_ram_usage_dir();
+  if (!measured_ram_usage_dir.empty()) {
+    const Status measured_status =
+        ApplyMeasuredRamUsage(measured_ram_usage_dir, path, estimate);
+    if (!measured_status.ok() && measured_status.code() != error::NOT_FOUND) {
+      LOG(WARNING) << "Ignoring unreadable RAM usage measurement for " << path
+                   << ": " << measured_status;
+    }
+  }
+  return Status::OK();
 }
 
 Status SavedModelBundleFactory::CreateSavedModelBundle(
@@ -85,9 +146,30 @@ Status SavedModelBundleFactory::CreateSavedModelBundle(
   if (saved_model_tags.empty()) {
     saved_model_tags.insert(kSavedModelTagServe);
   }
-  TF_RETURN_IF_ERROR(LoadSessionBundleOrSavedModelBundle(
-      GetSessionOptions(config_), GetRunOptions(config_), path,
-      saved_model_tags, bundle->get()));
+  SessionOptions session_options = GetSessionOptions(config_);
+  std::unique_ptr<MemmappedEnv> memmapped_env;
+  if (config_.experimental_load_memmapped_package()) {
+    const string package_path = io::JoinPath(
+        path, kSavedModelAssetsExtraDirectory, kMemmappedPackageFilename);
+    LOG(INFO) << "Memory-mapping tensors from " << package_path;
+    memmapped_env.reset(new MemmappedEnv(Env::Default()));
+    TF_RETURN_IF_ERROR(memmapped_env->InitializeFromFile(package_path));
+    // The session's ImmutableConst ops resolve their tensors through the env.
+    session_options.env = memmapped_env.get();
+  }
+  {
+    // Covers both importing the graph and restoring the variables, which the
+    // SavedModel loader does not time separately.
+    ScopedLoadPhase load_phase("load_saved_model");
+    TF_RETURN_IF_ERROR(LoadSessionBundleOrSavedModelBundle(
+        session_options, GetRunOptions(config_), path, saved_model_tags,
+        bundle->get()));
+  }
+  if (memmapped_env != nullptr) {
+    (*bundle)->session.reset(new MemmappedSession(
+        std::move(memmapped_env), std::move((*bundle)->session)));
+  }
+  ScopedLoadPhase load_phase("wrap_session");
   if (!config_.experimental_fixed_input_tensors().empty()) {
     LOG(INFO) << "Wrapping session to inject fixed input tensors";
     std::vector<std::pair<string, Tensor>> fixed_input_tensors;
@@ -105,11 +187,13 @@ Status SavedModelBundleFactory::CreateSavedModelBundle(
     // Note that in the future, the plan is to enable explicit configuration of
     // the one or many SignatureDefs to enable.
     const std::vector<SignatureDef> signatures = GetSignatureDefs(**bundle);
-    return WrapSessionForBatching(config_.batching_parameters(),
-                                  batch_scheduler_, signatures,
-                                  &(*bundle)->session);
+    TF_RETURN_IF_ERROR(WrapSessionForBatching(config_.batching_parameters(),
+                                              batch_scheduler_, signatures,
+                                              &(*bundle)->session));
+  } else {
+    TF_RETURN_IF_ERROR(WrapSession(&(*bundle)->session));
   }
-  return WrapSession(&(*bundle)->session);
+  return Status::OK();
 }
 
 SavedModelBundleFactory::SavedModelBundleFactory(
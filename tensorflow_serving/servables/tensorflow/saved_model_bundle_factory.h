@@ -67,6 +67,11 @@ class SavedModelBundleFactory {
   /// Estimates the resources a SavedModel bundle will use once loaded, from its
   /// export path.
   ///
+  /// If 'experimental_measured_ram_usage_dir' is set in the config, and the RAM
+  /// usage of this or a previous version of the same servable was measured
+  /// while loading it, the file-size heuristic's RAM estimate is scaled by how
+  /// far off it was for that version.
+  ///
   /// @param path      Path to the model.
   /// @param estimate  Output resource usage estimates. Different kinds of
   /// resources (e.g. CPU, RAM, etc.) may get populated.
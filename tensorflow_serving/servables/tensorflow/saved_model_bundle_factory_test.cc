@@ -23,14 +23,24 @@ limitations under the License.
 #include "google/protobuf/wrappers.pb.h"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/signature_constants.h"
 #include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/contrib/util/convert_graphdef_memmapped_format_lib.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/named_tensor.pb.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
 #include "tensorflow_serving/servables/tensorflow/bundle_factory_test.h"
 #include "tensorflow_serving/servables/tensorflow/bundle_factory_test_util.h"
 #include "tensorflow_serving/servables/tensorflow/session_bundle_config.pb.h"
@@ -51,6 +61,86 @@ Status CreateSessionFromPath(const SessionBundleConfig& config,
   return Status::OK();
 }
 
+// A frozen half plus two graph: y = 0.5 * x + 2, with both constants
+// convertible to ImmutableConst ops.
+constexpr char kFrozenHalfPlusTwo[] = R"(
+  node {
+    name: "x"
+    op: "Placeholder"
+    attr { key: "dtype" value { type: DT_FLOAT } }
+  }
+  node {
+    name: "a"
+    op: "Const"
+    attr { key: "dtype" value { type: DT_FLOAT } }
+    attr {
+      key: "value"
+      value { tensor { dtype: DT_FLOAT tensor_shape {} float_val: 0.5 } }
+    }
+  }
+  node {
+    name: "b"
+    op: "Const"
+    attr { key: "dtype" value { type: DT_FLOAT } }
+    attr {
+      key: "value"
+      value { tensor { dtype: DT_FLOAT tensor_shape {} float_val: 2 } }
+    }
+  }
+  node {
+    name: "ax"
+    op: "Mul"
+    input: "a"
+    input: "x"
+    attr { key: "T" value { type: DT_FLOAT } }
+  }
+  node {
+    name: "y"
+    op: "Add"
+    input: "ax"
+    input: "b"
+    attr { key: "T" value { type: DT_FLOAT } }
+  }
+)";
+
+// Writes to 'export_dir' a SavedModel of the frozen half plus two graph, with
+// its constants converted into a memmapped package, as
+// convert_graphdef_memmapped_format does.
+void CreateMemmappedSavedModel(const string& export_dir) {
+  Env* const env = Env::Default();
+  GraphDef frozen_graph_def;
+  CHECK(protobuf::TextFormat::ParseFromString(kFrozenHalfPlusTwo,
+                                              &frozen_graph_def));
+  const string frozen_graph_path =
+      io::JoinPath(testing::TmpDir(), "frozen_half_plus_two.pb");
+  TF_CHECK_OK(WriteBinaryProto(env, frozen_graph_path, frozen_graph_def));
+  const string assets_extra_dir =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory);
+  TF_CHECK_OK(env->RecursivelyCreateDir(assets_extra_dir));
+  const string package_path =
+      io::JoinPath(assets_extra_dir, "memmapped_package");
+  TF_CHECK_OK(ConvertConstantsToImmutable(frozen_graph_path, package_path,
+                                          /*min_conversion_tensor_size=*/1));
+
+  // The converted graph, which reads the constants from the package, is
+  // stored in the package itself.
+  MemmappedEnv memmapped_env(env);
+  TF_CHECK_OK(memmapped_env.InitializeFromFile(package_path));
+  SavedModel saved_model;
+  MetaGraphDef* const meta_graph_def = saved_model.add_meta_graphs();
+  TF_CHECK_OK(ReadBinaryProto(
+      &memmapped_env, MemmappedFileSystem::kMemmappedPackageDefaultGraphDef,
+      meta_graph_def->mutable_graph_def()));
+  meta_graph_def->mutable_meta_info_def()->add_tags(kSavedModelTagServe);
+  SignatureDef& signature = (*meta_graph_def->mutable_signature_def())
+      [kDefaultServingSignatureDefKey];
+  signature.set_method_name(kPredictMethodName);
+  (*signature.mutable_inputs())["x"].set_name("x:0");
+  (*signature.mutable_outputs())["y"].set_name("y:0");
+  TF_CHECK_OK(WriteBinaryProto(
+      env, io::JoinPath(export_dir, kSavedModelFilenamePb), saved_model));
+}
+
 // Tests SavedModelBundleFactory with native SavedModel.
 class SavedModelBundleFactoryTest : public test_util::BundleFactoryTest {
  public:
@@ -108,6 +198,35 @@ TEST_F(SavedModelBundleFactoryTest, RunOptions) { TestRunOptions(); }
 
 TEST_F(SavedModelBundleFactoryTest, RunOptionsError) { TestRunOptionsError(); }
 
+TEST_F(SavedModelBundleFactoryTest, MemmappedPackageMissing) {
+  SessionBundleConfig config;
+  *config.add_saved_model_tags() = kSavedModelTagServe;
+  config.set_experimental_load_memmapped_package(true);
+  std::unique_ptr<Session> session;
+  // The test SavedModel does not come with a memmapped package.
+  EXPECT_FALSE(CreateSession(config, &session).ok());
+}
+
+TEST_F(SavedModelBundleFactoryTest, MemmappedPackage) {
+  const string export_dir =
+      io::JoinPath(testing::TmpDir(), "memmapped_half_plus_two");
+  CreateMemmappedSavedModel(export_dir);
+
+  SessionBundleConfig config;
+  *config.add_saved_model_tags() = kSavedModelTagServe;
+  config.set_experimental_load_memmapped_package(true);
+  std::unique_ptr<Session> session;
+  TF_ASSERT_OK(CreateSessionFromPath(config, export_dir, &session));
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(
+      session->Run({{"x:0", test::AsTensor<float>({1.0f, 2.0f}, {2})}},
+                   {"y:0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({2.5f, 3.0f}, {2}),
+                                 outputs[0]);
+}
+
 // Tests SavedModelBundleFactory with SessionBundle export.
 class SavedModelBundleFactoryBackwardCompatibilityTest
     : public test_util::BundleFactoryTest {
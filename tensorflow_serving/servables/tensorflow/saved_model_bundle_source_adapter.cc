@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow_serving/servables/tensorflow/saved_model_bundle_source_adapter.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow_serving/core/simple_loader.h"
 #include "tensorflow_serving/resources/resource_util.h"
@@ -26,11 +29,67 @@ limitations under the License.
 #include "tensorflow_serving/resources/resources.pb.h"
 #include "tensorflow_serving/servables/tensorflow/bundle_factory_util.h"
 #include "tensorflow_serving/servables/tensorflow/saved_model_warmup.h"
+#include "tensorflow_serving/servables/tensorflow/signature_plan.h"
 #include "tensorflow_serving/util/optional.h"
+#include "tensorflow_serving/util/read_limited_file_system.h"
 
 namespace tensorflow {
 namespace serving {
 
+namespace {
+
+// A RAM usage measurement below this fraction of the file-size based estimate
+// is taken to be an artifact (e.g. memory freed by other servables while this
+// one was loading) and is neither used nor persisted.
+constexpr double kMinPlausibleMeasuredRamFraction = 0.1;
+
+// Returns the main-memory RAM bytes in 'allocation'.
+uint64 GetRamBytes(const ResourceAllocation& allocation) {
+  ResourceUtil::Options resource_util_options;
+  resource_util_options.devices = {{device_types::kMain, 1}};
+  const ResourceUtil resource_util(resource_util_options);
+  const Resource ram_resource = resource_util.CreateBoundResource(
+      device_types::kMain, resource_kinds::kRamBytes);
+  return resource_util.GetQuantity(ram_resource, allocation);
+}
+
+// Sets the main-memory RAM bytes in 'allocation' to 'ram_bytes'.
+void SetRamBytes(const uint64 ram_bytes, ResourceAllocation* allocation) {
+  ResourceUtil::Options resource_util_options;
+  resource_util_options.devices = {{device_types::kMain, 1}};
+  const ResourceUtil resource_util(resource_util_options);
+  const Resource ram_resource = resource_util.CreateBoundResource(
+      device_types::kMain, resource_kinds::kRamBytes);
+  resource_util.SetQuantity(ram_resource, ram_bytes, allocation);
+}
+
+// A SimpleLoader that also owns the SignaturePlans of the bundle it loads,
+// for exactly as long as the bundle is loaded.
+class SavedModelBundleLoader : public SimpleLoader<SavedModelBundle> {
+ public:
+  using SimpleLoader<SavedModelBundle>::SimpleLoader;
+
+  ~SavedModelBundleLoader() override = default;
+
+  Status Load() override {
+    TF_RETURN_IF_ERROR(SimpleLoader<SavedModelBundle>::Load());
+    signature_plans_.reset(new ScopedSignaturePlans(
+        &servable().get<SavedModelBundle>()->meta_graph_def));
+    return Status::OK();
+  }
+
+  void Unload() override {
+    signature_plans_.reset();
+    SimpleLoader<SavedModelBundle>::Unload();
+  }
+
+ private:
+  // Members are destroyed before the base class, hence before the bundle.
+  std::unique_ptr<ScopedSignaturePlans> signature_plans_;
+};
+
+}  // namespace
+
 Status SavedModelBundleSourceAdapter::Create(
     const SessionBundleSourceAdapterConfig& config,
     std::unique_ptr<SavedModelBundleSourceAdapter>* adapter) {
@@ -45,48 +104,164 @@ SavedModelBundleSourceAdapter::~SavedModelBundleSourceAdapter() { Detach(); }
 
 SavedModelBundleSourceAdapter::SavedModelBundleSourceAdapter(
     std::unique_ptr<SavedModelBundleFactory> bundle_factory)
-    : bundle_factory_(std::move(bundle_factory)) {}
+    : bundle_factory_(std::move(bundle_factory)),
+      load_governance_enabled_(std::make_shared<std::atomic<bool>>(true)) {
+  const uint64 read_bytes_per_second =
+      bundle_factory_->config().experimental_load_read_bytes_per_second();
+  if (read_bytes_per_second > 0) {
+    // Permit bursts of up to one second's worth of reads.
+    load_read_limiter_ = std::make_shared<TokenBucket>(
+        Env::Default(), read_bytes_per_second, read_bytes_per_second);
+  }
+}
+
+void SavedModelBundleSourceAdapter::SetLoadGovernanceEnabled(
+    const bool enabled) {
+  *load_governance_enabled_ = enabled;
+}
 
 Status SavedModelBundleSourceAdapter::Convert(const StoragePath& path,
                                               std::unique_ptr<Loader>* loader) {
   std::shared_ptr<SavedModelBundleFactory> bundle_factory = bundle_factory_;
-  auto servable_creator = [bundle_factory,
-                           path](std::unique_ptr<SavedModelBundle>* bundle) {
-    TF_RETURN_IF_ERROR(bundle_factory->CreateSavedModelBundle(path, bundle));
+  std::shared_ptr<TokenBucket> load_read_limiter = load_read_limiter_;
+  std::shared_ptr<std::atomic<bool>> load_governance_enabled =
+      load_governance_enabled_;
+  // The RAM usage measured across the most recent load, if any. Written by the
+  // servable creator and read by the post-load resource estimator, which the
+  // loader calls in turn from Load().
+  auto measured_ram_bytes = std::make_shared<optional<uint64>>();
+  // The (memoized) pre-load RAM estimate, which the post-load estimate may
+  // not exceed. Written by the resource estimator, which the loader calls
+  // before Load().
+  auto pre_load_ram_bytes = std::make_shared<optional<uint64>>();
+  // Loads the bundle from 'load_path', which names the same files as 'path'
+  // but may route reads through a read-limited file system, and warms it up.
+  // Warmup and all logs and metrics refer to the bundle by 'path'.
+  auto load_and_warm_up = [bundle_factory, path, measured_ram_bytes](
+                              const string& load_path,
+                              std::unique_ptr<SavedModelBundle>* bundle) {
+    const bool measure_ram =
+        bundle_factory->config().experimental_measure_ram_usage_during_load();
+    uint64 ram_bytes_before_load = 0;
+    if (measure_ram) {
+      const Status measure_status =
+          GetProcessResidentRamBytes(&ram_bytes_before_load);
+      if (!measure_status.ok()) {
+        LOG(WARNING) << "Unable to measure RAM usage while loading " << path
+                     << ": " << measure_status;
+        ram_bytes_before_load = 0;
+      }
+    }
+
+    TF_RETURN_IF_ERROR(
+        bundle_factory->CreateSavedModelBundle(load_path, bundle));
     if (bundle_factory->config().enable_model_warmup()) {
-      return RunSavedModelWarmup(GetRunOptions(bundle_factory->config()), path,
-                                 bundle->get());
+      const SessionBundleConfig& config = bundle_factory->config();
+      TF_RETURN_IF_ERROR(RunSavedModelWarmup(
+          config.model_warmup_options(), GetWarmupBatchSizes(config),
+          GetRunOptions(config), path, bundle->get()));
+    }
+
+    uint64 ram_bytes_after_load = 0;
+    if (ram_bytes_before_load > 0 &&
+        GetProcessResidentRamBytes(&ram_bytes_after_load).ok()) {
+      const uint64 ram_bytes =
+          ram_bytes_after_load > ram_bytes_before_load
+              ? ram_bytes_after_load - ram_bytes_before_load
+              : 0;
+      LOG(INFO) << "Measured " << ram_bytes
+                << " bytes of RAM usage while loading " << path;
+      ResourceAllocation path_estimate;
+      uint64 path_estimate_ram_bytes = 0;
+      if (EstimateResourceFromPath(path, &path_estimate).ok()) {
+        path_estimate_ram_bytes = GetRamBytes(path_estimate);
+      }
+      const uint64 min_plausible_ram_bytes = std::max(
+          uint64{1}, static_cast<uint64>(path_estimate_ram_bytes *
+                                         kMinPlausibleMeasuredRamFraction));
+      if (ram_bytes < min_plausible_ram_bytes) {
+        LOG(WARNING) << "Ignoring implausibly low measured RAM usage of "
+                     << ram_bytes << " bytes while loading " << path;
+        return Status::OK();
+      }
+      *measured_ram_bytes = ram_bytes;
+      const string& measured_ram_usage_dir =
+          bundle_factory->config().experimental_measured_ram_usage_dir();
+      if (!measured_ram_usage_dir.empty() && path_estimate_ram_bytes > 0) {
+        const Status persist_status =
+            WriteMeasuredRamUsage(measured_ram_usage_dir, path, ram_bytes,
+                                  path_estimate_ram_bytes);
+        if (!persist_status.ok()) {
+          LOG(WARNING) << "Unable to persist measured RAM usage for " << path
+                       << ": " << persist_status;
+        }
+      }
     }
     return Status::OK();
   };
-  auto resource_estimator = [bundle_factory,
-                             path](ResourceAllocation* estimate) {
+  auto servable_creator = [bundle_factory, load_read_limiter,
+                           load_governance_enabled, path, load_and_warm_up](
+                              std::unique_ptr<SavedModelBundle>* bundle) {
+    if (!*load_governance_enabled) {
+      return load_and_warm_up(path, bundle);
+    }
+    // Route all of the load's reads, including those of TensorFlow's restore
+    // op, through 'load_read_limiter'.
+    std::unique_ptr<ScopedReadLimitedPath> limited_path;
+    if (load_read_limiter != nullptr) {
+      limited_path.reset(new ScopedReadLimitedPath(path, load_read_limiter));
+    }
+    const string& load_path =
+        limited_path != nullptr ? limited_path->path() : path;
+    const int32 nice_increment =
+        bundle_factory->config().experimental_load_thread_nice_increment();
+    if (nice_increment > 0) {
+      return RunInLowPriorityThread(nice_increment, [&]() {
+        return load_and_warm_up(load_path, bundle);
+      });
+    }
+    return load_and_warm_up(load_path, bundle);
+  };
+  auto resource_estimator = [bundle_factory, path,
+                             pre_load_ram_bytes](ResourceAllocation* estimate) {
     TF_RETURN_IF_ERROR(
         bundle_factory->EstimateResourceRequirement(path, estimate));
 
     // Add experimental_transient_ram_bytes_during_load.
     // TODO(b/38376838): Remove once resource estimates are moved inside
     // SavedModel.
-    ResourceUtil::Options resource_util_options;
-    resource_util_options.devices = {{device_types::kMain, 1}};
-    std::unique_ptr<ResourceUtil> resource_util =
-        std::unique_ptr<ResourceUtil>(new ResourceUtil(resource_util_options));
-    const Resource ram_resource = resource_util->CreateBoundResource(
-        device_types::kMain, resource_kinds::kRamBytes);
-    resource_util->SetQuantity(
-        ram_resource,
-        resource_util->GetQuantity(ram_resource, *estimate) +
-            bundle_factory->config()
-                .experimental_transient_ram_bytes_during_load(),
-        estimate);
+    SetRamBytes(GetRamBytes(*estimate) +
+                    bundle_factory->config()
+                        .experimental_transient_ram_bytes_during_load(),
+                estimate);
+    *pre_load_ram_bytes = GetRamBytes(*estimate);
 
     return Status::OK();
   };
-  auto post_load_resource_estimator = [bundle_factory,
-                                       path](ResourceAllocation* estimate) {
-    return bundle_factory->EstimateResourceRequirement(path, estimate);
+  auto post_load_resource_estimator = [bundle_factory, path,
+                                       measured_ram_bytes, pre_load_ram_bytes](
+                                          ResourceAllocation* estimate) {
+    // Note that this may read back the measurement persisted by this very
+    // load, hence the cap below.
+    TF_RETURN_IF_ERROR(
+        bundle_factory->EstimateResourceRequirement(path, estimate));
+    if (*measured_ram_bytes) {
+      SetRamBytes(**measured_ram_bytes, estimate);
+    }
+
+    // The estimate of a loaded servable may only decrease (see
+    // Loader::EstimateResources()), so it is capped at the pre-load one.
+    const uint64 ram_bytes = GetRamBytes(*estimate);
+    if (*pre_load_ram_bytes && ram_bytes > **pre_load_ram_bytes) {
+      LOG(WARNING) << "Post-load RAM estimate of " << ram_bytes
+                   << " bytes for " << path << " exceeds its pre-load estimate"
+                   << " of " << **pre_load_ram_bytes
+                   << " bytes; keeping the latter";
+      SetRamBytes(**pre_load_ram_bytes, estimate);
+    }
+    return Status::OK();
   };
-  loader->reset(new SimpleLoader<SavedModelBundle>(
+  loader->reset(new SavedModelBundleLoader(
       servable_creator, resource_estimator, post_load_resource_estimator));
   return Status::OK();
 }
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SAVED_MODEL_BUNDLE_SOURCE_ADAPTER_H_
 #define TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SAVED_MODEL_BUNDLE_SOURCE_ADAPTER_H_
 
+#include <atomic>
+#include <memory>
+
 #include "tensorflow/cc/saved_model/loader.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
@@ -25,6 +28,7 @@ limitations under the License.
 #include "tensorflow_serving/servables/tensorflow/saved_model_bundle_factory.h"
 #include "tensorflow_serving/servables/tensorflow/saved_model_bundle_source_adapter.pb.h"
 #include "tensorflow_serving/servables/tensorflow/session_bundle_source_adapter.pb.h"
+#include "tensorflow_serving/util/token_bucket.h"
 
 namespace tensorflow {
 namespace serving {
@@ -48,6 +52,14 @@ class SavedModelBundleSourceAdapter final
       std::unique_ptr<SourceAdapter<StoragePath, std::unique_ptr<Loader>>>*)>
   GetCreator(const SessionBundleSourceAdapterConfig& config);
 
+  // Enables or disables, for the loads of the Loaders we emit that start from
+  // now on, the load governance limits of our config
+  // (experimental_load_read_bytes_per_second and
+  // experimental_load_thread_nice_increment). Enabled by default. A server may
+  // disable them while it serves no traffic, e.g. while it loads its initial
+  // models, so that those loads run flat out.
+  void SetLoadGovernanceEnabled(bool enabled);
+
  private:
   friend class SavedModelBundleSourceAdapterCreator;
 
@@ -61,6 +73,15 @@ class SavedModelBundleSourceAdapter final
   // outlive this object.
   std::shared_ptr<SavedModelBundleFactory> bundle_factory_;
 
+  // Limits the read throughput of loads, if configured via
+  // 'experimental_load_read_bytes_per_second'; otherwise null. Shared by all
+  // loads of the Loaders we emit.
+  std::shared_ptr<TokenBucket> load_read_limiter_;
+
+  // Whether the load governance limits are in effect. Shared with the Loaders
+  // we emit, in case they outlive this object.
+  std::shared_ptr<std::atomic<bool>> load_governance_enabled_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(SavedModelBundleSourceAdapter);
 };
 
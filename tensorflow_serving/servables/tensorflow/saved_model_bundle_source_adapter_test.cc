@@ -120,6 +120,30 @@ TEST_P(SavedModelBundleSourceAdapterTest, BackwardCompatibility) {
       test_util::GetTestSessionBundleExportPath());
 }
 
+TEST_P(SavedModelBundleSourceAdapterTest, MeasureRamUsageDuringLoad) {
+  config_.mutable_config()->set_experimental_measure_ram_usage_during_load(
+      true);
+  std::unique_ptr<SavedModelBundleSourceAdapter> adapter;
+  TF_ASSERT_OK(SavedModelBundleSourceAdapter::Create(config_, &adapter));
+  ServableData<std::unique_ptr<Loader>> loader_data = adapter->AdaptOneVersion(
+      ServableData<StoragePath>({"", 0}, test_util::GetTestSavedModelPath()));
+  TF_ASSERT_OK(loader_data.status());
+  std::unique_ptr<Loader> loader = loader_data.ConsumeDataOrDie();
+
+  ResourceAllocation pre_load_resource_estimate;
+  TF_ASSERT_OK(loader->EstimateResources(&pre_load_resource_estimate));
+  TF_ASSERT_OK(loader->Load());
+
+  // The measurement may only tighten the estimate.
+  ResourceAllocation post_load_resource_estimate;
+  TF_ASSERT_OK(loader->EstimateResources(&post_load_resource_estimate));
+  EXPECT_LE(
+      resource_util_->GetQuantity(ram_resource_, post_load_resource_estimate),
+      resource_util_->GetQuantity(ram_resource_, pre_load_resource_estimate));
+
+  loader->Unload();
+}
+
 // Test all SavedModelBundleSourceAdapterTest test cases with
 // warmup enabled/disabled.
 INSTANTIATE_TEST_CASE_P(EnableWarmup, SavedModelBundleSourceAdapterTest,
@@ -15,17 +15,30 @@ limitations under the License.
 
 #include "tensorflow_serving/servables/tensorflow/saved_model_warmup.h"
 
+#include <string.h>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow_serving/apis/prediction_log.pb.h"
+#include "tensorflow_serving/core/load_phase_recorder.h"
 #include "tensorflow_serving/servables/tensorflow/classifier.h"
 #include "tensorflow_serving/servables/tensorflow/multi_inference.h"
 #include "tensorflow_serving/servables/tensorflow/predict_util.h"
 #include "tensorflow_serving/servables/tensorflow/regressor.h"
+#include "tensorflow_serving/servables/tensorflow/session_run_util.h"
 #include "tensorflow_serving/servables/tensorflow/util.h"
 
 namespace tensorflow {
@@ -67,9 +80,10 @@ Status RunWarmupRequest(const PredictionLog& warmup_record,
     } break;
     case PredictionLog::kPredictLog: {
       PredictResponse response;
-      TF_RETURN_IF_ERROR(RunPredict(run_options, meta_graph_def, {}, session,
-                                    warmup_record.predict_log().request(),
-                                    &response));
+      TF_RETURN_IF_ERROR(RunPredict(
+          run_options, meta_graph_def, {},
+          PredictResponseTensorSerializationOption::kAsProtoField, session,
+          warmup_record.predict_log().request(), &response));
     } break;
     case PredictionLog::kMultiInferenceLog: {
       MultiInferenceResponse response;
@@ -77,33 +91,55 @@ Status RunWarmupRequest(const PredictionLog& warmup_record,
           run_options, meta_graph_def, {}, session,
           warmup_record.multi_inference_log().request(), &response));
     } break;
-    case PredictionLog::kSessionRunLog:
-      return errors::Unimplemented(strings::StrCat(
-          "Unsupported log_type for warmup: ", warmup_record.log_type_case()));
+    case PredictionLog::kSessionRunLog: {
+      SessionRunResponse response;
+      TF_RETURN_IF_ERROR(
+          RunSessionRun(run_options, meta_graph_def, {}, session,
+                        warmup_record.session_run_log().request(), &response));
+    } break;
     default:
       break;
   }
   return Status::OK();
 }
 
-}  // namespace
-
-constexpr char WarmupConsts::kRequestsFileName[];
-constexpr int WarmupConsts::kMaxNumRecords;
-
-Status RunSavedModelWarmup(const RunOptions& run_options,
-                           const string& export_dir, SavedModelBundle* bundle) {
-  const uint64 start_microseconds = Env::Default()->NowMicros();
-  const string warmup_path =
-      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
-                   WarmupConsts::kRequestsFileName);
-  if (!tensorflow::Env::Default()->FilesExist({warmup_path}, nullptr)) {
-    LOG(INFO) << "No warmup data file found at " << warmup_path;
-    // Having warmup data is optional, return OK
+// Invokes 'fn' for each index in [0, num_requests) on 'num_threads' threads
+// (or on the calling thread, if 'num_threads' <= 1), and returns the first
+// error. Once an error has occurred, the remaining requests are skipped.
+Status RunConcurrently(const int num_threads, const int num_requests,
+                       const std::function<Status(int)>& fn) {
+  if (num_threads <= 1 || num_requests <= 1) {
+    for (int i = 0; i < num_requests; ++i) {
+      TF_RETURN_IF_ERROR(fn(i));
+    }
     return Status::OK();
   }
 
-  LOG(INFO) << "Starting to read warmup data for model at " << warmup_path;
+  mutex mu;
+  Status status;
+  {
+    // The pool's destructor waits for all scheduled requests to finish.
+    thread::ThreadPool pool(Env::Default(), "model_warmup", num_threads);
+    for (int i = 0; i < num_requests; ++i) {
+      pool.Schedule([&mu, &status, &fn, i]() {
+        {
+          mutex_lock l(mu);
+          if (!status.ok()) return;
+        }
+        const Status request_status = fn(i);
+        if (!request_status.ok()) {
+          mutex_lock l(mu);
+          status.Update(request_status);
+        }
+      });
+    }
+  }
+  return status;
+}
+
+// Reads all warmup records from the file at 'warmup_path'.
+Status ReadWarmupRecords(const string& warmup_path,
+                         std::vector<PredictionLog>* warmup_records) {
   std::unique_ptr<tensorflow::RandomAccessFile> tf_record_file;
   TF_RETURN_IF_ERROR(tensorflow::Env::Default()->NewRandomAccessFile(
       warmup_path, &tf_record_file));
@@ -111,21 +147,16 @@ Status RunSavedModelWarmup(const RunOptions& run_options,
   std::unique_ptr<tensorflow::io::SequentialRecordReader> tf_record_file_reader;
   tf_record_file_reader.reset(
       new tensorflow::io::SequentialRecordReader(tf_record_file.get()));
-  int num_warmup_records = 0;
   string record;
   Status status = tf_record_file_reader->ReadRecord(&record);
-  tensorflow::serving::PredictionLog prediction_log;
   while (status.ok()) {
-    if (!prediction_log.ParseFromString(record)) {
+    warmup_records->emplace_back();
+    if (!warmup_records->back().ParseFromString(record)) {
       return errors::InvalidArgument(strings::StrCat(
           "Failed to parse warmup record: ", record, " from ", warmup_path));
     }
-
-    TF_RETURN_IF_ERROR(RunWarmupRequest(prediction_log, run_options,
-                                        bundle->meta_graph_def,
-                                        bundle->session.get()));
-    ++num_warmup_records;
-    if (num_warmup_records > WarmupConsts::kMaxNumRecords) {
+    if (warmup_records->size() >
+        static_cast<size_t>(WarmupConsts::kMaxNumRecords)) {
       return errors::InvalidArgument(
           "Number of warmup records exceeeds the maximum (",
           WarmupConsts::kMaxNumRecords, ") at ", warmup_path);
@@ -133,17 +164,181 @@ Status RunSavedModelWarmup(const RunOptions& run_options,
     status = tf_record_file_reader->ReadRecord(&record);
   }
 
-  const auto warmup_latency = GetLatencyMicroseconds(start_microseconds);
-  model_warm_up_latency->GetCell(export_dir, status.ToString())
-      ->Add(warmup_latency);
-
   // OUT_OF_RANGE error means EOF was reached, do not return error in this case
   if (!errors::IsOutOfRange(status)) {
     return status;
   }
+  return Status::OK();
+}
+
+// A Session::Run() call synthesized from a SignatureDef.
+struct SynthesizedRequest {
+  string signature_name;
+  int64 batch_size;
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_tensor_names;
+};
+
+// Builds a zero-valued (or, for strings, empty) tensor matching 'tensor_info',
+// with unknown dimensions set to 'batch_size' for the outer one and to 1 for
+// the others. Returns false if no such tensor can be built. Sets
+// '*is_batched' to whether the outer dimension is unknown.
+bool SynthesizeInputTensor(const TensorInfo& tensor_info,
+                           const int64 batch_size, Tensor* tensor,
+                           bool* is_batched) {
+  const DataType dtype = tensor_info.dtype();
+  if (tensor_info.tensor_shape().unknown_rank() ||
+      (dtype != DT_STRING && !DataTypeCanUseMemcpy(dtype))) {
+    return false;
+  }
+  TensorShape shape;
+  *is_batched = false;
+  for (int i = 0; i < tensor_info.tensor_shape().dim_size(); ++i) {
+    int64 size = tensor_info.tensor_shape().dim(i).size();
+    if (size < 0) {
+      if (i == 0) *is_batched = true;
+      size = i == 0 ? batch_size : 1;
+    }
+    shape.AddDim(size);
+  }
+  *tensor = Tensor(dtype, shape);
+  if (dtype != DT_STRING) {
+    memset(const_cast<char*>(tensor->tensor_data().data()), 0,
+           tensor->tensor_data().size());
+  }
+  return true;
+}
+
+// Synthesizes one request per batch size in 'batch_sizes' for each
+// SignatureDef in 'meta_graph_def'. Signatures whose inputs have no batch
+// dimension yield a single request, and those whose inputs cannot be
+// synthesized (e.g. of unknown rank) are skipped.
+std::vector<SynthesizedRequest> SynthesizeWarmupRequests(
+    const MetaGraphDef& meta_graph_def,
+    const std::vector<int64>& batch_sizes) {
+  std::vector<SynthesizedRequest> requests;
+  for (const auto& signature : meta_graph_def.signature_def()) {
+    const SignatureDef& signature_def = signature.second;
+    if (signature_def.inputs().empty() || signature_def.outputs().empty()) {
+      continue;
+    }
+    for (const int64 batch_size : batch_sizes) {
+      SynthesizedRequest request;
+      request.signature_name = signature.first;
+      request.batch_size = batch_size;
+      bool is_batched = false;
+      bool synthesizable = true;
+      for (const auto& input : signature_def.inputs()) {
+        Tensor tensor;
+        bool is_input_batched;
+        if (!SynthesizeInputTensor(input.second, batch_size, &tensor,
+                                   &is_input_batched)) {
+          synthesizable = false;
+          break;
+        }
+        is_batched |= is_input_batched;
+        request.inputs.emplace_back(input.second.name(), std::move(tensor));
+      }
+      if (!synthesizable) {
+        LOG(WARNING) << "Unable to synthesize warmup inputs for signature "
+                     << signature.first;
+        break;
+      }
+      for (const auto& output : signature_def.outputs()) {
+        request.output_tensor_names.push_back(output.second.name());
+      }
+      requests.push_back(std::move(request));
+      if (!is_batched) break;
+    }
+  }
+  return requests;
+}
+
+}  // namespace
+
+constexpr char WarmupConsts::kRequestsFileName[];
+constexpr int WarmupConsts::kMaxNumRecords;
+
+std::vector<int64> GetWarmupBatchSizes(const SessionBundleConfig& config) {
+  if (config.has_batching_parameters() &&
+      config.batching_parameters().allowed_batch_sizes_size() > 0) {
+    return {config.batching_parameters().allowed_batch_sizes().begin(),
+            config.batching_parameters().allowed_batch_sizes().end()};
+  }
+  return {1};
+}
+
+Status RunSavedModelWarmup(const RunOptions& run_options,
+                           const string& export_dir, SavedModelBundle* bundle) {
+  return RunSavedModelWarmup(ModelWarmupOptions(), {}, run_options, export_dir,
+                             bundle);
+}
+
+Status RunSavedModelWarmup(const ModelWarmupOptions& model_warmup_options,
+                           const std::vector<int64>& synthesized_batch_sizes,
+                           const RunOptions& run_options,
+                           const string& export_dir, SavedModelBundle* bundle) {
+  ScopedLoadPhase load_phase("warmup");
+  const uint64 start_microseconds = Env::Default()->NowMicros();
+  const string warmup_path =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                   WarmupConsts::kRequestsFileName);
+  const bool synthesize =
+      model_warmup_options.synthesize_requests_from_signatures();
+  const bool has_warmup_file =
+      tensorflow::Env::Default()->FilesExist({warmup_path}, nullptr);
+  if (!has_warmup_file) {
+    LOG(INFO) << "No warmup data file found at " << warmup_path;
+    if (!synthesize) {
+      // Having warmup data is optional, return OK
+      return Status::OK();
+    }
+  }
+
+  std::vector<PredictionLog> warmup_records;
+  if (has_warmup_file) {
+    LOG(INFO) << "Starting to read warmup data for model at " << warmup_path;
+    TF_RETURN_IF_ERROR(ReadWarmupRecords(warmup_path, &warmup_records));
+  }
+  const Status status = RunConcurrently(
+      model_warmup_options.num_threads(), warmup_records.size(),
+      [&](const int i) {
+        return RunWarmupRequest(warmup_records[i], run_options,
+                                bundle->meta_graph_def, bundle->session.get());
+      });
+
+  int num_synthesized_requests = 0;
+  if (status.ok() && synthesize) {
+    // Run one at a time, so that a batching session forms a batch of exactly
+    // each allowed size rather than merging concurrent requests.
+    for (const SynthesizedRequest& request : SynthesizeWarmupRequests(
+             bundle->meta_graph_def, synthesized_batch_sizes)) {
+      std::vector<Tensor> outputs;
+      RunMetadata run_metadata;
+      const Status run_status = bundle->session->Run(
+          run_options, request.inputs, request.output_tensor_names, {},
+          &outputs, &run_metadata);
+      if (!run_status.ok()) {
+        // Zero-valued inputs may legitimately be rejected by the model, so
+        // failing to run them does not fail the load.
+        LOG(WARNING) << "Synthesized warmup request for signature "
+                     << request.signature_name << " with batch size "
+                     << request.batch_size << " failed: " << run_status;
+        continue;
+      }
+      ++num_synthesized_requests;
+    }
+  }
+
+  const auto warmup_latency = GetLatencyMicroseconds(start_microseconds);
+  model_warm_up_latency->GetCell(export_dir, status.ToString())
+      ->Add(warmup_latency);
+  TF_RETURN_IF_ERROR(status);
 
-  LOG(INFO) << "Finished reading warmup data for model at " << warmup_path
-            << ". Number of warmup records read: " << num_warmup_records
+  LOG(INFO) << "Finished warmup for model at " << export_dir
+            << ". Number of warmup records read: " << warmup_records.size()
+            << ". Number of synthesized warmup requests run: "
+            << num_synthesized_requests
             << ". Elapsed time (microseconds): " << warmup_latency << ".";
   return Status::OK();
 }
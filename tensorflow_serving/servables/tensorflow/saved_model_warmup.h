@@ -17,10 +17,12 @@ limitations under the License.
 #define TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SAVED_MODEL_WARMUP_H_
 
 #include <string>
+#include <vector>
 
 #include "tensorflow/cc/saved_model/loader.h"
 #include "tensorflow/core/protobuf/saved_model.pb.h"
 #include "tensorflow/core/public/session.h"
+#include "tensorflow_serving/servables/tensorflow/session_bundle_config.pb.h"
 
 namespace tensorflow {
 namespace serving {
@@ -39,6 +41,23 @@ struct WarmupConsts {
 Status RunSavedModelWarmup(const RunOptions& run_options,
                            const string& export_dir, SavedModelBundle* bundle);
 
+// As above, but replays the warmup requests concurrently on
+// 'model_warmup_options.num_threads()' threads. If
+// 'model_warmup_options.synthesize_requests_from_signatures()' is set, then
+// afterwards (and even without a warmup file) a request with zero-valued inputs
+// is synthesized from each SignatureDef for every batch size in
+// 'synthesized_batch_sizes', and run one at a time. Failures of synthesized
+// requests are logged but do not fail the warmup.
+Status RunSavedModelWarmup(const ModelWarmupOptions& model_warmup_options,
+                           const std::vector<int64>& synthesized_batch_sizes,
+                           const RunOptions& run_options,
+                           const string& export_dir, SavedModelBundle* bundle);
+
+// Returns the batch sizes to synthesize warmup requests for: the allowed batch
+// sizes of the batching layer configured in 'config' (so that every padded
+// batch shape is warmed up), or just 1 without batching or allowed sizes.
+std::vector<int64> GetWarmupBatchSizes(const SessionBundleConfig& config);
+
 }  // namespace serving
 }  // namespace tensorflow
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/contrib/session_bundle/signature.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/named_tensor.pb.h"
 #include "tensorflow_serving/apis/classification.pb.h"
 #include "tensorflow_serving/apis/inference.pb.h"
 #include "tensorflow_serving/apis/input.pb.h"
@@ -37,7 +39,9 @@ limitations under the License.
 #include "tensorflow_serving/apis/predict.pb.h"
 #include "tensorflow_serving/apis/prediction_log.pb.h"
 #include "tensorflow_serving/apis/regression.pb.h"
+#include "tensorflow_serving/apis/session_service.pb.h"
 #include "tensorflow_serving/core/test_util/mock_session.h"
+#include "tensorflow_serving/servables/tensorflow/session_bundle_config.pb.h"
 
 namespace tensorflow {
 namespace serving {
@@ -47,6 +51,8 @@ namespace {
 using test_util::MockSession;
 using ::testing::_;
 using ::testing::DoAll;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::SizeIs;
@@ -88,6 +94,15 @@ void PopulateRegressionRequest(RegressionRequest* request) {
   request->mutable_model_spec()->set_signature_name(kRegressMethodName);
 }
 
+void PopulateSessionRunRequest(SessionRunRequest* request) {
+  NamedTensorProto* feed = request->add_feed();
+  feed->set_name(kPredictInputs);
+  feed->mutable_tensor()->add_string_val("input_value");
+  feed->mutable_tensor()->set_dtype(tensorflow::DT_STRING);
+  feed->mutable_tensor()->mutable_tensor_shape()->add_dim()->set_size(1);
+  request->add_fetch(kPredictOutputs);
+}
+
 void PopulatePredictionLog(PredictionLog* prediction_log,
                            PredictionLog::LogTypeCase log_type) {
   switch (log_type) {
@@ -107,9 +122,10 @@ void PopulatePredictionLog(PredictionLog* prediction_log,
       PopulateMultiInferenceRequest(
           prediction_log->mutable_multi_inference_log()->mutable_request());
     } break;
-    case PredictionLog::kSessionRunLog:
-      prediction_log->mutable_session_run_log();
-      TF_FALLTHROUGH_INTENDED;
+    case PredictionLog::kSessionRunLog: {
+      PopulateSessionRunRequest(
+          prediction_log->mutable_session_run_log()->mutable_request());
+    } break;
     default:
       return;
   }
@@ -212,6 +228,109 @@ TEST(SavedModelBundleWarmupTest, MixedWarmupData) {
       RunSavedModelWarmup(RunOptions(), base_path, &saved_model_bundle));
 }
 
+TEST(SavedModelBundleWarmupTest, ConcurrentWarmupData) {
+  string base_path = io::JoinPath(testing::TmpDir(), "ConcurrentWarmupData");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(
+      io::JoinPath(base_path, kSavedModelAssetsExtraDirectory)));
+  string fname = io::JoinPath(base_path, kSavedModelAssetsExtraDirectory,
+                              WarmupConsts::kRequestsFileName);
+
+  int num_warmup_records = 10;
+  std::vector<string> warmup_records;
+  AddMixedWarmupData(&warmup_records);
+  TF_ASSERT_OK(WriteWarmupData(fname, warmup_records, num_warmup_records));
+  SavedModelBundle saved_model_bundle;
+  AddSignatures(&saved_model_bundle.meta_graph_def);
+  MockSession* mock = new MockSession;
+  saved_model_bundle.session.reset(mock);
+  Tensor scores(DT_FLOAT, TensorShape({1, 1}));
+  Tensor classes(DT_STRING, TensorShape({1, 1}));
+  // Regress and Predict case
+  EXPECT_CALL(*mock, Run(_, _, SizeIs(1), _, _, _))
+      .Times(num_warmup_records * 2)
+      .WillRepeatedly(DoAll(SetArgPointee<4>(std::vector<Tensor>({scores})),
+                            Return(Status::OK())));
+  // Classify case
+  EXPECT_CALL(*mock, Run(_, _, SizeIs(2), _, _, _))
+      .Times(num_warmup_records)
+      .WillRepeatedly(
+          DoAll(SetArgPointee<4>(std::vector<Tensor>({classes, scores})),
+                Return(Status::OK())));
+  // MultiInference case
+  EXPECT_CALL(*mock, Run(_, _, SizeIs(3), _, _, _))
+      .Times(num_warmup_records)
+      .WillRepeatedly(DoAll(
+          SetArgPointee<4>(std::vector<Tensor>({classes, scores, scores})),
+          Return(Status::OK())));
+  ModelWarmupOptions model_warmup_options;
+  model_warmup_options.set_num_threads(4);
+  TF_EXPECT_OK(RunSavedModelWarmup(model_warmup_options, {}, RunOptions(),
+                                   base_path, &saved_model_bundle));
+}
+
+TEST(SavedModelBundleWarmupTest, SynthesizedRequests) {
+  string base_path = io::JoinPath(testing::TmpDir(), "SynthesizedRequests");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(
+      io::JoinPath(base_path, kSavedModelAssetsExtraDirectory)));
+
+  SavedModelBundle saved_model_bundle;
+  auto* signature_defs =
+      saved_model_bundle.meta_graph_def.mutable_signature_def();
+  SignatureDef batched_signature =
+      CreateSignatureDef(kPredictMethodName, {"x"}, {"y"});
+  TensorInfo* batched_input = &(*batched_signature.mutable_inputs())["x"];
+  batched_input->set_dtype(DT_FLOAT);
+  batched_input->mutable_tensor_shape()->add_dim()->set_size(-1);
+  batched_input->mutable_tensor_shape()->add_dim()->set_size(3);
+  (*signature_defs)["batched"] = batched_signature;
+  // Inputs of unknown rank cannot be synthesized.
+  SignatureDef unknown_rank_signature =
+      CreateSignatureDef(kPredictMethodName, {"z"}, {"y"});
+  TensorInfo* unknown_rank_input =
+      &(*unknown_rank_signature.mutable_inputs())["z"];
+  unknown_rank_input->set_dtype(DT_FLOAT);
+  unknown_rank_input->mutable_tensor_shape()->set_unknown_rank(true);
+  (*signature_defs)["unknown_rank"] = unknown_rank_signature;
+
+  MockSession* mock = new MockSession;
+  saved_model_bundle.session.reset(mock);
+  std::vector<TensorShape> input_shapes;
+  EXPECT_CALL(*mock, Run(_, _, ElementsAre("y"), _, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke(
+          [&input_shapes](
+              const RunOptions& run_options,
+              const std::vector<std::pair<string, Tensor>>& inputs,
+              const std::vector<string>& output_tensor_names,
+              const std::vector<string>& target_node_names,
+              std::vector<Tensor>* outputs, RunMetadata* run_metadata) {
+            EXPECT_EQ(1, inputs.size());
+            EXPECT_EQ("x", inputs[0].first);
+            input_shapes.push_back(inputs[0].second.shape());
+            // The first synthesized request fails, which does not fail the
+            // warmup.
+            if (input_shapes.size() == 1) {
+              return errors::InvalidArgument("Run failed");
+            }
+            return Status::OK();
+          }));
+
+  ModelWarmupOptions model_warmup_options;
+  model_warmup_options.set_synthesize_requests_from_signatures(true);
+  TF_EXPECT_OK(RunSavedModelWarmup(model_warmup_options, {2, 4}, RunOptions(),
+                                   base_path, &saved_model_bundle));
+  EXPECT_THAT(input_shapes,
+              ElementsAre(TensorShape({2, 3}), TensorShape({4, 3})));
+}
+
+TEST(SavedModelBundleWarmupTest, WarmupBatchSizes) {
+  SessionBundleConfig config;
+  EXPECT_THAT(GetWarmupBatchSizes(config), ElementsAre(1));
+  config.mutable_batching_parameters()->add_allowed_batch_sizes(8);
+  config.mutable_batching_parameters()->add_allowed_batch_sizes(32);
+  EXPECT_THAT(GetWarmupBatchSizes(config), ElementsAre(8, 32));
+}
+
 TEST(SavedModelBundleWarmupTest, NoWarmupDataFile) {
   string base_path = io::JoinPath(testing::TmpDir(), "NoWarmupDataFile");
   TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(
@@ -244,31 +363,31 @@ TEST(SavedModelBundleWarmupTest, WarmupDataFileEmpty) {
       RunSavedModelWarmup(RunOptions(), base_path, &saved_model_bundle));
 }
 
-TEST(SavedModelBundleWarmupTest, UnsupportedLogType) {
-  string base_path = io::JoinPath(testing::TmpDir(), "UnsupportedLogType");
+TEST(SavedModelBundleWarmupTest, SessionRunWarmupData) {
+  string base_path = io::JoinPath(testing::TmpDir(), "SessionRunWarmupData");
   TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(
       io::JoinPath(base_path, kSavedModelAssetsExtraDirectory)));
   string fname = io::JoinPath(base_path, kSavedModelAssetsExtraDirectory,
                               WarmupConsts::kRequestsFileName);
 
+  int num_warmup_records = 10;
   std::vector<string> warmup_records;
-  // Add unsupported log type
   PredictionLog prediction_log;
   PopulatePredictionLog(&prediction_log, PredictionLog::kSessionRunLog);
   warmup_records.push_back(prediction_log.SerializeAsString());
-  TF_ASSERT_OK(WriteWarmupData(fname, warmup_records, 10));
+  TF_ASSERT_OK(WriteWarmupData(fname, warmup_records, num_warmup_records));
   SavedModelBundle saved_model_bundle;
   AddSignatures(&saved_model_bundle.meta_graph_def);
   MockSession* mock = new MockSession;
   saved_model_bundle.session.reset(mock);
-  EXPECT_CALL(*mock, Run(_, _, _, _, _, _))
-      .WillRepeatedly(Return(Status::OK()));
-  const Status status =
-      RunSavedModelWarmup(RunOptions(), base_path, &saved_model_bundle);
-  ASSERT_FALSE(status.ok());
-  EXPECT_EQ(::tensorflow::error::UNIMPLEMENTED, status.code()) << status;
-  EXPECT_THAT(status.ToString(),
-              ::testing::HasSubstr("Unsupported log_type for warmup"));
+  Tensor output(DT_STRING, TensorShape({1}));
+  EXPECT_CALL(*mock, Run(_, SizeIs(1), ElementsAre(kPredictOutputs), SizeIs(0),
+                         _, _))
+      .Times(num_warmup_records)
+      .WillRepeatedly(DoAll(SetArgPointee<4>(std::vector<Tensor>({output})),
+                            Return(Status::OK())));
+  TF_EXPECT_OK(
+      RunSavedModelWarmup(RunOptions(), base_path, &saved_model_bundle));
 }
 
 TEST(SavedModelBundleWarmupTest, TooManyWarmupRecords) {
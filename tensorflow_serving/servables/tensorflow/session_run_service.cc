@@ -0,0 +1,46 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/servables/tensorflow/session_run_service.h"
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/tracing.h"
+#include "tensorflow_serving/core/servable_handle.h"
+#include "tensorflow_serving/servables/tensorflow/session_run_util.h"
+
+namespace tensorflow {
+namespace serving {
+
+Status TensorflowSessionRunServiceImpl::SessionRun(
+    const RunOptions& run_options, ServerCore* core,
+    const SessionRunRequest& request, SessionRunResponse* response) {
+  TRACELITERAL("TensorflowSessionRunServiceImpl::SessionRun");
+  // Verify Request Metadata and create a ServableRequest
+  if (!request.has_model_spec()) {
+    return tensorflow::Status(tensorflow::error::INVALID_ARGUMENT,
+                              "Missing ModelSpec");
+  }
+
+  ServableHandle<SavedModelBundle> saved_model_bundle;
+  TF_RETURN_IF_ERROR(
+      core->GetServableHandle(request.model_spec(), &saved_model_bundle));
+  return RunSessionRun(run_options, saved_model_bundle->meta_graph_def,
+                       saved_model_bundle.id().version,
+                       saved_model_bundle->session.get(), request, response);
+}
+
+}  // namespace serving
+}  // namespace tensorflow
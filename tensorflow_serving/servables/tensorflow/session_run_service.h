@@ -0,0 +1,42 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SESSION_RUN_SERVICE_H_
+#define TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SESSION_RUN_SERVICE_H_
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow_serving/apis/session_service.pb.h"
+#include "tensorflow_serving/model_servers/server_core.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Utility methods for implementation of
+// tensorflow_serving/apis/session_service.proto.
+class TensorflowSessionRunServiceImpl final {
+ public:
+  // Runs 'request' against the model's session (which batches the call, if
+  // batching is enabled and the feeds and fetches match one of the model's
+  // signatures).
+  static Status SessionRun(const RunOptions& run_options, ServerCore* core,
+                           const SessionRunRequest& request,
+                           SessionRunResponse* response);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SESSION_RUN_SERVICE_H_
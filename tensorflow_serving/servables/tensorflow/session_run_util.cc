@@ -0,0 +1,113 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/servables/tensorflow/session_run_util.h"
+
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/protobuf/named_tensor.pb.h"
+#include "tensorflow_serving/servables/tensorflow/util.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+// Returns an error unless each of the request's feeds is an input, and each of
+// its fetches an output, of a signature of 'meta_graph_def'.
+Status VerifySessionRunRequest(const MetaGraphDef& meta_graph_def,
+                               const SessionRunRequest& request) {
+  if (request.target_size() > 0) {
+    return errors::InvalidArgument("SessionRun does not support target nodes");
+  }
+
+  std::unordered_set<string> input_tensor_names;
+  std::unordered_set<string> output_tensor_names;
+  for (const auto& signature : meta_graph_def.signature_def()) {
+    for (const auto& input : signature.second.inputs()) {
+      input_tensor_names.insert(input.second.name());
+    }
+    for (const auto& output : signature.second.outputs()) {
+      output_tensor_names.insert(output.second.name());
+    }
+  }
+  for (const NamedTensorProto& feed : request.feed()) {
+    if (input_tensor_names.count(feed.name()) == 0) {
+      return errors::InvalidArgument(
+          "feed ", feed.name(), " is not an input of any of the model's "
+          "signatures");
+    }
+  }
+  for (const string& fetch : request.fetch()) {
+    if (output_tensor_names.count(fetch) == 0) {
+      return errors::InvalidArgument(
+          "fetch ", fetch, " is not an output of any of the model's "
+          "signatures");
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status RunSessionRun(const RunOptions& run_options,
+                     const MetaGraphDef& meta_graph_def,
+                     const optional<int64>& servable_version, Session* session,
+                     const SessionRunRequest& request,
+                     SessionRunResponse* response) {
+  TF_RETURN_IF_ERROR(VerifySessionRunRequest(meta_graph_def, request));
+
+  std::vector<std::pair<string, Tensor>> inputs;
+  inputs.reserve(request.feed_size());
+  for (const NamedTensorProto& feed : request.feed()) {
+    Tensor tensor;
+    if (!tensor.FromProto(feed.tensor())) {
+      return errors::InvalidArgument("tensor parsing error: ", feed.name());
+    }
+    inputs.emplace_back(feed.name(), std::move(tensor));
+  }
+  const std::vector<string> output_tensor_names(request.fetch().begin(),
+                                                request.fetch().end());
+
+  MakeModelSpec(request.model_spec().name(), /*signature_name=*/{},
+                servable_version, response->mutable_model_spec());
+
+  std::vector<Tensor> outputs;
+  RunMetadata run_metadata;
+  TF_RETURN_IF_ERROR(session->Run(run_options, inputs, output_tensor_names,
+                                  /*target_node_names=*/{}, &outputs,
+                                  &run_metadata));
+  if (outputs.size() != output_tensor_names.size()) {
+    return errors::Internal("SessionRun internal error: expected ",
+                            output_tensor_names.size(), " outputs, got ",
+                            outputs.size());
+  }
+
+  response->mutable_tensor()->Reserve(outputs.size());
+  for (int i = 0; i < outputs.size(); ++i) {
+    NamedTensorProto* const tensor = response->add_tensor();
+    tensor->set_name(output_tensor_names[i]);
+    outputs[i].AsProtoField(tensor->mutable_tensor());
+  }
+  return Status::OK();
+}
+
+}  // namespace serving
+}  // namespace tensorflow
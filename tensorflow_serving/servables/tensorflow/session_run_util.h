@@ -0,0 +1,46 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SESSION_RUN_UTIL_H_
+#define TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SESSION_RUN_UTIL_H_
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow_serving/apis/session_service.pb.h"
+#include "tensorflow_serving/util/optional.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Implementation of SessionRun: issues a single Session::Run() call with the
+// request's feeds and fetches. The request's RunOptions are ignored in favor of
+// 'run_options'.
+//
+// Only tensors named in the signatures of 'meta_graph_def' may be fed (as
+// signature inputs) or fetched (as signature outputs), and target nodes are
+// rejected, so that clients can't run arbitrary ops of the graph (e.g. ones
+// that read or write files).
+Status RunSessionRun(const RunOptions& run_options,
+                     const MetaGraphDef& meta_graph_def,
+                     const optional<int64>& servable_version, Session* session,
+                     const SessionRunRequest& request,
+                     SessionRunResponse* response);
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SESSION_RUN_UTIL_H_
@@ -0,0 +1,156 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/servables/tensorflow/session_run_util.h"
+
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow_serving/test_util/test_util.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+class SessionRunUtilTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    const string export_dir = test_util::TensorflowTestSrcDirPath(
+        "cc/saved_model/testdata/half_plus_two/00000123");
+    bundle_ = new SavedModelBundle;
+    TF_ASSERT_OK(LoadSavedModel(SessionOptions(), RunOptions(), export_dir,
+                                {kSavedModelTagServe}, bundle_));
+  }
+
+  static void TearDownTestCase() {
+    delete bundle_;
+    bundle_ = nullptr;
+  }
+
+  static SavedModelBundle* bundle_;
+};
+
+SavedModelBundle* SessionRunUtilTest::bundle_ = nullptr;
+
+TEST_F(SessionRunUtilTest, TensorContentFeed) {
+  SessionRunRequest request;
+  request.mutable_model_spec()->set_name("test_model");
+  NamedTensorProto* feed = request.add_feed();
+  feed->set_name("x:0");
+  test::AsTensor<float>({1.0f, 2.0f, 3.0f}, {3})
+      .AsProtoTensorContent(feed->mutable_tensor());
+  request.add_fetch("y:0");
+
+  SessionRunResponse response;
+  TF_ASSERT_OK(RunSessionRun(RunOptions(), bundle_->meta_graph_def, 123,
+                             bundle_->session.get(), request, &response));
+  EXPECT_EQ("test_model", response.model_spec().name());
+  EXPECT_EQ(123, response.model_spec().version().value());
+  EXPECT_FALSE(response.model_spec().has_signature_name());
+  ASSERT_EQ(1, response.tensor_size());
+  EXPECT_EQ("y:0", response.tensor(0).name());
+  Tensor output;
+  ASSERT_TRUE(output.FromProto(response.tensor(0).tensor()));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({2.5f, 3.0f, 3.5f}, {3}), output);
+}
+
+TEST_F(SessionRunUtilTest, RepeatedFieldFeed) {
+  SessionRunRequest request;
+  NamedTensorProto* feed = request.add_feed();
+  feed->set_name("x:0");
+  test::AsTensor<float>({4.0f}, {1}).AsProtoField(feed->mutable_tensor());
+  request.add_fetch("y:0");
+
+  SessionRunResponse response;
+  TF_ASSERT_OK(RunSessionRun(RunOptions(), bundle_->meta_graph_def, {},
+                             bundle_->session.get(), request, &response));
+  EXPECT_FALSE(response.model_spec().has_version());
+  ASSERT_EQ(1, response.tensor_size());
+  Tensor output;
+  ASSERT_TRUE(output.FromProto(response.tensor(0).tensor()));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({4.0f}, {1}), output);
+}
+
+TEST_F(SessionRunUtilTest, BadFeed) {
+  SessionRunRequest request;
+  NamedTensorProto* feed = request.add_feed();
+  feed->set_name("x:0");
+  feed->mutable_tensor()->set_dtype(DT_FLOAT);
+  feed->mutable_tensor()->mutable_tensor_shape()->add_dim()->set_size(2);
+  feed->mutable_tensor()->set_tensor_content("abc");
+  request.add_fetch("y:0");
+
+  SessionRunResponse response;
+  const Status status =
+      RunSessionRun(RunOptions(), bundle_->meta_graph_def, {},
+                    bundle_->session.get(), request, &response);
+  EXPECT_EQ(error::INVALID_ARGUMENT, status.code());
+}
+
+TEST_F(SessionRunUtilTest, UnknownFetch) {
+  SessionRunRequest request;
+  NamedTensorProto* feed = request.add_feed();
+  feed->set_name("x:0");
+  test::AsTensor<float>({4.0f}, {1}).AsProtoField(feed->mutable_tensor());
+  request.add_fetch("no_such_tensor:0");
+
+  SessionRunResponse response;
+  const Status status =
+      RunSessionRun(RunOptions(), bundle_->meta_graph_def, {},
+                    bundle_->session.get(), request, &response);
+  EXPECT_EQ(error::INVALID_ARGUMENT, status.code());
+}
+
+TEST_F(SessionRunUtilTest, NonSignatureFeed) {
+  // A tensor of the graph that is not a signature input
+  SessionRunRequest request;
+  NamedTensorProto* feed = request.add_feed();
+  feed->set_name("a:0");
+  test::AsTensor<float>({4.0f}, {}).AsProtoField(feed->mutable_tensor());
+  request.add_fetch("y:0");
+
+  SessionRunResponse response;
+  const Status status =
+      RunSessionRun(RunOptions(), bundle_->meta_graph_def, {},
+                    bundle_->session.get(), request, &response);
+  EXPECT_EQ(error::INVALID_ARGUMENT, status.code());
+}
+
+TEST_F(SessionRunUtilTest, TargetsRejected) {
+  SessionRunRequest request;
+  NamedTensorProto* feed = request.add_feed();
+  feed->set_name("x:0");
+  test::AsTensor<float>({4.0f}, {1}).AsProtoField(feed->mutable_tensor());
+  request.add_fetch("y:0");
+  request.add_target("save/restore_all");
+
+  SessionRunResponse response;
+  const Status status =
+      RunSessionRun(RunOptions(), bundle_->meta_graph_def, {},
+                    bundle_->session.get(), request, &response);
+  EXPECT_EQ(error::INVALID_ARGUMENT, status.code());
+  EXPECT_THAT(status.error_message(),
+              ::testing::HasSubstr("does not support target nodes"));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,126 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/servables/tensorflow/signature_plan.h"
+
+#include <unordered_map>
+
+#include "tensorflow/cc/saved_model/signature_constants.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+// The live ScopedSignaturePlans, by the MetaGraphDef they were built from.
+struct SignaturePlansRegistry {
+  mutex mu;
+  std::unordered_map<const MetaGraphDef*, const SignaturePlans*> plans
+      GUARDED_BY(mu);
+};
+
+SignaturePlansRegistry* GetSignaturePlansRegistry() {
+  static SignaturePlansRegistry* const registry = new SignaturePlansRegistry;
+  return registry;
+}
+
+Status VerifyPredictSignature(const SignatureDef& signature) {
+  if (signature.method_name() != kPredictMethodName &&
+      signature.method_name() != kClassifyMethodName &&
+      signature.method_name() != kRegressMethodName) {
+    return errors::Internal(strings::StrCat(
+        "Expected prediction signature method_name to be one of {",
+        kPredictMethodName, ", ", kClassifyMethodName, ", ", kRegressMethodName,
+        "}. Was: ", signature.method_name()));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+void BuildSignaturePlan(const SignatureDef& signature, SignaturePlan* plan) {
+  plan->signature = &signature;
+  plan->predict_status = VerifyPredictSignature(signature);
+  plan->inputs.clear();
+  for (const auto& input : signature.inputs()) {
+    plan->inputs[input.first] = &input.second;
+  }
+  plan->outputs.clear();
+  plan->output_aliases.clear();
+  plan->output_tensor_names.clear();
+  for (const auto& output : signature.outputs()) {
+    plan->outputs[output.first] = &output.second;
+    plan->output_aliases.push_back(output.first);
+    plan->output_tensor_names.push_back(output.second.name());
+  }
+}
+
+SignaturePlans::SignaturePlans(const MetaGraphDef& meta_graph_def) {
+  for (const auto& signature : meta_graph_def.signature_def()) {
+    BuildSignaturePlan(signature.second, &plans_[signature.first]);
+  }
+}
+
+const SignaturePlan* SignaturePlans::Find(const string& signature_name) const {
+  const auto it = plans_.find(signature_name);
+  return it == plans_.end() ? nullptr : &it->second;
+}
+
+ScopedSignaturePlans::ScopedSignaturePlans(
+    const MetaGraphDef* const meta_graph_def)
+    : meta_graph_def_(meta_graph_def), plans_(*meta_graph_def) {
+  SignaturePlansRegistry* const registry = GetSignaturePlansRegistry();
+  mutex_lock l(registry->mu);
+  if (!registry->plans.emplace(meta_graph_def_, &plans_).second) {
+    LOG(ERROR) << "MetaGraphDef already has SignaturePlans; not registering "
+                  "another set";
+  }
+}
+
+ScopedSignaturePlans::~ScopedSignaturePlans() {
+  SignaturePlansRegistry* const registry = GetSignaturePlansRegistry();
+  mutex_lock l(registry->mu);
+  const auto it = registry->plans.find(meta_graph_def_);
+  if (it != registry->plans.end() && it->second == &plans_) {
+    registry->plans.erase(it);
+  }
+}
+
+const SignaturePlan* FindSignaturePlan(const MetaGraphDef& meta_graph_def,
+                                       const string& signature_name,
+                                       SignaturePlan* const fallback) {
+  {
+    SignaturePlansRegistry* const registry = GetSignaturePlansRegistry();
+    tf_shared_lock l(registry->mu);
+    const auto it = registry->plans.find(&meta_graph_def);
+    if (it != registry->plans.end()) {
+      return it->second->Find(signature_name);
+    }
+  }
+  const auto it = meta_graph_def.signature_def().find(signature_name);
+  if (it == meta_graph_def.signature_def().end()) {
+    return nullptr;
+  }
+  BuildSignaturePlan(it->second, fallback);
+  return fallback;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,97 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SIGNATURE_PLAN_H_
+#define TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SIGNATURE_PLAN_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+
+namespace tensorflow {
+namespace serving {
+
+// The request-independent parts of serving a SignatureDef, worked out once
+// per loaded servable version rather than on every request: validation of
+// the signature's method, resolution of aliases to tensors and the outputs
+// fetched by default.
+struct SignaturePlan {
+  // The signature, inside the MetaGraphDef the plan was built from.
+  const SignatureDef* signature = nullptr;
+
+  // Whether the signature can be used by Predict: OK, or the reason why not.
+  Status predict_status;
+
+  // The TensorInfos of the signature's inputs and outputs, by alias.
+  std::unordered_map<string, const TensorInfo*> inputs;
+  std::unordered_map<string, const TensorInfo*> outputs;
+
+  // All outputs of the signature (the ones fetched when a request does not
+  // filter them), as parallel lists of aliases and tensor names.
+  std::vector<string> output_aliases;
+  std::vector<string> output_tensor_names;
+};
+
+// Builds the plan of 'signature'.
+void BuildSignaturePlan(const SignatureDef& signature, SignaturePlan* plan);
+
+// The SignaturePlans of all signatures of a MetaGraphDef.
+class SignaturePlans {
+ public:
+  explicit SignaturePlans(const MetaGraphDef& meta_graph_def);
+
+  // Returns the plan of the signature 'signature_name', or nullptr if there
+  // is no such signature.
+  const SignaturePlan* Find(const string& signature_name) const;
+
+ private:
+  std::unordered_map<string, SignaturePlan> plans_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SignaturePlans);
+};
+
+// Builds the SignaturePlans of '*meta_graph_def' and registers them for
+// FindSignaturePlan() for as long as it lives. Meant to be owned next to the
+// bundle holding '*meta_graph_def' (e.g. by its loader), and destroyed before
+// the bundle is.
+class ScopedSignaturePlans {
+ public:
+  explicit ScopedSignaturePlans(const MetaGraphDef* meta_graph_def);
+  ~ScopedSignaturePlans();
+
+ private:
+  const MetaGraphDef* const meta_graph_def_;
+  const SignaturePlans plans_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedSignaturePlans);
+};
+
+// Returns the plan of the signature 'signature_name' of 'meta_graph_def', or
+// nullptr if there is no such signature. The plan is the registered one if
+// 'meta_graph_def' has live ScopedSignaturePlans, or else one built into
+// '*fallback' for this call. The result is valid as long as both the bundle
+// and '*fallback' are.
+const SignaturePlan* FindSignaturePlan(const MetaGraphDef& meta_graph_def,
+                                       const string& signature_name,
+                                       SignaturePlan* fallback);
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_SIGNATURE_PLAN_H_
@@ -0,0 +1,108 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/servables/tensorflow/signature_plan.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/cc/saved_model/signature_constants.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::testing::ElementsAre;
+
+MetaGraphDef CreateMetaGraphDef() {
+  MetaGraphDef meta_graph_def;
+  SignatureDef predict_signature;
+  predict_signature.set_method_name(kPredictMethodName);
+  (*predict_signature.mutable_inputs())["x"].set_name("x:0");
+  (*predict_signature.mutable_outputs())["y"].set_name("y:0");
+  (*meta_graph_def.mutable_signature_def())["predict"] = predict_signature;
+
+  SignatureDef other_signature;
+  other_signature.set_method_name("other");
+  (*meta_graph_def.mutable_signature_def())["other"] = other_signature;
+  return meta_graph_def;
+}
+
+TEST(SignaturePlanTest, Build) {
+  const MetaGraphDef meta_graph_def = CreateMetaGraphDef();
+  const SignatureDef& signature = meta_graph_def.signature_def().at("predict");
+  SignaturePlan plan;
+  BuildSignaturePlan(signature, &plan);
+
+  EXPECT_EQ(&signature, plan.signature);
+  TF_EXPECT_OK(plan.predict_status);
+  ASSERT_EQ(1, plan.inputs.count("x"));
+  EXPECT_EQ("x:0", plan.inputs.at("x")->name());
+  ASSERT_EQ(1, plan.outputs.count("y"));
+  EXPECT_EQ("y:0", plan.outputs.at("y")->name());
+  EXPECT_THAT(plan.output_aliases, ElementsAre("y"));
+  EXPECT_THAT(plan.output_tensor_names, ElementsAre("y:0"));
+}
+
+TEST(SignaturePlanTest, NotAPredictSignature) {
+  const MetaGraphDef meta_graph_def = CreateMetaGraphDef();
+  SignaturePlan plan;
+  BuildSignaturePlan(meta_graph_def.signature_def().at("other"), &plan);
+  EXPECT_EQ(error::INTERNAL, plan.predict_status.code());
+}
+
+TEST(SignaturePlansTest, Find) {
+  const MetaGraphDef meta_graph_def = CreateMetaGraphDef();
+  const SignaturePlans plans(meta_graph_def);
+  const SignaturePlan* const plan = plans.Find("predict");
+  ASSERT_NE(nullptr, plan);
+  EXPECT_EQ(&meta_graph_def.signature_def().at("predict"), plan->signature);
+  EXPECT_EQ(nullptr, plans.Find("missing"));
+}
+
+TEST(FindSignaturePlanTest, WithoutRegisteredPlans) {
+  const MetaGraphDef meta_graph_def = CreateMetaGraphDef();
+  SignaturePlan fallback;
+  EXPECT_EQ(&fallback, FindSignaturePlan(meta_graph_def, "predict", &fallback));
+  EXPECT_EQ(&meta_graph_def.signature_def().at("predict"), fallback.signature);
+  EXPECT_EQ(nullptr, FindSignaturePlan(meta_graph_def, "missing", &fallback));
+}
+
+TEST(FindSignaturePlanTest, WithRegisteredPlans) {
+  const MetaGraphDef meta_graph_def = CreateMetaGraphDef();
+  SignaturePlan fallback;
+  {
+    const ScopedSignaturePlans plans(&meta_graph_def);
+    const SignaturePlan* const plan =
+        FindSignaturePlan(meta_graph_def, "predict", &fallback);
+    ASSERT_NE(nullptr, plan);
+    EXPECT_NE(&fallback, plan);
+    EXPECT_EQ(&meta_graph_def.signature_def().at("predict"), plan->signature);
+    EXPECT_EQ(nullptr, FindSignaturePlan(meta_graph_def, "missing", &fallback));
+
+    // The plans are only used with the MetaGraphDef they were built from.
+    const MetaGraphDef other_meta_graph_def = CreateMetaGraphDef();
+    EXPECT_EQ(&fallback,
+              FindSignaturePlan(other_meta_graph_def, "predict", &fallback));
+  }
+
+  // Nor once they are destroyed.
+  EXPECT_EQ(&fallback, FindSignaturePlan(meta_graph_def, "predict", &fallback));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,196 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/servables/tensorflow/tensor_proto_util.h"
+
+#include <memory>
+#include <utility>
+
+#include "google/protobuf/wire_format_lite.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+// An Allocator that hands out a single existing buffer, so that a Tensor can
+// adopt it. Holds a reference to the buffer's owner until the buffer is
+// deallocated, i.e. until the last Tensor sharing it is destroyed, and then
+// deletes itself.
+class AdoptedBufferAllocator : public Allocator {
+ public:
+  AdoptedBufferAllocator(void* const data, const size_t size,
+                         std::shared_ptr<void> owner)
+      : data_(data), size_(size), owner_(std::move(owner)) {}
+
+  string Name() override { return "adopted_buffer"; }
+
+  void* AllocateRaw(const size_t alignment, const size_t num_bytes) override {
+    DCHECK_EQ(size_, num_bytes);
+    return data_;
+  }
+
+  void DeallocateRaw(void* const ptr) override {
+    DCHECK_EQ(data_, ptr);
+    delete this;
+  }
+
+ private:
+  void* const data_;
+  const size_t size_;
+  const std::shared_ptr<void> owner_;
+};
+
+// Returns a Tensor of 'dtype' and 'shape' whose values are the 'size' bytes at
+// 'data', which 'owner' keeps alive. The bytes must be aligned as required by
+// TensorFlow kernels, and be exactly as many as the tensor's values take.
+Tensor AdoptBuffer(const DataType dtype, const TensorShape& shape,
+                   void* const data, const size_t size,
+                   std::shared_ptr<void> owner) {
+  DCHECK(IsAligned(data));
+  return Tensor(new AdoptedBufferAllocator(data, size, std::move(owner)),
+                dtype, shape);
+}
+
+// Returns whether 'data' is aligned as TensorFlow kernels require.
+bool IsAligned(const void* const data) {
+  return reinterpret_cast<intptr_t>(data) % EIGEN_MAX_ALIGN_BYTES == 0;
+}
+
+// Returns an error if 'len' bytes don't hold exactly the values of a tensor of
+// 'dtype' and 'shape'.
+Status CheckContentSize(const DataType dtype, const TensorShape& shape,
+                        const size_t len) {
+  if (len != shape.num_elements() * DataTypeSize(dtype)) {
+    return errors::InvalidArgument(
+        "Unable to parse tensor proto: tensor_content has ", len,
+        " bytes, but shape ", shape.DebugString(), " of type ",
+        DataTypeString(dtype), " needs ",
+        shape.num_elements() * DataTypeSize(dtype));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ParseTensorProto(protobuf::io::CodedInputStream* const input,
+                        const std::shared_ptr<void>& input_owner,
+                        TensorProto* const proto, Tensor* const tensor,
+                        bool* const has_tensor) {
+  using protobuf::internal::WireFormatLite;
+  const uint32 tensor_content_tag =
+      WireFormatLite::MakeTag(TensorProto::kTensorContentFieldNumber,
+                              WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  const Status parse_error =
+      errors::InvalidArgument("Unable to parse tensor proto");
+
+  // The fields other than tensor_content are copied, as is, to
+  // 'other_fields', and parsed from there.
+  string other_fields;
+  // The values of the last tensor_content field, and what keeps them alive.
+  char* content = nullptr;
+  std::shared_ptr<void> content_owner;
+  uint32 content_size = 0;
+  bool has_content = false;
+  {
+    protobuf::io::StringOutputStream other_stream(&other_fields);
+    protobuf::io::CodedOutputStream other_output(&other_stream);
+    for (uint32 tag = input->ReadTag(); tag != 0; tag = input->ReadTag()) {
+      if (tag != tensor_content_tag) {
+        if (!WireFormatLite::SkipField(input, tag, &other_output)) {
+          return parse_error;
+        }
+        continue;
+      }
+      uint32 size;
+      if (!input->ReadVarint32(&size) ||
+          size > static_cast<uint32>(kint32max)) {
+        return parse_error;
+      }
+      // Don't trust 'size' with an allocation before checking that the
+      // message is that long.
+      const int bytes_until_limit = input->BytesUntilLimit();
+      if (bytes_until_limit >= 0 &&
+          size > static_cast<uint32>(bytes_until_limit)) {
+        return parse_error;
+      }
+      // As when parsing, the last occurrence of the field wins.
+      const void* direct_data;
+      int direct_size;
+      if (input_owner != nullptr && size > 0 &&
+          input->GetDirectBufferPointer(&direct_data, &direct_size) &&
+          static_cast<uint32>(direct_size) >= size && IsAligned(direct_data)) {
+        content = static_cast<char*>(const_cast<void*>(direct_data));
+        content_owner = input_owner;
+        if (!input->Skip(size)) {
+          return parse_error;
+        }
+      } else {
+        content = size == 0 ? nullptr
+                            : static_cast<char*>(port::AlignedMalloc(
+                                  size, Allocator::kAllocatorAlignment));
+        content_owner.reset(content, port::AlignedFree);
+        if (size > 0 && !input->ReadRaw(content, size)) {
+          return parse_error;
+        }
+      }
+      content_size = size;
+      has_content = true;
+    }
+  }
+  if (!input->ConsumedEntireMessage() ||
+      !proto->ParseFromString(other_fields)) {
+    return parse_error;
+  }
+
+  *has_tensor = false;
+  if (!has_content) {
+    return Status::OK();
+  }
+  const DataType dtype = proto->dtype();
+  if (content_size == 0 || !DataTypeCanUseMemcpy(dtype) ||
+      !TensorShape::IsValid(proto->tensor_shape())) {
+    // Not a plain buffer of values (e.g. encoded strings); leave it to
+    // Tensor::FromProto().
+    if (content_size > 0) {
+      proto->set_tensor_content(content, content_size);
+    }
+    return Status::OK();
+  }
+  const TensorShape shape(proto->tensor_shape());
+  TF_RETURN_IF_ERROR(CheckContentSize(dtype, shape, content_size));
+  *tensor = AdoptBuffer(dtype, shape, content, content_size,
+                        std::move(content_owner));
+  *has_tensor = true;
+  return Status::OK();
+}
+
+void TensorToProto(const Tensor& tensor, const bool use_tensor_content,
+                   TensorProto* proto) {
+  if (use_tensor_content && DataTypeCanUseMemcpy(tensor.dtype())) {
+    tensor.AsProtoTensorContent(proto);
+  } else {
+    tensor.AsProtoField(proto);
+  }
+}
+
+}  // namespace serving
+}  // namespace tensorflow
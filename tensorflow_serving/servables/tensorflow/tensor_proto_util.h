@@ -0,0 +1,57 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_TENSOR_PROTO_UTIL_H_
+#define TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_TENSOR_PROTO_UTIL_H_
+
+#include <memory>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Parses a serialized TensorProto from 'input', up to its current limit (or
+// end). Unlike parsing a TensorProto and converting it with
+// Tensor::FromProto(), which copies tensor_content twice (into a string, and
+// then into the tensor's buffer), a tensor_content field of a fixed-size type
+// is read straight from 'input' into a newly allocated, aligned buffer: then
+// '*tensor' is set to a Tensor owning that buffer, '*has_tensor' to true, and
+// '*proto' gets all other fields. Otherwise '*has_tensor' is set to false, and
+// '*proto' gets all fields.
+//
+// If 'input_owner' is non-null, it must keep the buffers underlying 'input'
+// alive, and no one else may modify them. Then a tensor_content field that
+// lies within one of those buffers, aligned as TensorFlow kernels require, is
+// not copied at all: '*tensor' refers to it in place, and holds a reference to
+// 'input_owner'. (Note that kernels may overwrite the values of a fed tensor.)
+Status ParseTensorProto(protobuf::io::CodedInputStream* input,
+                        const std::shared_ptr<void>& input_owner,
+                        TensorProto* proto, Tensor* tensor, bool* has_tensor);
+
+// Writes 'tensor' to 'proto'. If 'use_tensor_content' is true and the tensor's
+// type is fixed-size, uses Tensor::AsProtoTensorContent(), i.e. a single
+// packed bytes field; otherwise uses Tensor::AsProtoField(), i.e. the typed
+// repeated fields.
+void TensorToProto(const Tensor& tensor, bool use_tensor_content,
+                   TensorProto* proto);
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_TENSOR_PROTO_UTIL_H_
@@ -0,0 +1,174 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/servables/tensorflow/tensor_proto_util.h"
+
+#include <cstring>
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/mem.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+TEST(TensorToProtoTest, TensorContent) {
+  const Tensor tensor = test::AsTensor<float>({1, 2, 3}, {3});
+  TensorProto proto;
+  TensorToProto(tensor, true /* use_tensor_content */, &proto);
+  EXPECT_EQ(3 * sizeof(float), proto.tensor_content().size());
+  EXPECT_EQ(0, proto.float_val_size());
+
+  Tensor parsed;
+  ASSERT_TRUE(parsed.FromProto(proto));
+  test::ExpectTensorEqual<float>(tensor, parsed);
+}
+
+TEST(TensorToProtoTest, RepeatedField) {
+  const Tensor tensor = test::AsTensor<float>({1, 2, 3}, {3});
+  TensorProto proto;
+  TensorToProto(tensor, false /* use_tensor_content */, &proto);
+  EXPECT_TRUE(proto.tensor_content().empty());
+  EXPECT_EQ(3, proto.float_val_size());
+}
+
+TEST(TensorToProtoTest, StringsUseRepeatedField) {
+  const Tensor tensor = test::AsTensor<string>({"a", "bc"}, {2});
+  TensorProto proto;
+  TensorToProto(tensor, true /* use_tensor_content */, &proto);
+  EXPECT_TRUE(proto.tensor_content().empty());
+  EXPECT_EQ(2, proto.string_val_size());
+}
+
+// Parses 'proto', serialized, with ParseTensorProto().
+Status ParseSerializedTensorProto(const TensorProto& proto,
+                                  TensorProto* parsed_proto, Tensor* tensor,
+                                  bool* has_tensor) {
+  const string serialized = proto.SerializeAsString();
+  protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  return ParseTensorProto(&input, /*input_owner=*/nullptr, parsed_proto, tensor,
+                          has_tensor);
+}
+
+TEST(ParseTensorProtoTest, TensorContent) {
+  const Tensor expected = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {2, 3});
+  TensorProto proto;
+  expected.AsProtoTensorContent(&proto);
+
+  TensorProto parsed_proto;
+  Tensor tensor;
+  bool has_tensor;
+  TF_ASSERT_OK(
+      ParseSerializedTensorProto(proto, &parsed_proto, &tensor, &has_tensor));
+  ASSERT_TRUE(has_tensor);
+  test::ExpectTensorEqual<float>(expected, tensor);
+  EXPECT_EQ(0, reinterpret_cast<intptr_t>(tensor.tensor_data().data()) %
+                   Allocator::kAllocatorAlignment);
+  // The other fields are kept in the proto.
+  EXPECT_EQ(DT_FLOAT, parsed_proto.dtype());
+  EXPECT_EQ(2, parsed_proto.tensor_shape().dim_size());
+  EXPECT_TRUE(parsed_proto.tensor_content().empty());
+}
+
+TEST(ParseTensorProtoTest, AliasesOwnedInput) {
+  const Tensor expected = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {2, 3});
+  TensorProto proto;
+  expected.AsProtoTensorContent(&proto);
+  const string serialized = proto.SerializeAsString();
+  const size_t content_size = proto.tensor_content().size();
+
+  // Place the serialized proto so that tensor_content, its last field, is
+  // aligned.
+  const size_t alignment = Allocator::kAllocatorAlignment;
+  const size_t content_offset = serialized.size() - content_size;
+  const size_t padding = (alignment - content_offset % alignment) % alignment;
+  std::shared_ptr<void> input_owner(
+      port::AlignedMalloc(padding + serialized.size(), alignment),
+      port::AlignedFree);
+  char* const serialized_data = static_cast<char*>(input_owner.get()) + padding;
+  memcpy(serialized_data, serialized.data(), serialized.size());
+
+  TensorProto parsed_proto;
+  Tensor tensor;
+  bool has_tensor;
+  {
+    protobuf::io::CodedInputStream input(
+        reinterpret_cast<const uint8*>(serialized_data), serialized.size());
+    TF_ASSERT_OK(ParseTensorProto(&input, input_owner, &parsed_proto, &tensor,
+                                  &has_tensor));
+  }
+  ASSERT_TRUE(has_tensor);
+  test::ExpectTensorEqual<float>(expected, tensor);
+  EXPECT_EQ(serialized_data + content_offset, tensor.tensor_data().data());
+  EXPECT_EQ(2, input_owner.use_count());
+
+  // The tensor keeps the input alive.
+  input_owner.reset();
+  test::ExpectTensorEqual<float>(expected, tensor);
+}
+
+TEST(ParseTensorProtoTest, RepeatedField) {
+  const Tensor expected = test::AsTensor<float>({1, 2, 3}, {3});
+  TensorProto proto;
+  expected.AsProtoField(&proto);
+
+  TensorProto parsed_proto;
+  Tensor tensor;
+  bool has_tensor;
+  TF_ASSERT_OK(
+      ParseSerializedTensorProto(proto, &parsed_proto, &tensor, &has_tensor));
+  EXPECT_FALSE(has_tensor);
+  EXPECT_EQ(proto.DebugString(), parsed_proto.DebugString());
+}
+
+TEST(ParseTensorProtoTest, MismatchedContentSize) {
+  TensorProto proto;
+  proto.set_dtype(DT_FLOAT);
+  proto.mutable_tensor_shape()->add_dim()->set_size(3);
+  proto.set_tensor_content(string(2 * sizeof(float), '\0'));
+
+  TensorProto parsed_proto;
+  Tensor tensor;
+  bool has_tensor;
+  const Status status =
+      ParseSerializedTensorProto(proto, &parsed_proto, &tensor, &has_tensor);
+  EXPECT_EQ(error::INVALID_ARGUMENT, status.code());
+}
+
+TEST(ParseTensorProtoTest, TruncatedInput) {
+  TensorProto proto;
+  test::AsTensor<float>({1, 2, 3}, {3}).AsProtoTensorContent(&proto);
+  const string serialized = proto.SerializeAsString();
+  protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(serialized.data()),
+      serialized.size() - 1);
+
+  TensorProto parsed_proto;
+  Tensor tensor;
+  bool has_tensor;
+  EXPECT_FALSE(ParseTensorProto(&input, /*input_owner=*/nullptr, &parsed_proto,
+                                &tensor, &has_tensor)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow_serving/servables/tensorflow/util.h"
 
+#include <string.h>
+
 #include "google/protobuf/wrappers.pb.h"
 #include "tensorflow/cc/saved_model/signature_constants.h"
 #include "tensorflow/core/example/example.pb.h"
@@ -25,7 +27,6 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow_serving/apis/input.pb.h"
-#include "tensorflow_serving/apis/internal/serialized_input.pb.h"
 #include "tensorflow_serving/apis/model.pb.h"
 #include "tensorflow_serving/util/optional.h"
 
@@ -45,7 +46,7 @@ auto* example_count_total = monitoring::Counter<1>::New(
     "The total number of tensorflow.Examples.", "model");
 
 // Returns the number of examples in the Input.
-int NumInputExamples(const internal::SerializedInput& input) {
+int NumInputExamples(const Input& input) {
   switch (input.kind_case()) {
     case Input::KindCase::kExampleList:
       return input.example_list().examples_size();
@@ -57,6 +58,19 @@ int NumInputExamples(const internal::SerializedInput& input) {
   return 0;
 }
 
+// Sets '*serialized' to 'context' followed by the serialization of 'example',
+// which parses as 'example' merged into the context. Sizes '*serialized' once,
+// and serializes 'example' in place.
+void SerializeExample(const string& context, const Example& example,
+                      string* serialized) {
+  const size_t example_size = example.ByteSizeLong();
+  serialized->resize(context.size() + example_size);
+  char* const data = &(*serialized)[0];
+  memcpy(data, context.data(), context.size());
+  example.SerializeWithCachedSizesToArray(
+      reinterpret_cast<uint8*>(data + context.size()));
+}
+
 }  // namespace
 
 namespace internal {
@@ -73,45 +87,42 @@ void RecordRequestExampleCount(const string& model_name, size_t count) {
 }
 
 Status InputToSerializedExampleTensor(const Input& input, Tensor* examples) {
-  const string serialized_input_str = input.SerializeAsString();
-  internal::SerializedInput serialized_input;
-  if (!serialized_input.ParseFromString(serialized_input_str)) {
-    return errors::Internal("Error parsing serialized input.");
-  }
-  const int64 num_examples = NumInputExamples(serialized_input);
+  const int64 num_examples = NumInputExamples(input);
   if (num_examples == 0) {
     return errors::InvalidArgument("Input is empty.");
   }
   *examples = Tensor(DT_STRING, TensorShape({num_examples}));
-  switch (serialized_input.kind_case()) {
+  switch (input.kind_case()) {
     case Input::KindCase::KIND_NOT_SET:
       break;
 
     case Input::KindCase::kExampleList: {
       auto input_vec = examples->vec<string>();
       int input_vec_index = 0;
-      for (const auto& entry : serialized_input.example_list().examples()) {
-        input_vec(input_vec_index++) = entry;
+      for (const auto& entry : input.example_list().examples()) {
+        SerializeExample(/*context=*/"", entry, &input_vec(input_vec_index++));
       }
       break;
     }
 
     case Input::KindCase::kExampleListWithContext: {
-      const string& context =
-          serialized_input.example_list_with_context().context();
+      // Avoid the need for repeated serialization of context by serializing
+      // it once, and prepending it to the serialization of each Example.
+      string context;
+      if (input.example_list_with_context().has_context()) {
+        input.example_list_with_context().context().SerializeToString(
+            &context);
+      }
       auto input_vec = examples->vec<string>();
       int input_vec_index = 0;
-      for (const auto& entry :
-           serialized_input.example_list_with_context().examples()) {
-        // Avoid the need for repeated serialization of context by simply
-        // appending the Example serialization to the pre-serialized context.
-        input_vec(input_vec_index++) = strings::StrCat(context, entry);
+      for (const auto& entry : input.example_list_with_context().examples()) {
+        SerializeExample(context, entry, &input_vec(input_vec_index++));
       }
     } break;
 
     default:
-      return errors::Unimplemented(
-          "Input with kind ", serialized_input.kind_case(), " not supported.");
+      return errors::Unimplemented("Input with kind ", input.kind_case(),
+                                   " not supported.");
   }
   return Status::OK();
 }
@@ -182,6 +182,21 @@ TEST_F(InputUtilTest, ExampleListWithContext_NoContext) {
   }
 }
 
+TEST_F(InputUtilTest, ExampleListWithContext_SerializedContextPrepended) {
+  auto* examples =
+      input_.mutable_example_list_with_context()->mutable_examples();
+  *examples->Add() = example_A();
+  *examples->Add() = example_B();
+  *input_.mutable_example_list_with_context()->mutable_context() = example_C();
+
+  TF_ASSERT_OK(InputToSerializedExampleTensor(input_, &tensor_));
+  const auto vec = tensor_.flat<string>();
+  ASSERT_EQ(vec.size(), 2);
+  const string context = example_C().SerializeAsString();
+  EXPECT_EQ(context + example_A().SerializeAsString(), vec(0));
+  EXPECT_EQ(context + example_B().SerializeAsString(), vec(1));
+}
+
 TEST_F(InputUtilTest, ExampleListWithContext_OnlyContext) {
   // Ensure that if there are no examples there is no output (even if the
   // context is specified).
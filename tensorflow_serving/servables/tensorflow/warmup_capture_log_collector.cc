@@ -0,0 +1,304 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/servables/tensorflow/warmup_capture_log_collector.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow_serving/apis/input.pb.h"
+#include "tensorflow_serving/servables/tensorflow/saved_model_warmup.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+// Interval at which the warmup capture collector writes its warmup file.
+constexpr int64 kWarmupCaptureWriteIntervalMicros = 60 * 1000 * 1000;
+
+// The number of request shapes the warmup capture collector keeps track of.
+constexpr int kMaxNumCapturedShapes = 10 * WarmupConsts::kMaxNumRecords;
+
+int NumExamples(const Input& input) {
+  switch (input.kind_case()) {
+    case Input::kExampleList:
+      return input.example_list().examples_size();
+    case Input::kExampleListWithContext:
+      return input.example_list_with_context().examples_size();
+    default:
+      return 0;
+  }
+}
+
+string TensorShapeKey(const TensorProto& tensor) {
+  std::vector<int64> dims;
+  for (const auto& dim : tensor.tensor_shape().dim()) {
+    dims.push_back(dim.size());
+  }
+  return strings::StrCat("[", str_util::Join(dims, ","), "]");
+}
+
+// Copies 'record' into 'copy', except for its response, as warmup only
+// replays requests.
+void CopyWithoutResponse(const PredictionLog& record, PredictionLog* copy) {
+  copy->Clear();
+  switch (record.log_type_case()) {
+    case PredictionLog::kClassifyLog:
+      *copy->mutable_classify_log()->mutable_request() =
+          record.classify_log().request();
+      break;
+    case PredictionLog::kRegressLog:
+      *copy->mutable_regress_log()->mutable_request() =
+          record.regress_log().request();
+      break;
+    case PredictionLog::kPredictLog:
+      *copy->mutable_predict_log()->mutable_request() =
+          record.predict_log().request();
+      break;
+    case PredictionLog::kMultiInferenceLog:
+      *copy->mutable_multi_inference_log()->mutable_request() =
+          record.multi_inference_log().request();
+      break;
+    case PredictionLog::kSessionRunLog:
+      *copy->mutable_session_run_log()->mutable_request() =
+          record.session_run_log().request();
+      break;
+    default:
+      *copy = record;
+      return;
+  }
+  if (record.has_log_metadata()) {
+    *copy->mutable_log_metadata() = record.log_metadata();
+  }
+}
+
+auto warmup_capture_factory = [](const LogCollectorConfig& config,
+                                 const uint32 id,
+                                 std::unique_ptr<LogCollector>* log_collector) {
+  if (config.filename_prefix().empty()) {
+    return errors::InvalidArgument(
+        "The warmup_capture log collector requires a filename_prefix");
+  }
+  log_collector->reset(new WarmupCaptureLogCollector(
+      config.filename_prefix(), kWarmupCaptureWriteIntervalMicros));
+  return Status::OK();
+};
+REGISTER_LOG_COLLECTOR(WarmupCaptureLogCollector::kType,
+                       warmup_capture_factory);
+
+}  // namespace
+
+WarmupRecordReservoir::WarmupRecordReservoir(const int capacity,
+                                             const int max_num_shapes)
+    : capacity_(capacity),
+      max_num_shapes_(max_num_shapes),
+      random_(std::random_device()()) {}
+
+void WarmupRecordReservoir::Add(const PredictionLog& record) {
+  const string key = GetShapeKey(record);
+  mutex_lock l(mu_);
+  auto bucket_it = buckets_.find(key);
+  if (bucket_it == buckets_.end()) {
+    if (buckets_.size() >= static_cast<size_t>(max_num_shapes_)) {
+      // Shapes can vary without bound (e.g. with the sequence length), so
+      // stop tracking new ones at some point.
+      return;
+    }
+    bucket_it = buckets_.emplace(key, ShapeBucket()).first;
+  }
+  ShapeBucket& bucket = bucket_it->second;
+  ++bucket.num_seen;
+
+  int64 replace_index = -1;
+  if (num_records_ >= capacity_) {
+    if (bucket.records.empty()) {
+      // A new shape: make room by evicting a record of the most common one.
+      if (buckets_by_size_.empty()) return;
+      const string largest_key = buckets_by_size_.rbegin()->second;
+      std::vector<PredictionLog>* victims = &buckets_.at(largest_key).records;
+      std::swap((*victims)[random_() % victims->size()], victims->back());
+      victims->pop_back();
+      --num_records_;
+      UpdateBucketSize(largest_key, victims->size() + 1, victims->size());
+    } else {
+      // A known shape: keep each of the records seen of it with equal
+      // probability.
+      const uint64 index = random_() % bucket.num_seen;
+      if (index >= bucket.records.size()) return;
+      replace_index = index;
+    }
+  }
+
+  if (replace_index >= 0) {
+    CopyWithoutResponse(record, &bucket.records[replace_index]);
+  } else {
+    bucket.records.emplace_back();
+    CopyWithoutResponse(record, &bucket.records.back());
+    ++num_records_;
+    UpdateBucketSize(key, bucket.records.size() - 1, bucket.records.size());
+  }
+  ++num_admitted_;
+}
+
+void WarmupRecordReservoir::UpdateBucketSize(const string& key,
+                                             const size_t old_size,
+                                             const size_t new_size) {
+  if (old_size > 0) {
+    buckets_by_size_.erase({old_size, key});
+  }
+  if (new_size > 0) {
+    buckets_by_size_.insert({new_size, key});
+  }
+}
+
+std::vector<PredictionLog> WarmupRecordReservoir::GetRecords() const {
+  mutex_lock l(mu_);
+  std::vector<PredictionLog> records;
+  records.reserve(num_records_);
+  for (const auto& bucket : buckets_) {
+    records.insert(records.end(), bucket.second.records.begin(),
+                   bucket.second.records.end());
+  }
+  return records;
+}
+
+int64 WarmupRecordReservoir::TakeNumAdmitted() {
+  mutex_lock l(mu_);
+  const int64 num_admitted = num_admitted_;
+  num_admitted_ = 0;
+  return num_admitted;
+}
+
+string WarmupRecordReservoir::GetShapeKey(const PredictionLog& record) {
+  switch (record.log_type_case()) {
+    case PredictionLog::kClassifyLog: {
+      const ClassificationRequest& request = record.classify_log().request();
+      return strings::StrCat("classify/", request.model_spec().signature_name(),
+                             "/", request.input().kind_case(), "/",
+                             NumExamples(request.input()));
+    }
+    case PredictionLog::kRegressLog: {
+      const RegressionRequest& request = record.regress_log().request();
+      return strings::StrCat("regress/", request.model_spec().signature_name(),
+                             "/", request.input().kind_case(), "/",
+                             NumExamples(request.input()));
+    }
+    case PredictionLog::kPredictLog: {
+      const PredictRequest& request = record.predict_log().request();
+      // Map iteration order is unspecified, so sort the inputs by name.
+      std::vector<string> inputs;
+      for (const auto& input : request.inputs()) {
+        inputs.push_back(
+            strings::StrCat(input.first, TensorShapeKey(input.second)));
+      }
+      std::sort(inputs.begin(), inputs.end());
+      return strings::StrCat("predict/", request.model_spec().signature_name(),
+                             "/", str_util::Join(inputs, ";"));
+    }
+    case PredictionLog::kMultiInferenceLog: {
+      const MultiInferenceRequest& request =
+          record.multi_inference_log().request();
+      std::vector<string> signatures;
+      for (const auto& task : request.tasks()) {
+        signatures.push_back(task.model_spec().signature_name());
+      }
+      return strings::StrCat("multi_inference/",
+                             str_util::Join(signatures, ","), "/",
+                             request.input().kind_case(), "/",
+                             NumExamples(request.input()));
+    }
+    default:
+      return strings::StrCat("log_type/", record.log_type_case());
+  }
+}
+
+Status WriteWarmupRecords(const std::vector<PredictionLog>& records,
+                          const string& path) {
+  Env* const env = Env::Default();
+  const string temp_path = strings::StrCat(path, ".tmp");
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(temp_path, &file));
+    io::RecordWriter writer(file.get());
+    for (const PredictionLog& record : records) {
+      TF_RETURN_IF_ERROR(writer.WriteRecord(record.SerializeAsString()));
+    }
+    TF_RETURN_IF_ERROR(writer.Flush());
+    TF_RETURN_IF_ERROR(file->Close());
+  }
+  return env->RenameFile(temp_path, path);
+}
+
+constexpr char WarmupCaptureLogCollector::kType[];
+
+WarmupCaptureLogCollector::WarmupCaptureLogCollector(
+    const string& path, const int64 write_interval_micros)
+    : path_(path),
+      reservoir_(WarmupConsts::kMaxNumRecords, kMaxNumCapturedShapes) {
+  if (write_interval_micros > 0) {
+    PeriodicFunction::Options options;
+    options.thread_name_prefix = "warmup_capture";
+    write_thread_.reset(new PeriodicFunction(
+        [this] {
+          if (reservoir_.TakeNumAdmitted() == 0) return;
+          const Status status = Flush();
+          if (!status.ok()) {
+            LOG(ERROR) << "Failed to write captured warmup requests to "
+                       << path_ << ": " << status;
+          }
+        },
+        write_interval_micros, options));
+  }
+}
+
+WarmupCaptureLogCollector::~WarmupCaptureLogCollector() {
+  // Stop the periodic writes before the final one.
+  write_thread_.reset();
+  const Status status = Flush();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to write captured warmup requests to " << path_
+               << ": " << status;
+  }
+}
+
+Status WarmupCaptureLogCollector::CollectMessage(
+    const google::protobuf::Message& message) {
+  if (message.GetDescriptor() != PredictionLog::descriptor()) {
+    return errors::InvalidArgument(
+        "The warmup_capture log collector expects PredictionLogs, got ",
+        message.GetDescriptor()->full_name());
+  }
+  reservoir_.Add(static_cast<const PredictionLog&>(message));
+  return Status::OK();
+}
+
+Status WarmupCaptureLogCollector::Flush() {
+  const std::vector<PredictionLog> records = reservoir_.GetRecords();
+  if (records.empty()) {
+    return Status::OK();
+  }
+  mutex_lock l(write_mu_);
+  return WriteWarmupRecords(records, path_);
+}
+
+}  // namespace serving
+}  // namespace tensorflow
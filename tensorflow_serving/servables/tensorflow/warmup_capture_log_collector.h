@@ -0,0 +1,142 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_WARMUP_CAPTURE_LOG_COLLECTOR_H_
+#define TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_WARMUP_CAPTURE_LOG_COLLECTOR_H_
+
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/message.h"
+#include "tensorflow/core/kernels/batching_util/periodic_function.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow_serving/apis/prediction_log.pb.h"
+#include "tensorflow_serving/core/log_collector.h"
+
+namespace tensorflow {
+namespace serving {
+
+// A bounded sample of PredictionLogs that favors diversity: records whose
+// "shape" (log type, signature, batch size and input shapes) is not yet in the
+// reservoir are always admitted, evicting a random record of the most common
+// shape if the reservoir is full, while records of an already-present shape
+// are reservoir-sampled uniformly among all records seen of that shape. At
+// most 'max_num_shapes' shapes are tracked; records of further shapes are
+// dropped.
+//
+// Thread-safe.
+class WarmupRecordReservoir {
+ public:
+  WarmupRecordReservoir(int capacity, int max_num_shapes);
+
+  // Offers 'record' to the reservoir. Responses are dropped, since warmup only
+  // replays requests.
+  void Add(const PredictionLog& record);
+
+  // Returns the records currently in the reservoir.
+  std::vector<PredictionLog> GetRecords() const;
+
+  // Returns the number of records admitted since the last call, i.e. whether
+  // the reservoir changed.
+  int64 TakeNumAdmitted();
+
+  // Returns a key identifying the shape of the request in 'record'. Exposed
+  // for testing.
+  static string GetShapeKey(const PredictionLog& record);
+
+ private:
+  struct ShapeBucket {
+    // Number of records of this shape offered to the reservoir.
+    int64 num_seen = 0;
+    std::vector<PredictionLog> records;
+  };
+
+  // Keeps 'buckets_by_size_' in sync with a change of the number of records
+  // of the bucket of 'key'.
+  void UpdateBucketSize(const string& key, size_t old_size, size_t new_size)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int capacity_;
+  const int max_num_shapes_;
+
+  mutable mutex mu_;
+  std::map<string, ShapeBucket> buckets_ GUARDED_BY(mu_);
+  // The keys of the non-empty buckets, ordered by their number of records, to
+  // find the most common shape without scanning the buckets.
+  std::set<std::pair<size_t, string>> buckets_by_size_ GUARDED_BY(mu_);
+  int num_records_ GUARDED_BY(mu_) = 0;
+  int64 num_admitted_ GUARDED_BY(mu_) = 0;
+  std::mt19937_64 random_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WarmupRecordReservoir);
+};
+
+// Writes 'records' in the warmup file format (a TFRecord file of
+// PredictionLogs, as read by RunSavedModelWarmup()) to 'path'. The file is
+// written under a temporary name and then renamed, so readers never observe a
+// partial file.
+Status WriteWarmupRecords(const std::vector<PredictionLog>& records,
+                          const string& path);
+
+// A LogCollector, registered under the type "warmup_capture", that captures a
+// sample of the PredictionLogs of live traffic into a WarmupRecordReservoir of
+// WarmupConsts::kMaxNumRecords records, and periodically (and on Flush() and
+// destruction) writes it as a warmup file to the 'filename_prefix' of its
+// LogCollectorConfig. Copying that file to the assets.extra directory of the
+// next version of the model makes its warmup representative of live traffic.
+//
+// Since the ServerRequestLogger shares a collector among models with identical
+// LoggingConfigs, each model should be given its own 'filename_prefix'.
+class WarmupCaptureLogCollector : public LogCollector {
+ public:
+  // The LogCollector type this collector is registered under.
+  static constexpr char kType[] = "warmup_capture";
+
+  // Writes the warmup file every 'write_interval_micros' (if the reservoir
+  // changed), or only on Flush() and destruction if it is 0.
+  WarmupCaptureLogCollector(const string& path, int64 write_interval_micros);
+
+  ~WarmupCaptureLogCollector() override;
+
+  // Expects 'message' to be a PredictionLog.
+  Status CollectMessage(const google::protobuf::Message& message) override;
+
+  // Writes the warmup file.
+  Status Flush() override;
+
+ private:
+  const string path_;
+  WarmupRecordReservoir reservoir_;
+
+  // Serializes writes of the warmup file.
+  mutex write_mu_;
+
+  std::unique_ptr<PeriodicFunction> write_thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WarmupCaptureLogCollector);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_SERVABLES_TENSORFLOW_WARMUP_CAPTURE_LOG_COLLECTOR_H_
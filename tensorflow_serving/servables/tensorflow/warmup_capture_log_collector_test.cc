@@ -0,0 +1,165 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/servables/tensorflow/warmup_capture_log_collector.h"
+
+#include <set>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow_serving/config/log_collector_config.pb.h"
+#include "tensorflow_serving/servables/tensorflow/saved_model_warmup.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+PredictionLog CreatePredictLog(const int64 batch_size) {
+  PredictionLog record;
+  PredictRequest* request = record.mutable_predict_log()->mutable_request();
+  request->mutable_model_spec()->set_signature_name("serving_default");
+  TensorProto& input = (*request->mutable_inputs())["x"];
+  input.set_dtype(DT_FLOAT);
+  input.mutable_tensor_shape()->add_dim()->set_size(batch_size);
+  for (int64 i = 0; i < batch_size; ++i) {
+    input.add_float_val(i);
+  }
+  (*record.mutable_predict_log()->mutable_response()->mutable_outputs())["y"] =
+      input;
+  return record;
+}
+
+int64 GetBatchSize(const PredictionLog& record) {
+  return record.predict_log()
+      .request()
+      .inputs()
+      .at("x")
+      .tensor_shape()
+      .dim(0)
+      .size();
+}
+
+std::vector<PredictionLog> ReadRecords(const string& path) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(path, &file));
+  io::SequentialRecordReader reader(file.get());
+  std::vector<PredictionLog> records;
+  string record;
+  while (reader.ReadRecord(&record).ok()) {
+    records.emplace_back();
+    CHECK(records.back().ParseFromString(record));
+  }
+  return records;
+}
+
+TEST(WarmupRecordReservoirTest, ShapeKey) {
+  EXPECT_EQ(WarmupRecordReservoir::GetShapeKey(CreatePredictLog(2)),
+            WarmupRecordReservoir::GetShapeKey(CreatePredictLog(2)));
+  EXPECT_NE(WarmupRecordReservoir::GetShapeKey(CreatePredictLog(2)),
+            WarmupRecordReservoir::GetShapeKey(CreatePredictLog(3)));
+}
+
+TEST(WarmupRecordReservoirTest, DropsResponses) {
+  WarmupRecordReservoir reservoir(10, 100);
+  reservoir.Add(CreatePredictLog(1));
+  const std::vector<PredictionLog> records = reservoir.GetRecords();
+  ASSERT_EQ(1, records.size());
+  EXPECT_TRUE(records[0].predict_log().has_request());
+  EXPECT_FALSE(records[0].predict_log().has_response());
+  EXPECT_EQ(1, reservoir.TakeNumAdmitted());
+  EXPECT_EQ(0, reservoir.TakeNumAdmitted());
+}
+
+TEST(WarmupRecordReservoirTest, KeepsEveryShape) {
+  constexpr int kCapacity = 10;
+  WarmupRecordReservoir reservoir(kCapacity, 100);
+  // Fill the reservoir with a single shape...
+  for (int i = 0; i < 1000; ++i) {
+    reservoir.Add(CreatePredictLog(1));
+  }
+  EXPECT_EQ(kCapacity, reservoir.GetRecords().size());
+
+  // ... and check that rare shapes still make it in.
+  for (int64 batch_size = 2; batch_size <= 5; ++batch_size) {
+    reservoir.Add(CreatePredictLog(batch_size));
+  }
+  const std::vector<PredictionLog> records = reservoir.GetRecords();
+  EXPECT_EQ(kCapacity, records.size());
+  std::set<int64> batch_sizes;
+  for (const PredictionLog& record : records) {
+    batch_sizes.insert(GetBatchSize(record));
+  }
+  EXPECT_THAT(batch_sizes, ::testing::ElementsAre(1, 2, 3, 4, 5));
+}
+
+TEST(WarmupRecordReservoirTest, DropsShapesBeyondLimit) {
+  WarmupRecordReservoir reservoir(10, 2);
+  for (int64 batch_size = 1; batch_size <= 3; ++batch_size) {
+    reservoir.Add(CreatePredictLog(batch_size));
+  }
+  // Known shapes are still admitted.
+  reservoir.Add(CreatePredictLog(1));
+  std::set<int64> batch_sizes;
+  for (const PredictionLog& record : reservoir.GetRecords()) {
+    batch_sizes.insert(GetBatchSize(record));
+  }
+  EXPECT_THAT(batch_sizes, ::testing::ElementsAre(1, 2));
+  EXPECT_EQ(3, reservoir.TakeNumAdmitted());
+}
+
+TEST(WarmupCaptureLogCollectorTest, WritesWarmupFile) {
+  const string path =
+      io::JoinPath(testing::TmpDir(), "WritesWarmupFile",
+                   WarmupConsts::kRequestsFileName);
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(io::Dirname(path)));
+
+  LogCollectorConfig config;
+  config.set_type(WarmupCaptureLogCollector::kType);
+  config.set_filename_prefix(path);
+  std::unique_ptr<LogCollector> log_collector;
+  TF_ASSERT_OK(LogCollector::Create(config, 0, &log_collector));
+  for (int64 batch_size = 1; batch_size <= 3; ++batch_size) {
+    TF_ASSERT_OK(log_collector->CollectMessage(CreatePredictLog(batch_size)));
+  }
+  EXPECT_FALSE(log_collector->CollectMessage(LogCollectorConfig()).ok());
+  TF_ASSERT_OK(log_collector->Flush());
+
+  std::set<int64> batch_sizes;
+  for (const PredictionLog& record : ReadRecords(path)) {
+    batch_sizes.insert(GetBatchSize(record));
+  }
+  EXPECT_THAT(batch_sizes, ::testing::ElementsAre(1, 2, 3));
+}
+
+TEST(WarmupCaptureLogCollectorTest, WritesOnDestruction) {
+  const string path =
+      io::JoinPath(testing::TmpDir(), "WritesOnDestruction",
+                   WarmupConsts::kRequestsFileName);
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(io::Dirname(path)));
+  {
+    WarmupCaptureLogCollector log_collector(path, 0);
+    TF_ASSERT_OK(log_collector.CollectMessage(CreatePredictLog(1)));
+  }
+  EXPECT_EQ(1, ReadRecords(path).size());
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
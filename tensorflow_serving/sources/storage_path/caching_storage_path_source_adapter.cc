@@ -0,0 +1,638 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/sources/storage_path/caching_storage_path_source_adapter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+// Suffixes of the files next to a cached version's directory, holding the
+// version's manifest and its partial copy, respectively.
+constexpr char kManifestSuffix[] = ".manifest";
+constexpr char kTmpSuffix[] = ".tmp";
+
+// Suffix, followed by a counter, of the paths evicted copies are moved to, to
+// be deleted without holding the adapter's lock. Leftovers are discarded at
+// startup.
+constexpr char kEvictedSuffix[] = ".evicted.";
+
+// The default, and the maximum, of the delay before trying again to cache a
+// version that could not be cached.
+constexpr int64 kDefaultUncacheableRetryDelayMicros = 60LL * 1000 * 1000;
+constexpr int64 kMaxUncacheableRetryDelayMicros = 60LL * 60 * 1000 * 1000;
+
+// The size of the chunks files are copied and checksummed in.
+constexpr size_t kChunkBytes = 1 << 20;
+
+string GetManifestPath(const string& cache_path) {
+  return strings::StrCat(cache_path, kManifestSuffix);
+}
+
+// Deletes the directory trees at 'paths', ignoring errors.
+void DeleteTrees(Env* env, const std::vector<string>& paths) {
+  for (const string& path : paths) {
+    int64 undeleted_files, undeleted_dirs;
+    env->DeleteRecursively(path, &undeleted_files, &undeleted_dirs)
+        .IgnoreError();
+  }
+}
+
+// Reads the file at 'path' chunk by chunk, passing each chunk to 'fn'.
+// Returns early, with an error, if 'cancelled' becomes true.
+Status ReadFileInChunks(Env* env, const string& path,
+                        const std::atomic<bool>& cancelled,
+                        const std::function<Status(StringPiece)>& fn) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(path, &file));
+  std::unique_ptr<char[]> scratch(new char[kChunkBytes]);
+  uint64 offset = 0;
+  for (;;) {
+    if (cancelled) {
+      return errors::Cancelled("Reading ", path, " was cancelled");
+    }
+    StringPiece chunk;
+    const Status status =
+        file->Read(offset, kChunkBytes, &chunk, scratch.get());
+    if (!status.ok() && !errors::IsOutOfRange(status)) {
+      return status;
+    }
+    if (!chunk.empty()) {
+      TF_RETURN_IF_ERROR(fn(chunk));
+      offset += chunk.size();
+    }
+    if (errors::IsOutOfRange(status) || chunk.size() < kChunkBytes) {
+      return Status::OK();
+    }
+  }
+}
+
+// Returns the total size of the files in the directory tree at 'path'.
+Status GetTreeSize(Env* env, const string& path, uint64* size_bytes) {
+  std::vector<string> children;
+  TF_RETURN_IF_ERROR(env->GetChildren(path, &children));
+  for (const string& child : children) {
+    const string child_path = io::JoinPath(path, child);
+    if (env->IsDirectory(child_path).ok()) {
+      TF_RETURN_IF_ERROR(GetTreeSize(env, child_path, size_bytes));
+    } else {
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(env->GetFileSize(child_path, &file_size));
+      *size_bytes += file_size;
+    }
+  }
+  return Status::OK();
+}
+
+// Copies the directory tree at 'source_dir' into 'dest_dir' (which must not
+// exist), recording each copied file in 'manifest' with the given prefix.
+Status CopyTree(Env* env, const string& source_dir, const string& dest_dir,
+                const string& relative_prefix,
+                const std::atomic<bool>& cancelled,
+                CachedVersionManifest* manifest) {
+  TF_RETURN_IF_ERROR(env->CreateDir(dest_dir));
+  std::vector<string> children;
+  TF_RETURN_IF_ERROR(env->GetChildren(source_dir, &children));
+  for (const string& child : children) {
+    const string source_path = io::JoinPath(source_dir, child);
+    const string dest_path = io::JoinPath(dest_dir, child);
+    const string relative_path = io::JoinPath(relative_prefix, child);
+    if (env->IsDirectory(source_path).ok()) {
+      TF_RETURN_IF_ERROR(CopyTree(env, source_path, dest_path, relative_path,
+                                  cancelled, manifest));
+      continue;
+    }
+    std::unique_ptr<WritableFile> dest_file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(dest_path, &dest_file));
+    CachedVersionManifest::File* file = manifest->add_files();
+    file->set_relative_path(relative_path);
+    uint32 crc = 0;
+    uint64 size_bytes = 0;
+    TF_RETURN_IF_ERROR(ReadFileInChunks(
+        env, source_path, cancelled, [&](StringPiece chunk) {
+          crc = crc32c::Extend(crc, chunk.data(), chunk.size());
+          size_bytes += chunk.size();
+          return dest_file->Append(chunk);
+        }));
+    TF_RETURN_IF_ERROR(dest_file->Close());
+    file->set_size_bytes(size_bytes);
+    file->set_crc32c(crc);
+  }
+  return Status::OK();
+}
+
+// Checks that the files under 'cache_path' match 'manifest', by re-reading
+// them. Returns the total size of the files in 'size_bytes'.
+Status VerifyCachedFiles(Env* env, const string& cache_path,
+                         const CachedVersionManifest& manifest,
+                         const std::atomic<bool>& cancelled,
+                         uint64* size_bytes) {
+  *size_bytes = 0;
+  for (const CachedVersionManifest::File& file : manifest.files()) {
+    const string path = io::JoinPath(cache_path, file.relative_path());
+    uint32 crc = 0;
+    uint64 file_size = 0;
+    TF_RETURN_IF_ERROR(
+        ReadFileInChunks(env, path, cancelled, [&](StringPiece chunk) {
+          crc = crc32c::Extend(crc, chunk.data(), chunk.size());
+          file_size += chunk.size();
+          return Status::OK();
+        }));
+    if (file_size != file.size_bytes() || crc != file.crc32c()) {
+      return errors::DataLoss("Cached file ", path,
+                              " does not match its manifest");
+    }
+    *size_bytes += file_size;
+  }
+  return Status::OK();
+}
+
+// Writes 'manifest' to 'path', atomically.
+Status WriteManifest(Env* env, const CachedVersionManifest& manifest,
+                     const string& path) {
+  const string tmp_path = strings::StrCat(path, kTmpSuffix);
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, tmp_path, manifest));
+  return env->RenameFile(tmp_path, path);
+}
+
+}  // namespace
+
+Status CachingStoragePathSourceAdapter::Create(
+    const CachingStoragePathSourceAdapterConfig& config,
+    std::unique_ptr<CachingStoragePathSourceAdapter>* result) {
+  if (config.cache_dir().empty()) {
+    return errors::InvalidArgument(
+        "CachingStoragePathSourceAdapterConfig.cache_dir must be set");
+  }
+  if (config.num_copy_threads() < 0) {
+    return errors::InvalidArgument(
+        "CachingStoragePathSourceAdapterConfig.num_copy_threads must not be "
+        "negative");
+  }
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(config.cache_dir()));
+  result->reset(new CachingStoragePathSourceAdapter(config));
+  mutex_lock l((*result)->mu_);
+  return (*result)->ScanCacheDir();
+}
+
+CachingStoragePathSourceAdapter::CachingStoragePathSourceAdapter(
+    const CachingStoragePathSourceAdapterConfig& config)
+    : config_(config),
+      env_(Env::Default()),
+      copy_threads_(new thread::ThreadPool(
+          env_, "caching_storage_path_source_adapter_copy",
+          std::max(1, config.num_copy_threads()))) {}
+
+CachingStoragePathSourceAdapter::~CachingStoragePathSourceAdapter() {
+  Detach();
+  cancelled_ = true;
+  // Waits for the ongoing copies to stop.
+  copy_threads_.reset();
+}
+
+void CachingStoragePathSourceAdapter::SetAspiredVersionsCallback(
+    AspiredVersionsCallback callback) {
+  mutex_lock l(mu_);
+  outgoing_callback_ = callback;
+  for (const auto& servable : servables_) {
+    EmitAspiredVersions(servable.first);
+  }
+}
+
+string CachingStoragePathSourceAdapter::GetCachePath(
+    const ServableId& id) const {
+  return io::JoinPath(config_.cache_dir(), id.name,
+                      strings::StrCat(id.version));
+}
+
+void CachingStoragePathSourceAdapter::SetAspiredVersions(
+    const StringPiece servable_name,
+    std::vector<ServableData<StoragePath>> versions) {
+  mutex_lock l(mu_);
+  const uint64 now = ++aspire_counter_;
+  for (const ServableData<StoragePath>& version : versions) {
+    if (!version.status().ok()) {
+      continue;
+    }
+    auto it = entries_.find(version.id());
+    if (it != entries_.end()) {
+      it->second.last_aspired = now;
+    }
+    MaybeScheduleCaching(version.id(), version.DataOrDie());
+  }
+  const string name = servable_name.ToString();
+  servables_[name].aspired = std::move(versions);
+  EmitAspiredVersions(name);
+}
+
+Status CachingStoragePathSourceAdapter::ScanCacheDir() {
+  std::vector<string> servable_names;
+  TF_RETURN_IF_ERROR(env_->GetChildren(config_.cache_dir(), &servable_names));
+  for (const string& servable_name : servable_names) {
+    const string servable_dir =
+        io::JoinPath(config_.cache_dir(), servable_name);
+    if (!env_->IsDirectory(servable_dir).ok()) {
+      continue;
+    }
+    std::vector<string> children;
+    TF_RETURN_IF_ERROR(env_->GetChildren(servable_dir, &children));
+    for (const string& child : children) {
+      int64 version;
+      if (!str_util::EndsWith(child, kManifestSuffix) ||
+          !strings::safe_strto64(
+              StringPiece(child).substr(
+                  0, child.size() - strlen(kManifestSuffix)),
+              &version)) {
+        continue;
+      }
+      const ServableId id = {servable_name, version};
+      CachedVersionManifest manifest;
+      const Status status =
+          ReadBinaryProto(env_, io::JoinPath(servable_dir, child), &manifest);
+      if (!status.ok()) {
+        LOG(WARNING) << "Discarding cached version " << id
+                     << " with unreadable manifest: " << status;
+        DeleteCachedVersion(id);
+        continue;
+      }
+      Entry entry;
+      entry.state = EntryState::kUnverified;
+      entry.source_path = manifest.source_path();
+      for (const CachedVersionManifest::File& file : manifest.files()) {
+        entry.size_bytes += file.size_bytes();
+      }
+      cache_bytes_ += entry.size_bytes;
+      entries_[id] = entry;
+    }
+    // Remove partial copies, and copies without a manifest.
+    for (const string& child : children) {
+      int64 version;
+      if (str_util::EndsWith(child, kManifestSuffix) ||
+          (strings::safe_strto64(child, &version) &&
+           entries_.count({servable_name, version}) > 0)) {
+        continue;
+      }
+      int64 undeleted_files, undeleted_dirs;
+      env_->DeleteRecursively(io::JoinPath(servable_dir, child),
+                              &undeleted_files, &undeleted_dirs)
+          .IgnoreError();
+    }
+  }
+  LOG(INFO) << "Found " << entries_.size() << " cached servable versions ("
+            << cache_bytes_ << " bytes) in " << config_.cache_dir();
+  return Status::OK();
+}
+
+void CachingStoragePathSourceAdapter::EmitAspiredVersions(
+    const string& servable_name) {
+  ServableState& state = servables_[servable_name];
+  std::map<int64, StoragePath> to_emit;
+  std::vector<ServableData<StoragePath>> versions;
+  bool caching_in_progress = false;
+  for (const ServableData<StoragePath>& version : state.aspired) {
+    if (!version.status().ok()) {
+      versions.push_back(version);
+      continue;
+    }
+    const Entry& entry = entries_.at(version.id());
+    switch (entry.state) {
+      case EntryState::kCached:
+        to_emit[version.id().version] = GetCachePath(version.id());
+        break;
+      case EntryState::kUncacheable:
+        to_emit[version.id().version] = version.DataOrDie();
+        break;
+      case EntryState::kPending:
+      case EntryState::kUnverified:
+        caching_in_progress = true;
+        break;
+    }
+  }
+  if (caching_in_progress) {
+    // Keep emitting what was emitted before, until the new versions are ready.
+    // This doesn't refer to evicted copies, since emitted versions are never
+    // evicted.
+    to_emit.insert(state.emitted.begin(), state.emitted.end());
+  }
+  for (const auto& version : to_emit) {
+    versions.emplace_back(ServableId{servable_name, version.first},
+                          version.second);
+  }
+  state.emitted = std::move(to_emit);
+  if (outgoing_callback_ != nullptr) {
+    outgoing_callback_(servable_name, std::move(versions));
+  }
+}
+
+void CachingStoragePathSourceAdapter::MaybeScheduleCaching(
+    const ServableId& id, const string& source_path) {
+  auto it = entries_.find(id);
+  if (it == entries_.end()) {
+    Entry entry;
+    entry.state = EntryState::kPending;
+    entry.source_path = source_path;
+    entry.last_aspired = aspire_counter_;
+    entries_[id] = entry;
+    ScheduleCaching(id, source_path, /*verify_only=*/false);
+    return;
+  }
+  Entry& entry = it->second;
+  if (entry.source_path == source_path) {
+    if (entry.state == EntryState::kUnverified) {
+      // Found at startup, and copied from the same path: reuse it if it is
+      // intact.
+      entry.state = EntryState::kPending;
+      ScheduleCaching(id, source_path, /*verify_only=*/true);
+    } else if (entry.state == EntryState::kUncacheable &&
+               env_->NowMicros() >= entry.retry_after_micros) {
+      // The failure may have been transient, or room may have been freed since.
+      // Keep emitting the original path until the new attempt is done.
+      LOG(INFO) << "Trying again to cache servable version " << id;
+      entry.state = EntryState::kPending;
+      ScheduleCaching(id, source_path, /*verify_only=*/false);
+    }
+    return;
+  }
+
+  // The version is now aspired from a different path, so its copy (if any) is
+  // stale. Until it is cached again, emit the new path in place of the stale
+  // copy.
+  LOG(INFO) << "Source path of servable version " << id << " changed from "
+            << entry.source_path << " to " << source_path
+            << "; caching it again";
+  const auto servable = servables_.find(id.name);
+  if (servable != servables_.end()) {
+    const auto emitted = servable->second.emitted.find(id.version);
+    if (emitted != servable->second.emitted.end()) {
+      emitted->second = source_path;
+    }
+  }
+  entry.source_path = source_path;
+  if (entry.state == EntryState::kPending) {
+    // The ongoing copy starts over from the new path once it is done.
+    return;
+  }
+  cache_bytes_ -= entry.size_bytes;
+  entry.size_bytes = 0;
+  entry.state = EntryState::kPending;
+  entry.num_failures = 0;
+  // The new copy deletes the stale one first.
+  ScheduleCaching(id, source_path, /*verify_only=*/false);
+}
+
+void CachingStoragePathSourceAdapter::ScheduleCaching(const ServableId& id,
+                                                      const string& source_path,
+                                                      const bool verify_only) {
+  copy_threads_->Schedule([this, id, source_path, verify_only]() {
+    CacheVersion(id, source_path, verify_only);
+  });
+}
+
+bool CachingStoragePathSourceAdapter::MaybeRestartCaching(
+    const ServableId& id, const string& source_path) {
+  Entry& entry = entries_.at(id);
+  if (entry.source_path == source_path) {
+    return false;
+  }
+  cache_bytes_ -= entry.size_bytes;
+  entry.size_bytes = 0;
+  ScheduleCaching(id, entry.source_path, /*verify_only=*/false);
+  return true;
+}
+
+void CachingStoragePathSourceAdapter::CacheVersion(const ServableId& id,
+                                                   const string& source_path,
+                                                   const bool verify_only) {
+  if (cancelled_) {
+    return;
+  }
+  const string cache_path = GetCachePath(id);
+
+  if (verify_only) {
+    CachedVersionManifest manifest;
+    uint64 size_bytes = 0;
+    Status status =
+        ReadBinaryProto(env_, GetManifestPath(cache_path), &manifest);
+    if (status.ok()) {
+      status = VerifyCachedFiles(env_, cache_path, manifest, cancelled_,
+                                 &size_bytes);
+    }
+    if (cancelled_) {
+      return;
+    }
+    mutex_lock l(mu_);
+    if (MaybeRestartCaching(id, source_path)) {
+      return;
+    }
+    Entry& entry = entries_.at(id);
+    if (status.ok()) {
+      cache_bytes_ += size_bytes;
+      cache_bytes_ -= entry.size_bytes;
+      entry.size_bytes = size_bytes;
+      entry.state = EntryState::kCached;
+      EmitAspiredVersions(id.name);
+      return;
+    }
+    LOG(WARNING) << "Discarding cached version " << id
+                 << " that failed verification: " << status;
+    cache_bytes_ -= entry.size_bytes;
+    entry.size_bytes = 0;
+  }
+
+  // The entry is pending, so nothing else refers to its files: discard any
+  // previous copy without holding 'mu_'.
+  DeleteCachedVersion(id);
+
+  // Reserve room for the copy before starting it.
+  uint64 size_bytes = 0;
+  Status status = GetTreeSize(env_, source_path, &size_bytes);
+  std::vector<string> evicted_paths;
+  {
+    mutex_lock l(mu_);
+    if (MaybeRestartCaching(id, source_path)) {
+      return;
+    }
+    Entry& entry = entries_.at(id);
+    if (status.ok() && !MakeRoom(size_bytes, &evicted_paths)) {
+      status = errors::ResourceExhausted(
+          "Version of size ", size_bytes, " bytes does not fit in the cache");
+    }
+    if (status.ok()) {
+      cache_bytes_ += size_bytes;
+      entry.size_bytes = size_bytes;
+    } else {
+      LOG(WARNING) << "Not caching servable version " << id << ": " << status;
+      MarkUncacheable(&entry);
+      EmitAspiredVersions(id.name);
+    }
+  }
+  DeleteTrees(env_, evicted_paths);
+  if (!status.ok()) {
+    return;
+  }
+
+  LOG(INFO) << "Copying servable version " << id << " from " << source_path
+            << " to " << cache_path;
+  // Copy, verify and move the copy into place. The manifest is written last,
+  // so that a copy interrupted at any point is discarded at startup.
+  const string tmp_path = strings::StrCat(cache_path, kTmpSuffix);
+  CachedVersionManifest manifest;
+  manifest.set_source_path(source_path);
+  uint64 copied_bytes = 0;
+  DeleteTrees(env_, {tmp_path});
+  status =
+      env_->RecursivelyCreateDir(io::JoinPath(config_.cache_dir(), id.name));
+  if (status.ok()) {
+    status = CopyTree(env_, source_path, tmp_path, "", cancelled_, &manifest);
+  }
+  if (status.ok()) {
+    status = VerifyCachedFiles(env_, tmp_path, manifest, cancelled_,
+                               &copied_bytes);
+  }
+  if (status.ok()) {
+    status = env_->RenameFile(tmp_path, cache_path);
+  }
+  if (status.ok()) {
+    status = WriteManifest(env_, manifest, GetManifestPath(cache_path));
+  }
+  if (cancelled_) {
+    return;
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to cache servable version " << id << ": "
+                 << status;
+    DeleteTrees(env_, {tmp_path});
+    DeleteCachedVersion(id);
+  }
+
+  mutex_lock l(mu_);
+  if (MaybeRestartCaching(id, source_path)) {
+    return;
+  }
+  Entry& entry = entries_.at(id);
+  cache_bytes_ -= entry.size_bytes;
+  if (status.ok()) {
+    LOG(INFO) << "Cached servable version " << id << " (" << copied_bytes
+              << " bytes)";
+    cache_bytes_ += copied_bytes;
+    entry.size_bytes = copied_bytes;
+    entry.state = EntryState::kCached;
+    entry.num_failures = 0;
+  } else {
+    entry.size_bytes = 0;
+    MarkUncacheable(&entry);
+  }
+  EmitAspiredVersions(id.name);
+}
+
+void CachingStoragePathSourceAdapter::MarkUncacheable(Entry* entry) {
+  entry->state = EntryState::kUncacheable;
+  int64 retry_delay_micros = config_.uncacheable_retry_delay_micros() > 0
+                                 ? config_.uncacheable_retry_delay_micros()
+                                 : kDefaultUncacheableRetryDelayMicros;
+  for (int i = 0; i < entry->num_failures &&
+                  retry_delay_micros < kMaxUncacheableRetryDelayMicros;
+       ++i) {
+    retry_delay_micros *= 2;
+  }
+  retry_delay_micros =
+      std::min(retry_delay_micros, kMaxUncacheableRetryDelayMicros);
+  ++entry->num_failures;
+  entry->retry_after_micros = env_->NowMicros() + retry_delay_micros;
+}
+
+bool CachingStoragePathSourceAdapter::MakeRoom(
+    const uint64 size_bytes, std::vector<string>* evicted_paths) {
+  if (config_.max_cache_bytes() == 0) {
+    return true;
+  }
+  if (size_bytes > config_.max_cache_bytes()) {
+    return false;
+  }
+  // Collect the versions that can be evicted, least recently aspired first.
+  std::vector<std::pair<uint64, ServableId>> candidates;
+  for (const auto& entry : entries_) {
+    const ServableId& id = entry.first;
+    if (entry.second.state != EntryState::kCached &&
+        entry.second.state != EntryState::kUnverified) {
+      continue;
+    }
+    const auto servable = servables_.find(id.name);
+    if (servable != servables_.end()) {
+      const ServableState& state = servable->second;
+      if (state.emitted.count(id.version) > 0 ||
+          std::any_of(state.aspired.begin(), state.aspired.end(),
+                      [&id](const ServableData<StoragePath>& version) {
+                        return version.id() == id;
+                      })) {
+        continue;
+      }
+    }
+    candidates.emplace_back(entry.second.last_aspired, id);
+  }
+  std::sort(candidates.begin(), candidates.end());
+  for (const auto& candidate : candidates) {
+    if (cache_bytes_ + size_bytes <= config_.max_cache_bytes()) {
+      break;
+    }
+    const ServableId& id = candidate.second;
+    LOG(INFO) << "Evicting servable version " << id << " from the cache";
+    const string evicted_path = MoveAsideCachedVersion(id);
+    if (!evicted_path.empty()) {
+      evicted_paths->push_back(evicted_path);
+    }
+    cache_bytes_ -= entries_.at(id).size_bytes;
+    entries_.erase(id);
+  }
+  return cache_bytes_ + size_bytes <= config_.max_cache_bytes();
+}
+
+string CachingStoragePathSourceAdapter::MoveAsideCachedVersion(
+    const ServableId& id) {
+  const string cache_path = GetCachePath(id);
+  // Delete the manifest first, so that a copy left behind is discarded.
+  env_->DeleteFile(GetManifestPath(cache_path)).IgnoreError();
+  const string moved_path =
+      strings::StrCat(cache_path, kEvictedSuffix, ++num_moved_aside_);
+  if (!env_->RenameFile(cache_path, moved_path).ok()) {
+    return "";
+  }
+  return moved_path;
+}
+
+void CachingStoragePathSourceAdapter::DeleteCachedVersion(
+    const ServableId& id) {
+  const string cache_path = GetCachePath(id);
+  // Delete the manifest first, so that a partially deleted copy is discarded.
+  env_->DeleteFile(GetManifestPath(cache_path)).IgnoreError();
+  DeleteTrees(env_, {cache_path});
+}
+
+}  // namespace serving
+}  // namespace tensorflow
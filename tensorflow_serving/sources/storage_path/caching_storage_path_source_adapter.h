@@ -0,0 +1,205 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_SOURCES_STORAGE_PATH_CACHING_STORAGE_PATH_SOURCE_ADAPTER_H_
+#define TENSORFLOW_SERVING_SOURCES_STORAGE_PATH_CACHING_STORAGE_PATH_SOURCE_ADAPTER_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow_serving/core/servable_data.h"
+#include "tensorflow_serving/core/servable_id.h"
+#include "tensorflow_serving/core/source.h"
+#include "tensorflow_serving/core/storage_path.h"
+#include "tensorflow_serving/core/target.h"
+#include "tensorflow_serving/sources/storage_path/caching_storage_path_source_adapter.pb.h"
+
+namespace tensorflow {
+namespace serving {
+
+// A storage-path stage, placed between a storage-path source (such as
+// FileSystemStoragePathSource) and the SourceAdapters that create loaders,
+// that copies each aspired servable version into a local cache directory and
+// emits the local copy's path in place of the original one. Useful when the
+// original paths are on a slow or remote file system, since every load (by
+// every replica, after every restart) then reads local disk instead.
+//
+// Versions are copied in the background as soon as they are aspired, i.e.
+// before the manager decides to load them, and a version is only emitted once
+// its copy is complete and verified. Until then, the versions of the servable
+// that were emitted previously (and are still cached) continue to be emitted,
+// so that e.g. a new version doesn't cause the current one to be unloaded
+// before the new one can be loaded. If a version cannot be cached (e.g. it
+// doesn't fit, or copying fails), its original path is emitted instead, and
+// caching it is tried again, with exponential backoff, when it is re-aspired.
+//
+// Each copy's contents are checksummed, and the checksums are recorded in a
+// manifest next to the copy; a copy found in the cache directory at startup is
+// only reused if it matches its manifest. The cache is bounded in size, with
+// least recently aspired versions evicted first.
+class CachingStoragePathSourceAdapter final : public TargetBase<StoragePath>,
+                                               public Source<StoragePath> {
+ public:
+  static Status Create(
+      const CachingStoragePathSourceAdapterConfig& config,
+      std::unique_ptr<CachingStoragePathSourceAdapter>* result);
+
+  // Cancels ongoing copies, and waits for them to stop.
+  ~CachingStoragePathSourceAdapter() override;
+
+  void SetAspiredVersionsCallback(AspiredVersionsCallback callback) override;
+
+  // Returns the path at which version 'id' is (or would be) cached.
+  string GetCachePath(const ServableId& id) const;
+
+ protected:
+  void SetAspiredVersions(
+      const StringPiece servable_name,
+      std::vector<ServableData<StoragePath>> versions) override;
+
+ private:
+  explicit CachingStoragePathSourceAdapter(
+      const CachingStoragePathSourceAdapterConfig& config);
+
+  // The state of a servable version in the cache.
+  enum class EntryState {
+    // Being copied, or verified, in the background.
+    kPending,
+    // Cached and verified.
+    kCached,
+    // Found in the cache directory at startup, but not verified yet.
+    kUnverified,
+    // Could not be cached; the original path is emitted instead. Caching it is
+    // tried again when it is next aspired after 'retry_after_micros'.
+    kUncacheable,
+  };
+
+  struct Entry {
+    EntryState state;
+    // The path the version is copied from.
+    string source_path;
+    // The size of the cached copy, or of the space reserved for it.
+    uint64 size_bytes = 0;
+    // Incremented each time the version is aspired, to order evictions.
+    uint64 last_aspired = 0;
+    // The number of consecutive failed attempts to cache the version.
+    int num_failures = 0;
+    // If uncacheable, when (per 'env_') caching it may be tried again.
+    uint64 retry_after_micros = 0;
+  };
+
+  // The aspired-versions state of a servable.
+  struct ServableState {
+    // The versions most recently aspired by the upstream source.
+    std::vector<ServableData<StoragePath>> aspired;
+    // The versions most recently emitted downstream, and their paths.
+    std::map<int64, StoragePath> emitted;
+  };
+
+  // Registers the cached versions found in the cache directory as unverified.
+  Status ScanCacheDir() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Computes the versions to emit for 'servable_name' from its aspired and
+  // cached versions, and emits them if the outgoing callback is set.
+  void EmitAspiredVersions(const string& servable_name)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Schedules copying (or, if unverified, verifying) version 'id' from
+  // 'source_path', unless that is already in progress or done. If the version
+  // was cached from a different path, its copy is discarded and replaced.
+  void MaybeScheduleCaching(const ServableId& id, const string& source_path)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Schedules CacheVersion() on 'copy_threads_'.
+  void ScheduleCaching(const ServableId& id, const string& source_path,
+                       bool verify_only);
+
+  // Called when caching version 'id' from 'source_path' is done. If the
+  // version's source path changed in the meantime, releases its reserved
+  // space, schedules caching it from the new path and returns true.
+  bool MaybeRestartCaching(const ServableId& id, const string& source_path)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Verifies or copies version 'id' into the cache. Runs on 'copy_threads_'.
+  void CacheVersion(const ServableId& id, const string& source_path,
+                    bool verify_only);
+
+  // Marks 'entry' uncacheable, and sets when to try caching it again, backing
+  // off exponentially with its number of consecutive failures.
+  void MarkUncacheable(Entry* entry) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Evicts least recently aspired versions that are not currently emitted,
+  // until 'size_bytes' more fit in the cache. Returns false if they don't.
+  // The evicted copies are moved to 'evicted_paths', for the caller to delete
+  // once it releases 'mu_'.
+  bool MakeRoom(uint64 size_bytes, std::vector<string>* evicted_paths)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Removes version 'id' from the cache directory, by deleting its manifest and
+  // renaming its copy, and returns the new path of the copy ("" if there is
+  // none). Unlike DeleteCachedVersion() this is cheap, and the renamed copy
+  // cannot collide with a new copy of the same version.
+  string MoveAsideCachedVersion(const ServableId& id)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Removes version 'id' from the cache directory. Is slow for large versions,
+  // so must only be called without holding 'mu_', by the owner of a pending
+  // entry (or before the adapter is shared).
+  void DeleteCachedVersion(const ServableId& id);
+
+  const CachingStoragePathSourceAdapterConfig config_;
+  Env* const env_;
+
+  // Set by the destructor, to abandon ongoing copies.
+  std::atomic<bool> cancelled_{false};
+
+  mutable mutex mu_;
+
+  AspiredVersionsCallback outgoing_callback_ GUARDED_BY(mu_);
+
+  std::map<ServableId, Entry> entries_ GUARDED_BY(mu_);
+  std::map<string, ServableState> servables_ GUARDED_BY(mu_);
+
+  // The total size of the entries.
+  uint64 cache_bytes_ GUARDED_BY(mu_) = 0;
+
+  // Incremented on each aspired-versions call, for Entry::last_aspired.
+  uint64 aspire_counter_ GUARDED_BY(mu_) = 0;
+
+  // The number of copies moved aside, to name them uniquely.
+  uint64 num_moved_aside_ GUARDED_BY(mu_) = 0;
+
+  // Declared last, so that it is destroyed (which waits for its closures)
+  // before the state the closures access.
+  std::unique_ptr<thread::ThreadPool> copy_threads_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CachingStoragePathSourceAdapter);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_SOURCES_STORAGE_PATH_CACHING_STORAGE_PATH_SOURCE_ADAPTER_H_
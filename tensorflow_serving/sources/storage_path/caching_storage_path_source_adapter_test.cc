@@ -0,0 +1,304 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/sources/storage_path/caching_storage_path_source_adapter.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow_serving/core/servable_data.h"
+#include "tensorflow_serving/core/target.h"
+#include "tensorflow_serving/core/test_util/mock_storage_path_target.h"
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::InSequence;
+using ::testing::InvokeWithoutArgs;
+using ::testing::IsEmpty;
+using ::testing::StrictMock;
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// Creates version 'version' of a servable under 'base_path', standing in for a
+// remote model repository, with a top-level file and a nested one.
+string CreateVersion(const string& base_path, const int64 version,
+                     const string& contents) {
+  const string version_path =
+      io::JoinPath(base_path, strings::StrCat(version));
+  TF_CHECK_OK(
+      Env::Default()->RecursivelyCreateDir(io::JoinPath(version_path, "dir")));
+  TF_CHECK_OK(WriteStringToFile(Env::Default(),
+                                io::JoinPath(version_path, "file"), contents));
+  TF_CHECK_OK(WriteStringToFile(
+      Env::Default(), io::JoinPath(version_path, "dir", "nested"), contents));
+  return version_path;
+}
+
+CachingStoragePathSourceAdapterConfig CreateConfig(const string& name,
+                                                   const uint64 max_bytes) {
+  CachingStoragePathSourceAdapterConfig config;
+  config.set_cache_dir(io::JoinPath(testing::TmpDir(), name));
+  config.set_max_cache_bytes(max_bytes);
+  config.set_num_copy_threads(2);
+  return config;
+}
+
+ServableData<StoragePath> Version(const string& name, const int64 version,
+                                  const string& path) {
+  return ServableData<StoragePath>({name, version}, path);
+}
+
+// Sends 'versions' of 'name' to 'adapter', and waits for it to emit
+// 'first_emitted' and then 'then_emitted'.
+void AspireAndWait(
+    CachingStoragePathSourceAdapter* adapter,
+    test_util::MockStoragePathTarget* target, const string& name,
+    const std::vector<ServableData<StoragePath>>& versions,
+    const std::vector<ServableData<StoragePath>>& first_emitted,
+    const std::vector<ServableData<StoragePath>>& then_emitted) {
+  Notification done;
+  {
+    InSequence seq;
+    EXPECT_CALL(*target, SetAspiredVersions(Eq(name), first_emitted));
+    EXPECT_CALL(*target, SetAspiredVersions(Eq(name), then_emitted))
+        .WillOnce(InvokeWithoutArgs([&done]() { done.Notify(); }));
+  }
+  adapter->GetAspiredVersionsCallback()(name, versions);
+  done.WaitForNotification();
+  ::testing::Mock::VerifyAndClearExpectations(target);
+}
+
+TEST(CachingStoragePathSourceAdapterTest, EmitsCachedCopy) {
+  const string remote_path =
+      io::JoinPath(testing::TmpDir(), "EmitsCachedCopy_remote");
+  const string version_path = CreateVersion(remote_path, 1, "contents");
+
+  std::unique_ptr<CachingStoragePathSourceAdapter> adapter;
+  TF_ASSERT_OK(CachingStoragePathSourceAdapter::Create(
+      CreateConfig("EmitsCachedCopy_cache", 0), &adapter));
+  std::unique_ptr<test_util::MockStoragePathTarget> target(
+      new StrictMock<test_util::MockStoragePathTarget>);
+  ConnectSourceToTarget(adapter.get(), target.get());
+
+  // Nothing is emitted until the copy is complete.
+  const string cache_path = adapter->GetCachePath({"servable", 1});
+  AspireAndWait(adapter.get(), target.get(), "servable",
+                {Version("servable", 1, version_path)}, {},
+                {Version("servable", 1, cache_path)});
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(),
+                                io::JoinPath(cache_path, "file"), &contents));
+  EXPECT_EQ("contents", contents);
+  TF_ASSERT_OK(ReadFileToString(
+      Env::Default(), io::JoinPath(cache_path, "dir", "nested"), &contents));
+  EXPECT_EQ("contents", contents);
+
+  // Errors are passed through.
+  const auto error = ServableData<StoragePath>(
+      {"servable", 2}, errors::Unknown("error"));
+  EXPECT_CALL(*target,
+              SetAspiredVersions(Eq("servable"), ElementsAre(error)));
+  adapter->GetAspiredVersionsCallback()("servable", {error});
+}
+
+TEST(CachingStoragePathSourceAdapterTest, KeepsEmittedVersionsWhileCopying) {
+  const string remote_path =
+      io::JoinPath(testing::TmpDir(), "KeepsEmittedVersions_remote");
+  const string version_path_1 = CreateVersion(remote_path, 1, "one");
+  const string version_path_2 = CreateVersion(remote_path, 2, "two");
+
+  std::unique_ptr<CachingStoragePathSourceAdapter> adapter;
+  TF_ASSERT_OK(CachingStoragePathSourceAdapter::Create(
+      CreateConfig("KeepsEmittedVersions_cache", 0), &adapter));
+  std::unique_ptr<test_util::MockStoragePathTarget> target(
+      new StrictMock<test_util::MockStoragePathTarget>);
+  ConnectSourceToTarget(adapter.get(), target.get());
+
+  const string cache_path_1 = adapter->GetCachePath({"servable", 1});
+  const string cache_path_2 = adapter->GetCachePath({"servable", 2});
+  AspireAndWait(adapter.get(), target.get(), "servable",
+                {Version("servable", 1, version_path_1)}, {},
+                {Version("servable", 1, cache_path_1)});
+  // Version 1 remains aspired until version 2 has been copied.
+  AspireAndWait(adapter.get(), target.get(), "servable",
+                {Version("servable", 2, version_path_2)},
+                {Version("servable", 1, cache_path_1)},
+                {Version("servable", 2, cache_path_2)});
+}
+
+TEST(CachingStoragePathSourceAdapterTest, RecachesChangedSourcePath) {
+  const string remote_path =
+      io::JoinPath(testing::TmpDir(), "RecachesChangedSourcePath_remote");
+  const string old_path =
+      CreateVersion(io::JoinPath(remote_path, "old"), 1, "old");
+  const string new_path =
+      CreateVersion(io::JoinPath(remote_path, "new"), 1, "new");
+
+  std::unique_ptr<CachingStoragePathSourceAdapter> adapter;
+  TF_ASSERT_OK(CachingStoragePathSourceAdapter::Create(
+      CreateConfig("RecachesChangedSourcePath_cache", 0), &adapter));
+  std::unique_ptr<test_util::MockStoragePathTarget> target(
+      new StrictMock<test_util::MockStoragePathTarget>);
+  ConnectSourceToTarget(adapter.get(), target.get());
+
+  const string cache_path = adapter->GetCachePath({"servable", 1});
+  AspireAndWait(adapter.get(), target.get(), "servable",
+                {Version("servable", 1, old_path)}, {},
+                {Version("servable", 1, cache_path)});
+  // The stale copy is replaced, and the new path is emitted in the meantime.
+  AspireAndWait(adapter.get(), target.get(), "servable",
+                {Version("servable", 1, new_path)},
+                {Version("servable", 1, new_path)},
+                {Version("servable", 1, cache_path)});
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(),
+                                io::JoinPath(cache_path, "file"), &contents));
+  EXPECT_EQ("new", contents);
+}
+
+TEST(CachingStoragePathSourceAdapterTest, RetriesUncacheableVersions) {
+  const string remote_path =
+      io::JoinPath(testing::TmpDir(), "RetriesUncacheableVersions_remote");
+  const string version_path = io::JoinPath(remote_path, "1");
+
+  CachingStoragePathSourceAdapterConfig config =
+      CreateConfig("RetriesUncacheableVersions_cache", 0);
+  config.set_uncacheable_retry_delay_micros(1);
+  std::unique_ptr<CachingStoragePathSourceAdapter> adapter;
+  TF_ASSERT_OK(CachingStoragePathSourceAdapter::Create(config, &adapter));
+  std::unique_ptr<test_util::MockStoragePathTarget> target(
+      new StrictMock<test_util::MockStoragePathTarget>);
+  ConnectSourceToTarget(adapter.get(), target.get());
+
+  // The version can't be copied (yet), so its original path is emitted.
+  AspireAndWait(adapter.get(), target.get(), "servable",
+                {Version("servable", 1, version_path)}, {},
+                {Version("servable", 1, version_path)});
+  // Once it can be, it is cached when it is aspired again.
+  CreateVersion(remote_path, 1, "contents");
+  Env::Default()->SleepForMicroseconds(1000);
+  const string cache_path = adapter->GetCachePath({"servable", 1});
+  AspireAndWait(adapter.get(), target.get(), "servable",
+                {Version("servable", 1, version_path)},
+                {Version("servable", 1, version_path)},
+                {Version("servable", 1, cache_path)});
+}
+
+TEST(CachingStoragePathSourceAdapterTest, EvictsUnaspiredVersions) {
+  const string remote_path =
+      io::JoinPath(testing::TmpDir(), "EvictsUnaspiredVersions_remote");
+  // The versions of 'a' and 'b' are 8 bytes each; the version of 'c' is 16.
+  const string a_path =
+      CreateVersion(io::JoinPath(remote_path, "a"), 1, "aaaa");
+  const string b_path =
+      CreateVersion(io::JoinPath(remote_path, "b"), 1, "bbbb");
+  const string c_path =
+      CreateVersion(io::JoinPath(remote_path, "c"), 1, "cccccccc");
+
+  std::unique_ptr<CachingStoragePathSourceAdapter> adapter;
+  TF_ASSERT_OK(CachingStoragePathSourceAdapter::Create(
+      CreateConfig("EvictsUnaspiredVersions_cache", 12), &adapter));
+  std::unique_ptr<test_util::MockStoragePathTarget> target(
+      new StrictMock<test_util::MockStoragePathTarget>);
+  ConnectSourceToTarget(adapter.get(), target.get());
+
+  const string a_cache_path = adapter->GetCachePath({"a", 1});
+  AspireAndWait(adapter.get(), target.get(), "a", {Version("a", 1, a_path)},
+                {}, {Version("a", 1, a_cache_path)});
+
+  // While 'a' is aspired, there is no room for 'b', so it is emitted uncached.
+  AspireAndWait(adapter.get(), target.get(), "b", {Version("b", 1, b_path)},
+                {}, {Version("b", 1, b_path)});
+
+  // Once 'a' is no longer aspired, a new version of 'b' replaces it in the
+  // cache.
+  EXPECT_CALL(*target, SetAspiredVersions(Eq("a"), IsEmpty()));
+  adapter->GetAspiredVersionsCallback()("a", {});
+  AspireAndWait(adapter.get(), target.get(), "b", {Version("b", 2, b_path)},
+                {Version("b", 1, b_path)},
+                {Version("b", 2, adapter->GetCachePath({"b", 2}))});
+  EXPECT_FALSE(Env::Default()->FileExists(a_cache_path).ok());
+
+  // A version larger than the cache is emitted uncached.
+  AspireAndWait(adapter.get(), target.get(), "c", {Version("c", 1, c_path)},
+                {}, {Version("c", 1, c_path)});
+}
+
+TEST(CachingStoragePathSourceAdapterTest, VerifiesCacheAfterRestart) {
+  const string remote_path =
+      io::JoinPath(testing::TmpDir(), "VerifiesCacheAfterRestart_remote");
+  const string version_path = CreateVersion(remote_path, 1, "contents");
+  const auto config = CreateConfig("VerifiesCacheAfterRestart_cache", 0);
+
+  string cache_path;
+  {
+    std::unique_ptr<CachingStoragePathSourceAdapter> adapter;
+    TF_ASSERT_OK(CachingStoragePathSourceAdapter::Create(config, &adapter));
+    std::unique_ptr<test_util::MockStoragePathTarget> target(
+        new StrictMock<test_util::MockStoragePathTarget>);
+    ConnectSourceToTarget(adapter.get(), target.get());
+    cache_path = adapter->GetCachePath({"servable", 1});
+    AspireAndWait(adapter.get(), target.get(), "servable",
+                  {Version("servable", 1, version_path)}, {},
+                  {Version("servable", 1, cache_path)});
+  }
+
+  // Remove the original, so that the version can only be served from the
+  // cache.
+  int64 undeleted_files, undeleted_dirs;
+  TF_ASSERT_OK(Env::Default()->DeleteRecursively(
+      version_path, &undeleted_files, &undeleted_dirs));
+  {
+    std::unique_ptr<CachingStoragePathSourceAdapter> adapter;
+    TF_ASSERT_OK(CachingStoragePathSourceAdapter::Create(config, &adapter));
+    std::unique_ptr<test_util::MockStoragePathTarget> target(
+        new StrictMock<test_util::MockStoragePathTarget>);
+    ConnectSourceToTarget(adapter.get(), target.get());
+    AspireAndWait(adapter.get(), target.get(), "servable",
+                  {Version("servable", 1, version_path)}, {},
+                  {Version("servable", 1, cache_path)});
+  }
+
+  // Corrupt the cached copy. It is discarded, and since it cannot be copied
+  // again, the original path is emitted.
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(),
+                                 io::JoinPath(cache_path, "file"), "corrupt!"));
+  {
+    std::unique_ptr<CachingStoragePathSourceAdapter> adapter;
+    TF_ASSERT_OK(CachingStoragePathSourceAdapter::Create(config, &adapter));
+    std::unique_ptr<test_util::MockStoragePathTarget> target(
+        new StrictMock<test_util::MockStoragePathTarget>);
+    ConnectSourceToTarget(adapter.get(), target.get());
+    AspireAndWait(adapter.get(), target.get(), "servable",
+                  {Version("servable", 1, version_path)}, {},
+                  {Version("servable", 1, version_path)});
+    EXPECT_FALSE(Env::Default()->FileExists(cache_path).ok());
+  }
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -20,10 +20,13 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_statistics.h"
 #include "tensorflow_serving/core/servable_data.h"
 #include "tensorflow_serving/core/servable_id.h"
 
@@ -33,12 +36,32 @@ namespace serving {
 FileSystemStoragePathSource::~FileSystemStoragePathSource() {
   // Note: Deletion of 'fs_polling_thread_' will block until our underlying
   // thread closure stops. Hence, destruction of this object will not proceed
-  // until the thread has terminated.
+  // until the thread has terminated. The same holds for 'fs_watcher_'.
   fs_polling_thread_.reset();
+  fs_watcher_.reset();
 }
 
 namespace {
 
+auto* poll_cycle_latency = monitoring::Sampler<1>::New(
+    {
+        "/tensorflow/serving/file_system_poll_cycle_latency",
+        "Distribution of wall time (in microseconds) for polling the file "
+        "system for servable versions and emitting them, per poll cycle.",
+        "trigger",
+    },  // Scale of 10, power of 1.8 with bucket count 33 (~20 minutes).
+    monitoring::Buckets::Exponential(10, 1.8, 33));
+
+// In watch mode, watched base paths are also polled every this many periodic
+// polls, in case a change went unnoticed (e.g. while the base path was being
+// re-watched) or the poll it triggered failed.
+constexpr int64 kWatchedBasePathPollPeriods = 10;
+
+// A base path whose modification time is this close to the time it was listed
+// may change again within the file system's timestamp granularity, so its
+// children are not cached.
+constexpr int64 kMinChildrenCacheAgeNanos = 2LL * 1000 * 1000 * 1000;
+
 // Converts any deprecated usage in 'config' into equivalent non-deprecated use.
 // TODO(b/30898016): Eliminate this once the deprecated fields are gone.
 FileSystemStoragePathSourceConfig NormalizeConfig(
@@ -77,6 +100,34 @@ std::set<string> GetDeletedServables(
   return deleted_servables;
 }
 
+// Returns a copy of 'new_config' with only the servables that don't appear in
+// 'old_config', or appear with a different base path or version policy.
+// Assumes both configs are normalized.
+FileSystemStoragePathSourceConfig GetNewOrChangedServables(
+    const FileSystemStoragePathSourceConfig& old_config,
+    const FileSystemStoragePathSourceConfig& new_config) {
+  std::map<string, const FileSystemStoragePathSourceConfig::ServableToMonitor*>
+      old_servables;
+  for (const FileSystemStoragePathSourceConfig::ServableToMonitor& servable :
+       old_config.servables()) {
+    old_servables[servable.servable_name()] = &servable;
+  }
+
+  FileSystemStoragePathSourceConfig changed_config = new_config;
+  changed_config.clear_servables();
+  for (const FileSystemStoragePathSourceConfig::ServableToMonitor& servable :
+       new_config.servables()) {
+    auto it = old_servables.find(servable.servable_name());
+    if (it == old_servables.end() ||
+        it->second->base_path() != servable.base_path() ||
+        it->second->servable_version_policy().SerializeAsString() !=
+            servable.servable_version_policy().SerializeAsString()) {
+      *changed_config.add_servables() = servable;
+    }
+  }
+  return changed_config;
+}
+
 // Adds a new ServableData for the servable version to the vector of versions to
 // aspire.
 void AspireVersion(
@@ -210,24 +261,32 @@ bool AspireSpecificVersions(
   return !aspired_versions.empty();
 }
 
-// Like PollFileSystemForConfig(), but for a single servable.
-Status PollFileSystemForServable(
-    const FileSystemStoragePathSourceConfig::ServableToMonitor& servable,
-    std::vector<ServableData<StoragePath>>* versions) {
+// Lists the children of 'base_path'. Returns NotFound if it doesn't exist.
+Status ListChildren(const string& base_path, std::vector<string>* children) {
   // First, determine whether the base path exists. This check guarantees that
   // we don't emit an empty aspired-versions list for a non-existent (or
   // transiently unavailable) base-path. (On some platforms, GetChildren()
   // returns an empty list instead of erring if the base path isn't found.)
-  if (!Env::Default()->FileExists(servable.base_path()).ok()) {
-    return errors::InvalidArgument("Could not find base path ",
-                                   servable.base_path(), " for servable ",
-                                   servable.servable_name());
+  if (!Env::Default()->FileExists(base_path).ok()) {
+    return errors::NotFound("Could not find base path ", base_path);
   }
+  return Env::Default()->GetChildren(base_path, children);
+}
 
+// Like PollFileSystemForConfig(), but for a single servable.
+Status PollFileSystemForServable(
+    const FileSystemStoragePathSourceConfig::ServableToMonitor& servable,
+    const ChildrenLister& list_children,
+    std::vector<ServableData<StoragePath>>* versions) {
   // Retrieve a list of base-path children from the file system.
   std::vector<string> children;
-  TF_RETURN_IF_ERROR(
-      Env::Default()->GetChildren(servable.base_path(), &children));
+  const Status list_status = list_children(servable.base_path(), &children);
+  if (errors::IsNotFound(list_status)) {
+    return errors::InvalidArgument("Could not find base path ",
+                                   servable.base_path(), " for servable ",
+                                   servable.servable_name());
+  }
+  TF_RETURN_IF_ERROR(list_status);
 
   // GetChildren() returns all descendants instead for cloud storage like GCS.
   // In such case we should filter out all non-direct descendants.
@@ -274,28 +333,52 @@ Status PollFileSystemForServable(
 
 // Polls the file system, and populates 'versions_by_servable_name' with the
 // aspired-versions data FileSystemStoragePathSource should emit based on what
-// was found, indexed by servable name.
+// was found, indexed by servable name. Lists base paths using
+// 'list_children'. If 'thread_pool' is non-null, the servables are polled
+// concurrently on it.
 Status PollFileSystemForConfig(
     const FileSystemStoragePathSourceConfig& config,
+    const ChildrenLister& list_children, thread::ThreadPool* thread_pool,
     std::map<string, std::vector<ServableData<StoragePath>>>*
         versions_by_servable_name) {
-  for (const FileSystemStoragePathSourceConfig::ServableToMonitor& servable :
-       config.servables()) {
-    std::vector<ServableData<StoragePath>> versions;
-    TF_RETURN_IF_ERROR(PollFileSystemForServable(servable, &versions));
+  const int num_servables = config.servables_size();
+  std::vector<std::vector<ServableData<StoragePath>>> versions(num_servables);
+  if (thread_pool == nullptr || num_servables <= 1) {
+    for (int i = 0; i < num_servables; ++i) {
+      TF_RETURN_IF_ERROR(PollFileSystemForServable(
+          config.servables(i), list_children, &versions[i]));
+    }
+  } else {
+    std::vector<Status> statuses(num_servables);
+    BlockingCounter num_pending(num_servables);
+    for (int i = 0; i < num_servables; ++i) {
+      thread_pool->Schedule([&, i]() {
+        statuses[i] = PollFileSystemForServable(config.servables(i),
+                                                list_children, &versions[i]);
+        num_pending.DecrementCount();
+      });
+    }
+    num_pending.Wait();
+    // Report the same error as a sequential poll would.
+    for (const Status& status : statuses) {
+      TF_RETURN_IF_ERROR(status);
+    }
+  }
+  for (int i = 0; i < num_servables; ++i) {
     versions_by_servable_name->insert(
-        {servable.servable_name(), std::move(versions)});
+        {config.servables(i).servable_name(), std::move(versions[i])});
   }
   return Status::OK();
 }
 
 // Determines if, for any servables in 'config', the file system doesn't
 // currently contain at least one version under its base path.
-Status FailIfZeroVersions(const FileSystemStoragePathSourceConfig& config) {
+Status FailIfZeroVersions(const FileSystemStoragePathSourceConfig& config,
+                          thread::ThreadPool* thread_pool) {
   std::map<string, std::vector<ServableData<StoragePath>>>
       versions_by_servable_name;
-  TF_RETURN_IF_ERROR(
-      PollFileSystemForConfig(config, &versions_by_servable_name));
+  TF_RETURN_IF_ERROR(PollFileSystemForConfig(
+      config, ListChildren, thread_pool, &versions_by_servable_name));
   for (const auto& entry : versions_by_servable_name) {
     const string& servable = entry.first;
     const std::vector<ServableData<StoragePath>>& versions = entry.second;
@@ -327,20 +410,56 @@ Status FileSystemStoragePathSource::UpdateConfig(
     return errors::InvalidArgument(
         "Changing file_system_poll_wait_seconds is not supported");
   }
+  if (aspired_versions_callback_ &&
+      config.watch_file_system() != config_.watch_file_system()) {
+    return errors::InvalidArgument(
+        "Changing watch_file_system is not supported");
+  }
 
   const FileSystemStoragePathSourceConfig normalized_config =
       NormalizeConfig(config);
 
+  if (normalized_config.num_poll_threads() != config_.num_poll_threads()) {
+    poll_threads_.reset();
+    if (normalized_config.num_poll_threads() > 1) {
+      poll_threads_.reset(new thread::ThreadPool(
+          Env::Default(), "FileSystemStoragePathSource_poll_threads",
+          normalized_config.num_poll_threads()));
+    }
+  }
+
   if (normalized_config.fail_if_zero_versions_at_startup()) {
-    TF_RETURN_IF_ERROR(FailIfZeroVersions(normalized_config));
+    // Servables that are already configured were checked when they were
+    // added, so only new or changed ones are checked, to keep small config
+    // changes cheap.
+    TF_RETURN_IF_ERROR(FailIfZeroVersions(
+        GetNewOrChangedServables(config_, normalized_config),
+        poll_threads_.get()));
   }
 
   if (aspired_versions_callback_) {
     TF_RETURN_IF_ERROR(
         UnaspireServables(GetDeletedServables(config_, normalized_config)));
   }
+  const FileSystemStoragePathSourceConfig old_config = config_;
   config_ = normalized_config;
 
+  // Stop watching, and forget the cached children of, base paths that are no
+  // longer configured.
+  std::set<string> base_paths;
+  for (const auto& servable : config_.servables()) {
+    base_paths.insert(servable.base_path());
+  }
+  for (const auto& servable : old_config.servables()) {
+    if (base_paths.count(servable.base_path()) == 0) {
+      if (fs_watcher_ != nullptr) {
+        fs_watcher_->RemoveWatch(servable.base_path());
+      }
+      mutex_lock children_cache_lock(children_cache_mu_);
+      children_cache_.erase(servable.base_path());
+    }
+  }
+
   return Status::OK();
 }
 
@@ -356,6 +475,28 @@ void FileSystemStoragePathSource::SetAspiredVersionsCallback(
   }
   aspired_versions_callback_ = callback;
 
+  if (config_.watch_file_system()) {
+    const Status status = FileSystemWatcher::Create(
+        [this](const std::set<string>& changed_base_paths,
+               const std::set<string>& base_paths_with_created_children) {
+          this->PollBasePathsInNextPeriodicPoll(
+              base_paths_with_created_children);
+          const Status status =
+              this->PollBasePathsAndInvokeCallback(changed_base_paths);
+          if (!status.ok()) {
+            LOG(ERROR) << "FileSystemStoragePathSource encountered a "
+                          "file-system access error: "
+                       << status.error_message();
+          }
+        },
+        &fs_watcher_);
+    if (!status.ok()) {
+      LOG(WARNING) << "Unable to watch the file system, falling back to "
+                      "polling: "
+                   << status;
+    }
+  }
+
   if (config_.file_system_poll_wait_seconds() >= 0) {
     // Kick off a thread to poll the file system periodically, and call the
     // callback.
@@ -377,10 +518,117 @@ void FileSystemStoragePathSource::SetAspiredVersionsCallback(
 
 Status FileSystemStoragePathSource::PollFileSystemAndInvokeCallback() {
   mutex_lock l(mu_);
+  if (fs_watcher_ == nullptr) {
+    return PollServablesAndInvokeCallback(config_, "periodic");
+  }
+
+  // Watched base paths are polled when they change, so only poll the others,
+  // the ones that become watched now (as changes prior to watching them went
+  // unnoticed) and the ones with pending changes. Every so often, poll all of
+  // them, as a safety net.
+  const bool poll_watched_base_paths =
+      ++num_periodic_polls_ % kWatchedBasePathPollPeriods == 0;
+  std::set<string> pending_base_paths;
+  pending_base_paths.swap(base_paths_to_poll_);
+  FileSystemStoragePathSourceConfig polled_config = config_;
+  polled_config.clear_servables();
+  std::set<string> newly_watched_base_paths;
+  for (const auto& servable : config_.servables()) {
+    const string& base_path = servable.base_path();
+    if (newly_watched_base_paths.count(base_path) == 0) {
+      if (fs_watcher_->IsWatched(base_path)) {
+        if (!poll_watched_base_paths &&
+            pending_base_paths.count(base_path) == 0) {
+          continue;
+        }
+      } else if (FileSystemWatcher::IsWatchablePath(base_path) &&
+                 fs_watcher_->AddWatch(base_path).ok()) {
+        newly_watched_base_paths.insert(base_path);
+      }
+    }
+    *polled_config.add_servables() = servable;
+  }
+  const Status status =
+      PollServablesAndInvokeCallback(polled_config, "periodic");
+  if (!status.ok()) {
+    base_paths_to_poll_.insert(pending_base_paths.begin(),
+                               pending_base_paths.end());
+    base_paths_to_poll_.insert(newly_watched_base_paths.begin(),
+                               newly_watched_base_paths.end());
+  }
+  return status;
+}
+
+Status FileSystemStoragePathSource::PollBasePathsAndInvokeCallback(
+    const std::set<string>& base_paths) {
+  mutex_lock l(mu_);
+  FileSystemStoragePathSourceConfig changed_config = config_;
+  changed_config.clear_servables();
+  for (const auto& servable : config_.servables()) {
+    if (base_paths.count(servable.base_path()) > 0) {
+      *changed_config.add_servables() = servable;
+    }
+  }
+  if (changed_config.servables().empty()) {
+    return Status::OK();
+  }
+  const Status status = PollServablesAndInvokeCallback(changed_config, "watch");
+  if (!status.ok()) {
+    // Retry in the next periodic poll, as the change won't be reported again.
+    base_paths_to_poll_.insert(base_paths.begin(), base_paths.end());
+  }
+  return status;
+}
+
+void FileSystemStoragePathSource::PollBasePathsInNextPeriodicPoll(
+    const std::set<string>& base_paths) {
+  mutex_lock l(mu_);
+  base_paths_to_poll_.insert(base_paths.begin(), base_paths.end());
+}
+
+Status FileSystemStoragePathSource::ListChildrenIncrementally(
+    const string& base_path, std::vector<string>* children) {
+  const int64 now_nanos = Env::Default()->NowMicros() * 1000;
+  FileStatistics stat;
+  if (!Env::Default()->Stat(base_path, &stat).ok()) {
+    mutex_lock l(children_cache_mu_);
+    children_cache_.erase(base_path);
+    return errors::NotFound("Could not find base path ", base_path);
+  }
+  // Adding, removing or renaming a child updates the directory's modification
+  // time. Some file systems (e.g. object stores) don't report one, though.
+  const bool cacheable = stat.mtime_nsec > 0;
+  if (cacheable) {
+    mutex_lock l(children_cache_mu_);
+    auto it = children_cache_.find(base_path);
+    if (it != children_cache_.end() &&
+        it->second.mtime_nsec == stat.mtime_nsec) {
+      *children = it->second.children;
+      return Status::OK();
+    }
+  }
+  TF_RETURN_IF_ERROR(Env::Default()->GetChildren(base_path, children));
+  if (cacheable && stat.mtime_nsec < now_nanos - kMinChildrenCacheAgeNanos) {
+    mutex_lock l(children_cache_mu_);
+    children_cache_[base_path] = {stat.mtime_nsec, *children};
+  }
+  return Status::OK();
+}
+
+Status FileSystemStoragePathSource::PollServablesAndInvokeCallback(
+    const FileSystemStoragePathSourceConfig& config, const string& trigger) {
+  const uint64 start_micros = Env::Default()->NowMicros();
   std::map<string, std::vector<ServableData<StoragePath>>>
       versions_by_servable_name;
-  TF_RETURN_IF_ERROR(
-      PollFileSystemForConfig(config_, &versions_by_servable_name));
+  ChildrenLister list_children = ListChildren;
+  if (config_.skip_unchanged_base_paths()) {
+    list_children = [this](const string& base_path,
+                           std::vector<string>* children) {
+      return ListChildrenIncrementally(base_path, children);
+    };
+  }
+  TF_RETURN_IF_ERROR(PollFileSystemForConfig(
+      config, list_children, poll_threads_.get(), &versions_by_servable_name));
   for (const auto& entry : versions_by_servable_name) {
     const string& servable = entry.first;
     const std::vector<ServableData<StoragePath>>& versions = entry.second;
@@ -394,6 +642,9 @@ Status FileSystemStoragePathSource::PollFileSystemAndInvokeCallback() {
     }
     aspired_versions_callback_(servable, versions);
   }
+  const uint64 end_micros = Env::Default()->NowMicros();
+  poll_cycle_latency->GetCell(trigger)->Add(
+      end_micros > start_micros ? end_micros - start_micros : 0);
   return Status::OK();
 }
 
@@ -16,15 +16,24 @@ limitations under the License.
 #ifndef TENSORFLOW_SERVING_SOURCES_STORAGE_PATH_FILE_SYSTEM_STORAGE_PATH_SOURCE_H_
 #define TENSORFLOW_SERVING_SOURCES_STORAGE_PATH_FILE_SYSTEM_STORAGE_PATH_SOURCE_H_
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow_serving/core/source.h"
 #include "tensorflow_serving/core/storage_path.h"
 #include "tensorflow_serving/sources/storage_path/file_system_storage_path_source.pb.h"
+#include "tensorflow_serving/sources/storage_path/file_system_watcher.h"
 
 namespace tensorflow {
 namespace serving {
@@ -37,6 +46,10 @@ class FileSystemStoragePathSourceTestAccess;
 namespace tensorflow {
 namespace serving {
 
+/// Lists the children of a base path. Returns NotFound if it doesn't exist.
+using ChildrenLister = std::function<Status(const string& base_path,
+                                            std::vector<string>* children)>;
+
 /// A storage path source that aspires versions for a given set of servables.
 /// For each servable, it monitors a given file-system base path. It identifies
 /// base-path children whose name is a number (e.g. 123) and emits the path
@@ -55,6 +68,10 @@ namespace serving {
 /// not in the new one, the source will immediately aspire zero versions for
 /// that servable (causing it to be unloaded in the Manager that ultimately
 /// consumes the aspired-versions calls).
+///
+/// If 'watch_file_system' is set in the config, local base paths are watched
+/// for changes, and polled as soon as versions are moved into or out of them
+/// rather than periodically (though still occasionally).
 class FileSystemStoragePathSource : public Source<StoragePath> {
  public:
   static Status Create(const FileSystemStoragePathSourceConfig& config,
@@ -63,7 +80,7 @@ class FileSystemStoragePathSource : public Source<StoragePath> {
 
   /// Supplies a new config to use. The set of servables to monitor can be
   /// changed at any time (see class comment for more information), but it is
-  /// illegal to change the file-system polling period once
+  /// illegal to change the file-system polling period or watch mode once
   /// SetAspiredVersionsCallback() has been called.
   Status UpdateConfig(const FileSystemStoragePathSourceConfig& config);
 
@@ -84,8 +101,35 @@ class FileSystemStoragePathSource : public Source<StoragePath> {
   // an empty versions list. If one or more such children are found, invokes
   // 'aspired_versions_callback_' with a singleton list containing the largest
   // such child.
+  //
+  // In watch mode, only polls the servables whose base paths aren't watched,
+  // after trying to watch them (and polling those that became watched), or
+  // whose base paths are in 'base_paths_to_poll_'. Every
+  // kWatchedBasePathPollPeriods-th call polls all servables.
   Status PollFileSystemAndInvokeCallback();
 
+  // Polls the servables whose base path is among 'base_paths', and invokes
+  // 'aspired_versions_callback_' for them. Called when the watcher detects
+  // changes. If the poll fails, the base paths are polled again in the next
+  // periodic poll.
+  Status PollBasePathsAndInvokeCallback(const std::set<string>& base_paths);
+
+  // Adds 'base_paths' to 'base_paths_to_poll_'. Called when the watcher detects
+  // children created in place, which may still be being written, so aspiring
+  // them is left to the next periodic poll.
+  void PollBasePathsInNextPeriodicPoll(const std::set<string>& base_paths);
+
+  // Polls the servables in 'config', and invokes 'aspired_versions_callback_'
+  // for each. 'trigger' labels the poll-cycle latency metric.
+  Status PollServablesAndInvokeCallback(
+      const FileSystemStoragePathSourceConfig& config, const string& trigger)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // A ChildrenLister that reuses the children listed in a previous poll if the
+  // base path's modification time hasn't changed since.
+  Status ListChildrenIncrementally(const string& base_path,
+                                   std::vector<string>* children);
+
   // Sends empty aspired-versions lists for each servable in 'servable_names'.
   Status UnaspireServables(const std::set<string>& servable_names)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -99,6 +143,29 @@ class FileSystemStoragePathSource : public Source<StoragePath> {
   // A thread that periodically calls PollFileSystemAndInvokeCallback().
   std::unique_ptr<PeriodicFunction> fs_polling_thread_ GUARDED_BY(mu_);
 
+  // In watch mode, watches the base paths of the servables in 'config_'.
+  std::unique_ptr<FileSystemWatcher> fs_watcher_ GUARDED_BY(mu_);
+
+  // In watch mode, watched base paths to poll in the next periodic poll.
+  std::set<string> base_paths_to_poll_ GUARDED_BY(mu_);
+
+  // In watch mode, the number of periodic polls so far.
+  int64 num_periodic_polls_ GUARDED_BY(mu_) = 0;
+
+  // If 'num_poll_threads' > 1, the threads servables are polled on.
+  std::unique_ptr<thread::ThreadPool> poll_threads_ GUARDED_BY(mu_);
+
+  // The children of base paths, as of their modification time, used if
+  // 'skip_unchanged_base_paths' is set. Accessed concurrently by polls of
+  // different servables.
+  struct CachedChildren {
+    int64 mtime_nsec;
+    std::vector<string> children;
+  };
+  mutable mutex children_cache_mu_;
+  std::map<string, CachedChildren> children_cache_
+      GUARDED_BY(children_cache_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(FileSystemStoragePathSource);
 };
 
@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow_serving/sources/storage_path/file_system_storage_path_source.h"
 
+#include <utime.h>
+
 #include <string>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -36,6 +39,7 @@ limitations under the License.
 using ::testing::AnyOf;
 using ::testing::ElementsAre;
 using ::testing::Eq;
+using ::testing::InvokeWithoutArgs;
 using ::testing::IsEmpty;
 using ::testing::StrictMock;
 
@@ -582,6 +586,167 @@ TEST(FileSystemStoragePathSourceTest, AttemptToChangePollingPeriod) {
   EXPECT_FALSE(source->UpdateConfig(new_config).ok());
 }
 
+TEST(FileSystemStoragePathSourceTest, AttemptToChangeWatchMode) {
+  FileSystemStoragePathSourceConfig config;
+  config.set_file_system_poll_wait_seconds(-1);
+  std::unique_ptr<FileSystemStoragePathSource> source;
+  TF_ASSERT_OK(FileSystemStoragePathSource::Create(config, &source));
+  std::unique_ptr<test_util::MockStoragePathTarget> target(
+      new StrictMock<test_util::MockStoragePathTarget>);
+  ConnectSourceToTarget(source.get(), target.get());
+
+  FileSystemStoragePathSourceConfig new_config = config;
+  new_config.set_watch_file_system(true);
+  EXPECT_FALSE(source->UpdateConfig(new_config).ok());
+}
+
+#if defined(__linux__)
+TEST(FileSystemStoragePathSourceTest, WatchFileSystem) {
+  const string base_path = io::JoinPath(testing::TmpDir(), "WatchFileSystem");
+  TF_ASSERT_OK(Env::Default()->CreateDir(base_path));
+  TF_ASSERT_OK(Env::Default()->CreateDir(io::JoinPath(base_path, "1")));
+
+  auto config = test_util::CreateProto<FileSystemStoragePathSourceConfig>(
+      strings::Printf("servable_name: 'test_servable_name' "
+                      "base_path: '%s' "
+                      "watch_file_system: true "
+                      // Disable the polling thread.
+                      "file_system_poll_wait_seconds: -1 ",
+                      base_path.c_str()));
+  std::unique_ptr<FileSystemStoragePathSource> source;
+  TF_ASSERT_OK(FileSystemStoragePathSource::Create(config, &source));
+  std::unique_ptr<test_util::MockStoragePathTarget> target(
+      new StrictMock<test_util::MockStoragePathTarget>);
+  ConnectSourceToTarget(source.get(), target.get());
+
+  // The first poll starts watching the base path, and polls it.
+  EXPECT_CALL(*target, SetAspiredVersions(Eq("test_servable_name"),
+                                          ElementsAre(ServableData<StoragePath>(
+                                              {"test_servable_name", 1},
+                                              io::JoinPath(base_path, "1")))));
+  TF_ASSERT_OK(internal::FileSystemStoragePathSourceTestAccess(source.get())
+                   .PollFileSystemAndInvokeCallback());
+
+  // A new version moved into the base path is picked up without polling.
+  const string staging_path =
+      io::JoinPath(testing::TmpDir(), "WatchFileSystem_staging");
+  TF_ASSERT_OK(Env::Default()->CreateDir(staging_path));
+  Notification new_version_aspired;
+  EXPECT_CALL(*target, SetAspiredVersions(Eq("test_servable_name"),
+                                          ElementsAre(ServableData<StoragePath>(
+                                              {"test_servable_name", 2},
+                                              io::JoinPath(base_path, "2")))))
+      .WillOnce(InvokeWithoutArgs([&]() { new_version_aspired.Notify(); }));
+  TF_ASSERT_OK(Env::Default()->RenameFile(staging_path,
+                                          io::JoinPath(base_path, "2")));
+  new_version_aspired.WaitForNotification();
+
+  // Subsequent polls skip the watched base path, except for every tenth one.
+  for (int i = 2; i < 10; ++i) {
+    TF_ASSERT_OK(internal::FileSystemStoragePathSourceTestAccess(source.get())
+                     .PollFileSystemAndInvokeCallback());
+  }
+  EXPECT_CALL(*target, SetAspiredVersions(Eq("test_servable_name"),
+                                          ElementsAre(ServableData<StoragePath>(
+                                              {"test_servable_name", 2},
+                                              io::JoinPath(base_path, "2")))));
+  TF_ASSERT_OK(internal::FileSystemStoragePathSourceTestAccess(source.get())
+                   .PollFileSystemAndInvokeCallback());
+}
+#endif  // defined(__linux__)
+
+TEST(FileSystemStoragePathSourceTest, ParallelPolling) {
+  const string base_path_prefix =
+      io::JoinPath(testing::TmpDir(), "ParallelPolling_");
+  constexpr int kNumServables = 10;
+  string servables;
+  for (int i = 0; i < kNumServables; ++i) {
+    const string base_path = strings::StrCat(base_path_prefix, i);
+    TF_ASSERT_OK(Env::Default()->CreateDir(base_path));
+    TF_ASSERT_OK(Env::Default()->CreateDir(io::JoinPath(base_path, "1")));
+    strings::StrAppend(&servables, "servables: { servable_name: 'servable_", i,
+                       "' base_path: '", base_path, "' } ");
+  }
+  auto config = test_util::CreateProto<FileSystemStoragePathSourceConfig>(
+      strings::StrCat(servables,
+                      "num_poll_threads: 4 "
+                      // Disable the polling thread.
+                      "file_system_poll_wait_seconds: -1 "));
+  std::unique_ptr<FileSystemStoragePathSource> source;
+  TF_ASSERT_OK(FileSystemStoragePathSource::Create(config, &source));
+  std::unique_ptr<test_util::MockStoragePathTarget> target(
+      new StrictMock<test_util::MockStoragePathTarget>);
+  ConnectSourceToTarget(source.get(), target.get());
+
+  for (int i = 0; i < kNumServables; ++i) {
+    const string servable_name = strings::StrCat("servable_", i);
+    EXPECT_CALL(*target,
+                SetAspiredVersions(
+                    Eq(servable_name),
+                    ElementsAre(ServableData<StoragePath>(
+                        {servable_name, 1},
+                        io::JoinPath(strings::StrCat(base_path_prefix, i),
+                                     "1")))));
+  }
+  TF_ASSERT_OK(internal::FileSystemStoragePathSourceTestAccess(source.get())
+                   .PollFileSystemAndInvokeCallback());
+
+  // An error polling any servable fails the poll.
+  TF_ASSERT_OK(
+      Env::Default()->DeleteDir(io::JoinPath(base_path_prefix + "3", "1")));
+  TF_ASSERT_OK(Env::Default()->DeleteDir(base_path_prefix + "3"));
+  EXPECT_FALSE(internal::FileSystemStoragePathSourceTestAccess(source.get())
+                   .PollFileSystemAndInvokeCallback()
+                   .ok());
+}
+
+TEST(FileSystemStoragePathSourceTest, SkipUnchangedBasePaths) {
+  const string base_path =
+      io::JoinPath(testing::TmpDir(), "SkipUnchangedBasePaths");
+  TF_ASSERT_OK(Env::Default()->CreateDir(base_path));
+  TF_ASSERT_OK(Env::Default()->CreateDir(io::JoinPath(base_path, "1")));
+  // Age the base path, so that its children may be cached.
+  struct utimbuf old_times = {1000000000, 1000000000};
+  ASSERT_EQ(0, utime(base_path.c_str(), &old_times));
+
+  auto config = test_util::CreateProto<FileSystemStoragePathSourceConfig>(
+      strings::Printf("servable_name: 'test_servable_name' "
+                      "base_path: '%s' "
+                      "skip_unchanged_base_paths: true "
+                      // Disable the polling thread.
+                      "file_system_poll_wait_seconds: -1 ",
+                      base_path.c_str()));
+  std::unique_ptr<FileSystemStoragePathSource> source;
+  TF_ASSERT_OK(FileSystemStoragePathSource::Create(config, &source));
+  std::unique_ptr<test_util::MockStoragePathTarget> target(
+      new StrictMock<test_util::MockStoragePathTarget>);
+  ConnectSourceToTarget(source.get(), target.get());
+
+  EXPECT_CALL(*target, SetAspiredVersions(Eq("test_servable_name"),
+                                          ElementsAre(ServableData<StoragePath>(
+                                              {"test_servable_name", 1},
+                                              io::JoinPath(base_path, "1")))))
+      .Times(2);
+  TF_ASSERT_OK(internal::FileSystemStoragePathSourceTestAccess(source.get())
+                   .PollFileSystemAndInvokeCallback());
+
+  // Sneak in a version without changing the base path's modification time:
+  // the cached children are used.
+  TF_ASSERT_OK(Env::Default()->CreateDir(io::JoinPath(base_path, "2")));
+  ASSERT_EQ(0, utime(base_path.c_str(), &old_times));
+  TF_ASSERT_OK(internal::FileSystemStoragePathSourceTestAccess(source.get())
+                   .PollFileSystemAndInvokeCallback());
+
+  // Once the modification time changes, the base path is listed again.
+  TF_ASSERT_OK(Env::Default()->CreateDir(io::JoinPath(base_path, "3")));
+  EXPECT_CALL(*target, SetAspiredVersions(Eq("test_servable_name"),
+                                          ElementsAre(ServableData<StoragePath>(
+                                              {"test_servable_name", 3},
+                                              io::JoinPath(base_path, "3")))));
+  TF_ASSERT_OK(internal::FileSystemStoragePathSourceTestAccess(source.get())
+                   .PollFileSystemAndInvokeCallback());
+}
+
 TEST(FileSystemStoragePathSourceTest, ParseTimestampedVersion) {
   static_assert(static_cast<int32>(20170111173521LL) == 944751505,
                 "Version overflows if cast to int32.");
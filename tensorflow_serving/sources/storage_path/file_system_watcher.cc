@@ -0,0 +1,237 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/sources/storage_path/file_system_watcher.h"
+
+#if defined(__linux__)
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace serving {
+
+bool FileSystemWatcher::IsWatchablePath(const string& path) {
+  StringPiece scheme, host, unused_path;
+  io::ParseURI(path, &scheme, &host, &unused_path);
+  return scheme.empty() || scheme == "file";
+}
+
+#if defined(__linux__)
+
+namespace {
+
+// The events that indicate a change of a watched directory's children, or of
+// the directory itself.
+constexpr uint32 kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                              IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+                              IN_ONLYDIR;
+
+// Strips a "file://" scheme, if any, from 'path'.
+string LocalPath(const string& path) {
+  StringPiece scheme, host, local_path;
+  io::ParseURI(path, &scheme, &host, &local_path);
+  return local_path.ToString();
+}
+
+}  // namespace
+
+Status FileSystemWatcher::Create(ChangeCallback callback,
+                                 std::unique_ptr<FileSystemWatcher>* result) {
+  const int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd < 0) {
+    return errors::Unavailable("inotify_init1 failed: ", strerror(errno));
+  }
+  const int wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wakeup_fd < 0) {
+    const int error = errno;
+    close(inotify_fd);
+    return errors::Unavailable("eventfd failed: ", strerror(error));
+  }
+  result->reset(
+      new FileSystemWatcher(inotify_fd, wakeup_fd, std::move(callback)));
+  return Status::OK();
+}
+
+FileSystemWatcher::FileSystemWatcher(const int inotify_fd, const int wakeup_fd,
+                                     ChangeCallback callback)
+    : inotify_fd_(inotify_fd),
+      wakeup_fd_(wakeup_fd),
+      callback_(std::move(callback)) {
+  thread_.reset(Env::Default()->StartThread(
+      {}, "FileSystemWatcher", [this]() { WatchLoop(); }));
+}
+
+FileSystemWatcher::~FileSystemWatcher() {
+  const uint64 one = 1;
+  if (write(wakeup_fd_, &one, sizeof(one)) != sizeof(one)) {
+    LOG(ERROR) << "Failed to wake up FileSystemWatcher thread: "
+               << strerror(errno);
+  }
+  // Joins the thread.
+  thread_.reset();
+  close(inotify_fd_);
+  close(wakeup_fd_);
+}
+
+Status FileSystemWatcher::AddWatch(const string& directory) {
+  if (!IsWatchablePath(directory)) {
+    return errors::Unimplemented("Cannot watch non-local path ", directory);
+  }
+  mutex_lock l(mu_);
+  if (watches_by_directory_.count(directory) > 0) {
+    return Status::OK();
+  }
+  const int watch =
+      inotify_add_watch(inotify_fd_, LocalPath(directory).c_str(), kWatchMask);
+  if (watch < 0) {
+    return errors::Unavailable("Cannot watch ", directory, ": ",
+                               strerror(errno));
+  }
+  // Distinct paths (e.g. via symlinks) may resolve to the same watch, in which
+  // case the latest one wins.
+  auto existing = directories_by_watch_.find(watch);
+  if (existing != directories_by_watch_.end()) {
+    watches_by_directory_.erase(existing->second);
+  }
+  directories_by_watch_[watch] = directory;
+  watches_by_directory_[directory] = watch;
+  return Status::OK();
+}
+
+void FileSystemWatcher::RemoveWatch(const string& directory) {
+  mutex_lock l(mu_);
+  auto it = watches_by_directory_.find(directory);
+  if (it == watches_by_directory_.end()) {
+    return;
+  }
+  inotify_rm_watch(inotify_fd_, it->second);
+  directories_by_watch_.erase(it->second);
+  watches_by_directory_.erase(it);
+}
+
+bool FileSystemWatcher::IsWatched(const string& directory) const {
+  mutex_lock l(mu_);
+  return watches_by_directory_.count(directory) > 0;
+}
+
+void FileSystemWatcher::WatchLoop() {
+  // Large enough for many events, aligned as the kernel requires.
+  alignas(struct inotify_event) char buffer[64 * 1024];
+  for (;;) {
+    struct pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wakeup_fd_, POLLIN, 0}};
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      LOG(ERROR) << "FileSystemWatcher poll failed: " << strerror(errno);
+      return;
+    }
+    if (fds[1].revents != 0) {
+      return;
+    }
+
+    std::set<string> changed_directories;
+    std::set<string> directories_with_created_children;
+    for (;;) {
+      const ssize_t length = read(inotify_fd_, buffer, sizeof(buffer));
+      if (length <= 0) {
+        if (length < 0 && errno == EINTR) continue;
+        // EAGAIN: all pending events have been read.
+        break;
+      }
+      mutex_lock l(mu_);
+      for (const char* ptr = buffer; ptr < buffer + length;) {
+        const auto* event = reinterpret_cast<const struct inotify_event*>(ptr);
+        ptr += sizeof(struct inotify_event) + event->len;
+        if (event->mask & IN_Q_OVERFLOW) {
+          // Events were lost, so any directory may have changed.
+          for (const auto& entry : watches_by_directory_) {
+            changed_directories.insert(entry.first);
+          }
+          continue;
+        }
+        auto it = directories_by_watch_.find(event->wd);
+        if (it == directories_by_watch_.end()) {
+          // Removed by RemoveWatch(), or already reported as gone.
+          continue;
+        }
+        if (event->mask & IN_CREATE) {
+          directories_with_created_children.insert(it->second);
+        } else {
+          changed_directories.insert(it->second);
+        }
+        if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+          // The directory is gone from its path, so its watch is useless.
+          if (!(event->mask & IN_IGNORED)) {
+            inotify_rm_watch(inotify_fd_, event->wd);
+          }
+          watches_by_directory_.erase(it->second);
+          directories_by_watch_.erase(it);
+        }
+      }
+    }
+    for (const string& directory : changed_directories) {
+      directories_with_created_children.erase(directory);
+    }
+    if (!changed_directories.empty() ||
+        !directories_with_created_children.empty()) {
+      callback_(changed_directories, directories_with_created_children);
+    }
+  }
+}
+
+#else  // !defined(__linux__)
+
+Status FileSystemWatcher::Create(ChangeCallback callback,
+                                 std::unique_ptr<FileSystemWatcher>* result) {
+  return errors::Unimplemented(
+      "File system watching is only supported on Linux");
+}
+
+FileSystemWatcher::FileSystemWatcher(const int inotify_fd, const int wakeup_fd,
+                                     ChangeCallback callback)
+    : inotify_fd_(inotify_fd),
+      wakeup_fd_(wakeup_fd),
+      callback_(std::move(callback)) {}
+
+FileSystemWatcher::~FileSystemWatcher() = default;
+
+Status FileSystemWatcher::AddWatch(const string& directory) {
+  return errors::Unimplemented(
+      "File system watching is only supported on Linux");
+}
+
+void FileSystemWatcher::RemoveWatch(const string& directory) {}
+
+bool FileSystemWatcher::IsWatched(const string& directory) const {
+  return false;
+}
+
+void FileSystemWatcher::WatchLoop() {}
+
+#endif  // defined(__linux__)
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,99 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_SOURCES_STORAGE_PATH_FILE_SYSTEM_WATCHER_H_
+#define TENSORFLOW_SERVING_SOURCES_STORAGE_PATH_FILE_SYSTEM_WATCHER_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Watches directories on the local file system for children being created,
+// deleted or renamed, using inotify. Only supported on Linux.
+//
+// Changes are reported from a background thread, batched: each invocation of
+// the callback carries the (deduplicated) watched directories that changed
+// since the previous one. Directories that only had children created in place
+// are reported separately from those that had children moved in or out or
+// deleted, since a child created in place (e.g. by mkdir followed by a copy)
+// may still be being written. If the kernel's event queue overflows, all
+// watched directories are reported as changed. If a watched directory is itself
+// deleted or moved, it is reported one last time and then no longer watched
+// (see IsWatched()).
+class FileSystemWatcher {
+ public:
+  using ChangeCallback = std::function<void(
+      const std::set<string>& changed_directories,
+      const std::set<string>& directories_with_created_children)>;
+
+  // Returns an error if watching is not supported on this platform.
+  static Status Create(ChangeCallback callback,
+                       std::unique_ptr<FileSystemWatcher>* result);
+
+  // Blocks until the background thread, and any callback it is running, has
+  // finished.
+  ~FileSystemWatcher();
+
+  // Starts watching 'directory'. Returns an error if it cannot be watched, e.g.
+  // because it does not exist or is not on the local file system.
+  Status AddWatch(const string& directory);
+
+  // Stops watching 'directory'. A no-op if it is not being watched.
+  void RemoveWatch(const string& directory);
+
+  // Returns whether 'directory' is currently being watched.
+  bool IsWatched(const string& directory) const;
+
+  // Returns whether 'path' is on a file system that can be watched, i.e. is a
+  // local path rather than a URI of a remote file system.
+  static bool IsWatchablePath(const string& path);
+
+ private:
+  FileSystemWatcher(int inotify_fd, int wakeup_fd, ChangeCallback callback);
+
+  // Reads and reports events until the destructor signals 'wakeup_fd_'.
+  void WatchLoop();
+
+  const int inotify_fd_;
+  // Written to by the destructor, to wake up WatchLoop().
+  const int wakeup_fd_;
+  const ChangeCallback callback_;
+
+  mutable mutex mu_;
+  // The watched directories, by inotify watch descriptor, and vice versa.
+  std::map<int, string> directories_by_watch_ GUARDED_BY(mu_);
+  std::map<string, int> watches_by_directory_ GUARDED_BY(mu_);
+
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FileSystemWatcher);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_SOURCES_STORAGE_PATH_FILE_SYSTEM_WATCHER_H_
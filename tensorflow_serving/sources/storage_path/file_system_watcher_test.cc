@@ -0,0 +1,133 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/sources/storage_path/file_system_watcher.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+TEST(FileSystemWatcherTest, IsWatchablePath) {
+  EXPECT_TRUE(FileSystemWatcher::IsWatchablePath("/foo/bar"));
+  EXPECT_TRUE(FileSystemWatcher::IsWatchablePath("file:///foo/bar"));
+  EXPECT_FALSE(FileSystemWatcher::IsWatchablePath("gs://bucket/foo"));
+  EXPECT_FALSE(FileSystemWatcher::IsWatchablePath("hdfs://host/foo"));
+}
+
+#if defined(__linux__)
+
+TEST(FileSystemWatcherTest, ReportsChangedDirectories) {
+  const string watched = io::JoinPath(testing::TmpDir(), "Watched");
+  const string unwatched = io::JoinPath(testing::TmpDir(), "Unwatched");
+  TF_ASSERT_OK(Env::Default()->CreateDir(watched));
+  TF_ASSERT_OK(Env::Default()->CreateDir(unwatched));
+
+  mutex mu;
+  std::set<string> changed;
+  Notification notified;
+  std::unique_ptr<FileSystemWatcher> watcher;
+  TF_ASSERT_OK(FileSystemWatcher::Create(
+      [&](const std::set<string>& changed_directories,
+          const std::set<string>& directories_with_created_children) {
+        mutex_lock l(mu);
+        changed.insert(changed_directories.begin(), changed_directories.end());
+        if (!notified.HasBeenNotified()) notified.Notify();
+      },
+      &watcher));
+  TF_ASSERT_OK(watcher->AddWatch(watched));
+  EXPECT_TRUE(watcher->IsWatched(watched));
+  EXPECT_FALSE(watcher->IsWatched(unwatched));
+
+  TF_ASSERT_OK(Env::Default()->CreateDir(io::JoinPath(unwatched, "1")));
+  TF_ASSERT_OK(Env::Default()->RenameFile(io::JoinPath(unwatched, "1"),
+                                          io::JoinPath(watched, "1")));
+  notified.WaitForNotification();
+  mutex_lock l(mu);
+  EXPECT_THAT(changed, ::testing::ElementsAre(watched));
+}
+
+TEST(FileSystemWatcherTest, ReportsCreatedChildrenSeparately) {
+  const string watched = io::JoinPath(testing::TmpDir(), "CreatedChildren");
+  TF_ASSERT_OK(Env::Default()->CreateDir(watched));
+
+  mutex mu;
+  std::set<string> changed;
+  std::set<string> with_created_children;
+  Notification notified;
+  std::unique_ptr<FileSystemWatcher> watcher;
+  TF_ASSERT_OK(FileSystemWatcher::Create(
+      [&](const std::set<string>& changed_directories,
+          const std::set<string>& directories_with_created_children) {
+        mutex_lock l(mu);
+        changed.insert(changed_directories.begin(), changed_directories.end());
+        with_created_children.insert(directories_with_created_children.begin(),
+                                     directories_with_created_children.end());
+        if (!notified.HasBeenNotified()) notified.Notify();
+      },
+      &watcher));
+  TF_ASSERT_OK(watcher->AddWatch(watched));
+
+  TF_ASSERT_OK(Env::Default()->CreateDir(io::JoinPath(watched, "1")));
+  notified.WaitForNotification();
+  mutex_lock l(mu);
+  EXPECT_TRUE(changed.empty());
+  EXPECT_THAT(with_created_children, ::testing::ElementsAre(watched));
+}
+
+TEST(FileSystemWatcherTest, StopsWatchingDeletedDirectory) {
+  const string watched = io::JoinPath(testing::TmpDir(), "Deleted");
+  TF_ASSERT_OK(Env::Default()->CreateDir(watched));
+
+  Notification notified;
+  std::unique_ptr<FileSystemWatcher> watcher;
+  TF_ASSERT_OK(FileSystemWatcher::Create(
+      [&](const std::set<string>& changed_directories,
+          const std::set<string>& directories_with_created_children) {
+        if (!notified.HasBeenNotified()) notified.Notify();
+      },
+      &watcher));
+  TF_ASSERT_OK(watcher->AddWatch(watched));
+  TF_ASSERT_OK(Env::Default()->DeleteDir(watched));
+  notified.WaitForNotification();
+  while (watcher->IsWatched(watched)) {
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+}
+
+TEST(FileSystemWatcherTest, CannotWatchMissingDirectory) {
+  std::unique_ptr<FileSystemWatcher> watcher;
+  TF_ASSERT_OK(FileSystemWatcher::Create(
+      [](const std::set<string>& changed_directories,
+         const std::set<string>& directories_with_created_children) {},
+      &watcher));
+  EXPECT_FALSE(
+      watcher->AddWatch(io::JoinPath(testing::TmpDir(), "Missing")).ok());
+  EXPECT_FALSE(watcher->AddWatch("gs://bucket/foo").ok());
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
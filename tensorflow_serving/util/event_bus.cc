@@ -0,0 +1,42 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/util/event_bus.h"
+
+namespace tensorflow {
+namespace serving {
+namespace internal {
+
+monitoring::Gauge<int64, 1>* GetEventBusQueueDepthGauge() {
+  static auto* gauge = monitoring::Gauge<int64, 1>::New(
+      "/tensorflow/serving/event_bus_queue_depth",
+      "Number of events published on an asynchronous event bus but not yet "
+      "delivered to all subscribers.",
+      "event_bus");
+  return gauge;
+}
+
+monitoring::Counter<1>* GetEventBusPublishBlockedCounter() {
+  static auto* counter = monitoring::Counter<1>::New(
+      "/tensorflow/serving/event_bus_publish_blocked_count",
+      "Number of times publishing on an asynchronous event bus blocked because "
+      "its queue was full.",
+      "event_bus");
+  return counter;
+}
+
+}  // namespace internal
+}  // namespace serving
+}  // namespace tensorflow
@@ -13,17 +13,19 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-// TODO(b/25725560): Consider having a thread pool for invoking callbacks.
-
 #ifndef TENSORFLOW_SERVING_UTIL_EVENT_BUS_H_
 #define TENSORFLOW_SERVING_UTIL_EVENT_BUS_H_
 
 #include <algorithm>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <string>
 #include <type_traits>
 #include <vector>
 
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -50,9 +52,12 @@ namespace serving {
 ///
 /// Threading:
 /// EventBus is thread-safe. However, if any subscriber callback calls any
-/// method in the EventBus, it will deadlock. Subscribers are notified serially
-/// on the event publisher's thread. Thus, the amount of work done in a
-/// subscriber's callback should be very minimal.
+/// method in the EventBus, it will deadlock. By default, subscribers are
+/// notified serially on the event publisher's thread. Thus, the amount of work
+/// done in a subscriber's callback should be very minimal. Alternatively, the
+/// bus can be configured to deliver events asynchronously, on a dedicated
+/// thread (see Options::max_queued_events), so that slow subscribers don't hold
+/// up publishers.
 ///
 /// This implementation is single-binary and does not communicate across tasks.
 ///
@@ -88,8 +93,23 @@ class EventBus : public std::enable_shared_from_this<EventBus<E>> {
   };
 
   struct Options {
-    // The environment to use for time.
+    // The environment to use for time, and for the delivery thread.
     Env* env = Env::Default();
+
+    // If positive, events are delivered asynchronously: Publish() enqueues a
+    // copy of the event and returns, and the subscriber callbacks are invoked
+    // on a dedicated delivery thread, one event at a time and in the order in
+    // which the events were published. At most this many events are queued;
+    // once the queue is full, Publish() blocks until the delivery thread
+    // catches up. (Events are never dropped.)
+    //
+    // If 0, subscribers are notified synchronously, on the publisher's thread.
+    int max_queued_events = 0;
+
+    // Name of the bus, used to label its metrics (which are only exported in
+    // asynchronous mode). Should be unique among asynchronous buses. If empty,
+    // the metrics are labeled "unnamed".
+    string name;
   };
 
   /// Creates an EventBus and returns a shared_ptr to it. This is the only
@@ -97,7 +117,10 @@ class EventBus : public std::enable_shared_from_this<EventBus<E>> {
   /// references to an EventBus uniformly.
   static std::shared_ptr<EventBus> CreateEventBus(const Options& options = {});
 
-  ~EventBus() = default;
+  /// In asynchronous mode, blocks until all published events have been
+  /// delivered. Must not be called (e.g. by releasing the last reference to
+  /// the bus) from within a subscriber callback.
+  ~EventBus();
 
   /// Event and the publish time associated with it.
   struct EventAndTime {
@@ -131,11 +154,30 @@ class EventBus : public std::enable_shared_from_this<EventBus<E>> {
       LOCKS_EXCLUDED(mutex_) TF_MUST_USE_RESULT;
 
   /// Publishes an event to all subscribers.
-  void Publish(const E& event) LOCKS_EXCLUDED(mutex_);
+  ///
+  /// In asynchronous mode, returns as soon as the event is queued for delivery.
+  void Publish(const E& event) LOCKS_EXCLUDED(mutex_, queue_mutex_);
 
  private:
   explicit EventBus(const Options& options);
 
+  // An event awaiting asynchronous delivery.
+  struct QueuedEvent {
+    E event;
+    uint64 event_time_micros;
+  };
+
+  // Invokes the callback of each subscriber with the given event.
+  void InvokeCallbacks(const EventAndTime& event_and_time)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Body of the delivery thread in asynchronous mode. Delivers queued events
+  // until the bus is being destroyed and the queue is empty.
+  void DeliverQueuedEvents() LOCKS_EXCLUDED(mutex_, queue_mutex_);
+
+  // Exports the current size of 'queue_'.
+  void UpdateQueueDepthMetric() EXCLUSIVE_LOCKS_REQUIRED(queue_mutex_);
+
   // Unsubscribes the specified subscriber. Called only by Subscription.
   void Unsubscribe(const Subscription* subscription) LOCKS_EXCLUDED(mutex_);
 
@@ -148,7 +190,8 @@ class EventBus : public std::enable_shared_from_this<EventBus<E>> {
   };
 
   // Mutex held for all operations on an EventBus including all publishing and
-  // subscription operations.
+  // subscription operations. (In asynchronous mode, it is held by the delivery
+  // thread rather than by publishers.)
   mutable mutex mutex_;
 
   // All subscriptions that the EventBus is aware of. Note that this is not
@@ -157,11 +200,42 @@ class EventBus : public std::enable_shared_from_this<EventBus<E>> {
 
   const Options options_;
 
+  // The label of this bus's metrics: its name, or "unnamed" if it has none.
+  const string metric_label_;
+
+  // Guards the asynchronous delivery state below. Never held while invoking
+  // callbacks, so that publishers are not held up by subscribers.
+  mutable mutex queue_mutex_;
+
+  // Signalled when an event is queued or delivered, and upon destruction.
+  condition_variable queue_cv_;
+
+  // Events published but not yet fully delivered, in publication order. The
+  // front event is removed only once it has been delivered. (Deque insertions
+  // at the back don't invalidate references to the front event, so it can be
+  // delivered without holding 'queue_mutex_'.)
+  std::deque<QueuedEvent> queue_ GUARDED_BY(queue_mutex_);
+
+  // Set upon destruction, to make the delivery thread exit once it has drained
+  // the queue.
+  bool stop_delivery_ GUARDED_BY(queue_mutex_) = false;
+
+  // The thread delivering events, in asynchronous mode. Otherwise null.
+  std::unique_ptr<Thread> delivery_thread_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(EventBus);
 };
 
 // --- Implementation details below ---
 
+namespace internal {
+
+// Metrics shared by all asynchronous EventBus instances, labeled by bus name.
+monitoring::Gauge<int64, 1>* GetEventBusQueueDepthGauge();
+monitoring::Counter<1>* GetEventBusPublishBlockedCounter();
+
+}  // namespace internal
+
 template <typename E>
 EventBus<E>::Subscription::Subscription(std::weak_ptr<EventBus<E>> bus)
     : bus_(std::move(bus)) {}
@@ -185,7 +259,29 @@ std::unique_ptr<typename EventBus<E>::Subscription> EventBus<E>::Subscribe(
 }
 
 template <typename E>
-EventBus<E>::EventBus(const Options& options) : options_(options) {}
+EventBus<E>::EventBus(const Options& options)
+    : options_(options),
+      metric_label_(options.name.empty() ? "unnamed" : options.name) {
+  if (options_.max_queued_events > 0) {
+    delivery_thread_.reset(
+        options_.env->StartThread(ThreadOptions(), "EventBus_DeliverEvents",
+                                  [this]() { DeliverQueuedEvents(); }));
+  }
+}
+
+template <typename E>
+EventBus<E>::~EventBus() {
+  if (delivery_thread_ == nullptr) {
+    return;
+  }
+  {
+    mutex_lock lock(queue_mutex_);
+    stop_delivery_ = true;
+  }
+  queue_cv_.notify_all();
+  // Blocks until the delivery thread has drained the queue and exited.
+  delivery_thread_.reset();
+}
 
 template <typename E>
 std::shared_ptr<EventBus<E>> EventBus<E>::CreateEventBus(
@@ -207,14 +303,76 @@ void EventBus<E>::Unsubscribe(
 
 template <typename E>
 void EventBus<E>::Publish(const E& event) {
-  mutex_lock lock(mutex_);
-  const uint64 event_time = options_.env->NowMicros();
-  const EventAndTime event_and_time = {event, event_time};
+  if (delivery_thread_ == nullptr) {
+    mutex_lock lock(mutex_);
+    const uint64 event_time = options_.env->NowMicros();
+    InvokeCallbacks({event, event_time});
+    return;
+  }
+
+  const size_t max_queued_events = options_.max_queued_events;
+  {
+    mutex_lock lock(queue_mutex_);
+    if (queue_.size() >= max_queued_events) {
+      internal::GetEventBusPublishBlockedCounter()
+          ->GetCell(metric_label_)
+          ->IncrementBy(1);
+      while (queue_.size() >= max_queued_events) {
+        queue_cv_.wait(lock);
+      }
+    }
+    // Taken under the lock, so that event times are monotonic in queue order.
+    const uint64 event_time = options_.env->NowMicros();
+    queue_.push_back({event, event_time});
+    UpdateQueueDepthMetric();
+  }
+  queue_cv_.notify_all();
+}
+
+template <typename E>
+void EventBus<E>::InvokeCallbacks(const EventAndTime& event_and_time) {
   for (const SubscriptionTuple& subscription : subscriptions_) {
     subscription.callback(event_and_time);
   }
 }
 
+template <typename E>
+void EventBus<E>::DeliverQueuedEvents() {
+  while (true) {
+    const QueuedEvent* queued_event;
+    {
+      mutex_lock lock(queue_mutex_);
+      while (queue_.empty() && !stop_delivery_) {
+        queue_cv_.wait(lock);
+      }
+      if (queue_.empty()) {
+        return;
+      }
+      queued_event = &queue_.front();
+    }
+
+    {
+      mutex_lock lock(mutex_);
+      InvokeCallbacks(
+          {queued_event->event, queued_event->event_time_micros});
+    }
+
+    {
+      mutex_lock lock(queue_mutex_);
+      queue_.pop_front();
+      UpdateQueueDepthMetric();
+    }
+    queue_cv_.notify_all();
+  }
+}
+
+template <typename E>
+void EventBus<E>::UpdateQueueDepthMetric() {
+  internal::GetEventBusQueueDepthGauge()
+      ->GetCell(metric_label_)
+      ->Set(queue_.size());
+}
+
 }  // namespace serving
 }  // namespace tensorflow
 
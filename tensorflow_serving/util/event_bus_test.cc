@@ -15,13 +15,20 @@ limitations under the License.
 
 #include "tensorflow_serving/util/event_bus.h"
 
+#include <vector>
+
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
 
 namespace tensorflow {
 namespace serving {
 namespace {
 
+using ::testing::ElementsAre;
+
 typedef EventBus<int> IntEventBus;
 
 TEST(EventBusTest, PublishNoSubscribers) {
@@ -125,6 +132,69 @@ TEST(EventBusTest, TestAutomaticUnsubscribing) {
   EXPECT_EQ(3, value_timestamp);
 }
 
+TEST(EventBusTest, AsynchronousDeliveryPreservesOrder) {
+  test_util::FakeClockEnv env(Env::Default());
+  IntEventBus::Options bus_options;
+  bus_options.env = &env;
+  bus_options.max_queued_events = 2;
+  bus_options.name = "AsynchronousDeliveryPreservesOrder";
+  std::shared_ptr<IntEventBus> bus = IntEventBus::CreateEventBus(bus_options);
+
+  constexpr int kNumEvents = 100;
+  std::vector<int> values;
+  std::vector<uint64> timestamps;
+  BlockingCounter all_delivered(kNumEvents);
+  std::unique_ptr<IntEventBus::Subscription> subscription =
+      bus->Subscribe([&](const IntEventBus::EventAndTime& event_and_time) {
+        values.push_back(event_and_time.event);
+        timestamps.push_back(event_and_time.event_time_micros);
+        all_delivered.DecrementCount();
+      });
+  std::vector<int> expected_values;
+  std::vector<uint64> expected_timestamps;
+  for (int i = 0; i < kNumEvents; ++i) {
+    env.AdvanceByMicroseconds(1);
+    bus->Publish(i);
+    expected_values.push_back(i);
+    expected_timestamps.push_back(i + 1);
+  }
+  all_delivered.Wait();
+  EXPECT_EQ(expected_values, values);
+  EXPECT_EQ(expected_timestamps, timestamps);
+}
+
+TEST(EventBusTest, SlowSubscriberDoesNotBlockPublisher) {
+  IntEventBus::Options bus_options;
+  bus_options.max_queued_events = 3;
+  bus_options.name = "SlowSubscriberDoesNotBlockPublisher";
+  std::shared_ptr<IntEventBus> bus = IntEventBus::CreateEventBus(bus_options);
+
+  Notification first_event_delivering;
+  Notification unblock_subscriber;
+  std::vector<int> values;
+  std::unique_ptr<IntEventBus::Subscription> subscription =
+      bus->Subscribe([&](const IntEventBus::EventAndTime& event_and_time) {
+        if (!first_event_delivering.HasBeenNotified()) {
+          first_event_delivering.Notify();
+        }
+        unblock_subscriber.WaitForNotification();
+        values.push_back(event_and_time.event);
+      });
+
+  // The subscriber is stuck on the first event, yet we can publish up to the
+  // queue limit.
+  bus->Publish(1);
+  first_event_delivering.WaitForNotification();
+  bus->Publish(2);
+  bus->Publish(3);
+  EXPECT_TRUE(values.empty());
+
+  unblock_subscriber.Notify();
+  // Destroying the bus delivers the queued events.
+  bus.reset();
+  EXPECT_THAT(values, ElementsAre(1, 2, 3));
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
@@ -36,5 +36,13 @@ Status TensorflowFileProbingEnv::GetFileSize(const string& fname,
   return env_->GetFileSize(fname, file_size);
 }
 
+Status TensorflowFileProbingEnv::GetModificationTime(const string& fname,
+                                                     int64* mtime_nsec) {
+  FileStatistics stat;
+  TF_RETURN_IF_ERROR(env_->Stat(fname, &stat));
+  *mtime_nsec = stat.mtime_nsec;
+  return Status::OK();
+}
+
 }  // namespace serving
 }  // namespace tensorflow
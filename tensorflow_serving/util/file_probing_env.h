@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_SERVING_UTIL_FILE_PROBING_ENV_H_
 #define TENSORFLOW_SERVING_UTIL_FILE_PROBING_ENV_H_
 
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/env.h"
 
@@ -24,6 +25,7 @@ namespace serving {
 
 // An interface used to probe the contents of a file system. This allows file
 // systems other than those supported by tensorflow::Env to be used.
+// Implementations must be thread-safe: files may be probed concurrently.
 class FileProbingEnv {
  public:
   virtual ~FileProbingEnv() = default;
@@ -43,6 +45,14 @@ class FileProbingEnv {
 
   // Stores the size of `fname` in `*file_size`.
   virtual Status GetFileSize(const string& fname, uint64* file_size) = 0;
+
+  // Stores the last modification time of `fname`, in nanoseconds since the
+  // epoch, in `*mtime_nsec`. Used to detect unchanged directories, whose
+  // probing results can then be reused. The default implementation returns
+  // UNIMPLEMENTED, in which case nothing is reused.
+  virtual Status GetModificationTime(const string& fname, int64* mtime_nsec) {
+    return errors::Unimplemented("GetModificationTime not implemented");
+  }
 };
 
 // An implementation of FileProbingEnv which delegates the calls to
@@ -62,6 +72,8 @@ class TensorflowFileProbingEnv : public FileProbingEnv {
 
   Status GetFileSize(const string& fname, uint64* file_size) override;
 
+  Status GetModificationTime(const string& fname, int64* mtime_nsec) override;
+
  private:
   // Not owned.
   tensorflow::Env* env_;
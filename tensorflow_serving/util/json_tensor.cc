@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow_serving/util/json_tensor.h"
 
+#include <cassert>
 #include <cstdlib>
 #include <limits>
 #include <string>
@@ -433,16 +434,76 @@ Status AddInstanceItem(const rapidjson::Value& item, const string& name,
   return Status::OK();
 }
 
-Status ParseJson(const absl::string_view json, rapidjson::Document* doc) {
-  if (json.empty()) {
+// A rapidjson input (byte) stream over the chunks of a JSON document. Each
+// chunk is released (by reading the next one) as soon as it is consumed.
+class JsonChunkStream {
+ public:
+  typedef char Ch;
+
+  explicit JsonChunkStream(const JsonChunkReader& read_json)
+      : read_json_(read_json) {
+    NextChunk();
+  }
+
+  bool AtEnd() const { return pos_ == end_; }
+
+  Ch Peek() const { return AtEnd() ? '\0' : *pos_; }
+
+  Ch Take() {
+    if (AtEnd()) return '\0';
+    const Ch c = *pos_++;
+    if (AtEnd()) NextChunk();
+    return c;
+  }
+
+  size_t Tell() const { return offset_ + (pos_ - begin_); }
+
+  // Only used for in-situ parsing, which isn't supported.
+  Ch* PutBegin() {
+    assert(false);
+    return nullptr;
+  }
+  void Put(Ch) { assert(false); }
+  void Flush() { assert(false); }
+  size_t PutEnd(Ch*) {
+    assert(false);
+    return 0;
+  }
+
+ private:
+  void NextChunk() {
+    offset_ += end_ - begin_;
+    const absl::string_view chunk = read_json_();
+    begin_ = pos_ = chunk.data();
+    end_ = begin_ + chunk.size();
+  }
+
+  const JsonChunkReader& read_json_;
+  const Ch* begin_ = nullptr;
+  const Ch* pos_ = nullptr;
+  const Ch* end_ = nullptr;
+  size_t offset_ = 0;  // of begin_ in the document
+};
+
+// Returns a JsonChunkReader that reads all of `json` at once.
+JsonChunkReader ReadJsonString(const absl::string_view json) {
+  return [json]() mutable {
+    const absl::string_view chunk = json;
+    json = absl::string_view();
+    return chunk;
+  };
+}
+
+Status ParseJson(const JsonChunkReader& read_json, rapidjson::Document* doc) {
+  JsonChunkStream chunks(read_json);
+  if (chunks.AtEnd()) {
     return errors::InvalidArgument("JSON Parse error: The document is empty");
   }
 
-  // `json` may not be null-terminated (read from a mem buffer).
-  // Wrap it in an input stream before attempting to Parse().
-  rapidjson::MemoryStream ms(json.data(), json.size());
-  rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream>
-      jsonstream(ms);
+  // The chunks are not null-terminated (read from mem buffers).
+  // Wrap them in an input stream before attempting to Parse().
+  rapidjson::EncodedInputStream<rapidjson::UTF8<>, JsonChunkStream> jsonstream(
+      chunks);
   // TODO(b/67042542): Switch to using custom stack for parsing to protect
   // against deep nested structures causing excessive recursion/SO.
   if (doc->ParseStream<rapidjson::kParseNanAndInfFlag>(jsonstream)
@@ -619,9 +680,19 @@ Status FillPredictRequestFromJson(
         const string&, ::google::protobuf::Map<string, tensorflow::TensorInfo>*)>&
         get_tensorinfo_map,
     PredictRequest* request, JsonPredictRequestFormat* format) {
+  return FillPredictRequestFromJson(ReadJsonString(json), get_tensorinfo_map,
+                                    request, format);
+}
+
+Status FillPredictRequestFromJson(
+    const JsonChunkReader& read_json,
+    const std::function<tensorflow::Status(
+        const string&, ::google::protobuf::Map<string, tensorflow::TensorInfo>*)>&
+        get_tensorinfo_map,
+    PredictRequest* request, JsonPredictRequestFormat* format) {
   rapidjson::Document doc;
   *format = JsonPredictRequestFormat::kInvalid;
-  TF_RETURN_IF_ERROR(ParseJson(json, &doc));
+  TF_RETURN_IF_ERROR(ParseJson(read_json, &doc));
   TF_RETURN_IF_ERROR(FillSignature(doc, request));
 
   ::google::protobuf::Map<string, tensorflow::TensorInfo> tensorinfo_map;
@@ -782,10 +853,10 @@ Status MakeExampleFromJsonObject(const rapidjson::Value& val,
 }
 
 template <typename RequestProto>
-Status FillClassifyRegressRequestFromJson(const absl::string_view json,
+Status FillClassifyRegressRequestFromJson(const JsonChunkReader& read_json,
                                           RequestProto* request) {
   rapidjson::Document doc;
-  TF_RETURN_IF_ERROR(ParseJson(json, &doc));
+  TF_RETURN_IF_ERROR(ParseJson(read_json, &doc));
   TF_RETURN_IF_ERROR(FillSignature(doc, request));
 
   // Fill in (optional) Example context.
@@ -829,12 +900,22 @@ Status FillClassifyRegressRequestFromJson(const absl::string_view json,
 
 Status FillClassificationRequestFromJson(const absl::string_view json,
                                          ClassificationRequest* request) {
-  return FillClassifyRegressRequestFromJson(json, request);
+  return FillClassifyRegressRequestFromJson(ReadJsonString(json), request);
 }
 
 Status FillRegressionRequestFromJson(const absl::string_view json,
                                      RegressionRequest* request) {
-  return FillClassifyRegressRequestFromJson(json, request);
+  return FillClassifyRegressRequestFromJson(ReadJsonString(json), request);
+}
+
+Status FillClassificationRequestFromJson(const JsonChunkReader& read_json,
+                                         ClassificationRequest* request) {
+  return FillClassifyRegressRequestFromJson(read_json, request);
+}
+
+Status FillRegressionRequestFromJson(const JsonChunkReader& read_json,
+                                     RegressionRequest* request) {
+  return FillClassifyRegressRequestFromJson(read_json, request);
 }
 
 namespace {
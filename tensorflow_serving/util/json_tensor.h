@@ -38,6 +38,11 @@ enum class JsonPredictRequestFormat {
   kColumnar,
 };
 
+// Reads a JSON document in chunks, e.g. as it is read off a request body.
+// Each call returns the next chunk of the document, or an empty string once
+// the document is over. A chunk need only stay valid until the next call.
+using JsonChunkReader = std::function<absl::string_view()>;
+
 // Fills PredictRequest proto from a JSON object.
 //
 // `json` string is parsed to create TensorProtos based on the type map returned
@@ -149,6 +154,15 @@ tensorflow::Status FillPredictRequestFromJson(
         get_tensorinfo_map,
     PredictRequest* request, JsonPredictRequestFormat* format);
 
+// Same as above, but parses the JSON document as it is read from `read_json`
+// instead of from a string holding all of it.
+tensorflow::Status FillPredictRequestFromJson(
+    const JsonChunkReader& read_json,
+    const std::function<tensorflow::Status(
+        const string&, ::google::protobuf::Map<string, tensorflow::TensorInfo>*)>&
+        get_tensorinfo_map,
+    PredictRequest* request, JsonPredictRequestFormat* format);
+
 // Fills ClassificationRequest proto from a JSON object.
 //
 // `json` string is parsed to create `Example` protos and added to
@@ -195,6 +209,13 @@ tensorflow::Status FillClassificationRequestFromJson(
 tensorflow::Status FillRegressionRequestFromJson(const absl::string_view json,
                                                  RegressionRequest* request);
 
+// Same as the two above, but parse the JSON document as it is read from
+// `read_json` (see FillPredictRequestFromJson()).
+tensorflow::Status FillClassificationRequestFromJson(
+    const JsonChunkReader& read_json, ClassificationRequest* request);
+tensorflow::Status FillRegressionRequestFromJson(
+    const JsonChunkReader& read_json, RegressionRequest* request);
+
 // Make JSON object from TensorProtos.
 //
 // `tensor_map` contains a map of name/alias tensor names (as it appears in the
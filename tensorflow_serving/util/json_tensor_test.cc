@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow_serving/util/json_tensor.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "google/protobuf/message.h"
 #include "google/protobuf/text_format.h"
 #include "google/protobuf/util/message_differencer.h"
@@ -196,6 +199,58 @@ TEST(JsontensorTest, TensorFromNonNullTerminatedBuffer) {
     )"));
 }
 
+TEST(JsontensorTest, TensorFromJsonChunks) {
+  TensorInfoMap infomap;
+  ASSERT_TRUE(
+      TextFormat::ParseFromString("dtype: DT_INT32", &infomap["default"]));
+
+  // Read the JSON three bytes at a time, from a buffer that is overwritten
+  // (and is not null terminated) for each chunk.
+  const string jsonstr = R"({"instances": [[1,2],[3,4],[5,6]]})";
+  size_t pos = 0;
+  char chunk[3];
+  auto read_json = [&jsonstr, &pos, &chunk]() {
+    const size_t size = std::min(sizeof(chunk), jsonstr.size() - pos);
+    memcpy(chunk, jsonstr.data() + pos, size);
+    pos += size;
+    return absl::string_view(chunk, size);
+  };
+  PredictRequest req;
+  JsonPredictRequestFormat format;
+  TF_EXPECT_OK(
+      FillPredictRequestFromJson(read_json, getmap(infomap), &req, &format));
+  auto tmap = req.inputs();
+  EXPECT_EQ(tmap.size(), 1);
+  EXPECT_EQ(format, JsonPredictRequestFormat::kRow);
+  EXPECT_THAT(tmap["default"], EqualsProto(R"(
+    dtype: DT_INT32
+    tensor_shape {
+      dim { size: 3 }
+      dim { size: 2 }
+    }
+    int_val: 1
+    int_val: 2
+    int_val: 3
+    int_val: 4
+    int_val: 5
+    int_val: 6
+    )"));
+
+  // Errors are reported at their offset in the whole document.
+  const string badjsonstr = R"({"instances": [[1,2],[3,4],[5,6]})";
+  pos = 0;
+  auto read_bad_json = [&badjsonstr, &pos, &chunk]() {
+    const size_t size = std::min(sizeof(chunk), badjsonstr.size() - pos);
+    memcpy(chunk, badjsonstr.data() + pos, size);
+    pos += size;
+    return absl::string_view(chunk, size);
+  };
+  Status status = FillPredictRequestFromJson(read_bad_json, getmap(infomap),
+                                             &req, &format);
+  ASSERT_TRUE(errors::IsInvalidArgument(status));
+  EXPECT_THAT(status.error_message(), HasSubstr("at offset: 32"));
+}
+
 TEST(JsontensorTest, SingleUnnamedTensorBase64Scalars) {
   TensorInfoMap infomap;
   ASSERT_TRUE(
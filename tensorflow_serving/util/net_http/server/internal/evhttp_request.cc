@@ -19,12 +19,18 @@ limitations under the License.
 
 #include <zlib.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "absl/base/internal/raw_logging.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 
 #include "libevent/include/event2/buffer.h"
@@ -39,6 +45,42 @@ namespace tensorflow {
 namespace serving {
 namespace net_http {
 
+namespace {
+
+// Max size of each block of uncompressed data returned by ReadRequestBytes().
+constexpr size_t kUncompressBlockSize = 64 * 1024;
+
+// Max size of each slice of the response body deflated at once.
+constexpr size_t kCompressSliceSize = 64 * 1024;
+
+// Returns true if the Accept-Encoding header value accepts gzip, i.e. it
+// lists "gzip" (or "*") without a zero q-value.
+bool AcceptsGzip(absl::string_view accept_encoding) {
+  for (absl::string_view coding : absl::StrSplit(accept_encoding, ',')) {
+    std::vector<absl::string_view> params = absl::StrSplit(coding, ';');
+    absl::string_view name = absl::StripAsciiWhitespace(params[0]);
+    if (!absl::EqualsIgnoreCase(name, "gzip") && name != "*") {
+      continue;
+    }
+
+    double q = 1;
+    for (size_t i = 1; i < params.size(); ++i) {
+      absl::string_view param = absl::StripAsciiWhitespace(params[i]);
+      if (absl::StartsWithIgnoreCase(param, "q=") &&
+          !absl::SimpleAtod(param.substr(2), &q)) {
+        q = 0;  // malformed
+      }
+    }
+    if (q > 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace
+
 ParsedEvRequest::~ParsedEvRequest() {
   if (decoded_uri) {
     evhttp_uri_free(decoded_uri);
@@ -119,6 +161,7 @@ bool ParsedEvRequest::decode() {
 EvHTTPRequest::EvHTTPRequest(std::unique_ptr<ParsedEvRequest> request,
                              ServerSupport* server)
     : server_(server),
+      handler_options_(nullptr),
       parsed_request_(std::move(request)),
       output_buf(nullptr) {}
 
@@ -169,6 +212,10 @@ std::unique_ptr<char[], BlockDeleter> EvHTTPRequest::ReadRequestBytes(
 
   auto buf_size = reinterpret_cast<size_t*>(size);
 
+  if (NeedUncompressGzipContent()) {
+    return ReadUncompressedRequestBytes(input_buf, buf_size);
+  }
+
   *buf_size = evbuffer_get_contiguous_space(input_buf);
 
   if (*buf_size == 0) {
@@ -186,22 +233,6 @@ std::unique_ptr<char[], BlockDeleter> EvHTTPRequest::ReadRequestBytes(
     return nullptr;  // don't return corrupted buffer
   }
 
-  // Uncompress the entire body
-  if (NeedUncompressGzipContent()) {
-    char* new_block;
-    size_t orig_size = *buf_size;
-    UncompressGzipContent(block, orig_size,
-                          reinterpret_cast<void**>(&new_block), buf_size);
-    std::allocator<char>().deallocate(block, orig_size);
-    if (new_block != nullptr) {
-      block = new_block;
-    } else {
-      ABSL_RAW_LOG(ERROR, "Failed to uncompress the gzipped body");
-      *buf_size = 0;
-      return nullptr;  // don't return corrupted buffer
-    }
-  }
-
   return std::unique_ptr<char[], BlockDeleter>(block, BlockDeleter(*buf_size));
 }
 
@@ -217,24 +248,170 @@ bool EvHTTPRequest::NeedUncompressGzipContent() {
   return false;
 }
 
-void EvHTTPRequest::UncompressGzipContent(void* input, size_t input_size,
-                                          void** uncompressed_input,
-                                          size_t* uncompressed_input_size) {
-  int64_t max = handler_options_->auto_uncompress_max_size() > 0
-                    ? handler_options_->auto_uncompress_max_size()
-                    : ZLib::kMaxUncompressedBytes;
+bool EvHTTPRequest::NeedCompressGzipContent() {
+  size_t body_size = evbuffer_get_length(output_buf);
+  if (body_size == 0 ||
+      static_cast<int64_t>(body_size) <
+          handler_options_->auto_compress_min_size()) {
+    return false;
+  }
 
-  // our APIs don't need expose the actual content-length
-  *uncompressed_input_size = static_cast<size_t>(max);
+  // The handler has encoded the body itself
+  evkeyvalq* ev_headers =
+      evhttp_request_get_output_headers(parsed_request_->request);
+  if (evhttp_find_header(ev_headers, HTTPHeaders::CONTENT_ENCODING) !=
+      nullptr) {
+    return false;
+  }
+
+  auto accept_encoding = GetRequestHeader(HTTPHeaders::ACCEPT_ENCODING);
+  return !accept_encoding.empty() && AcceptsGzip(accept_encoding);
+}
+
+bool EvHTTPRequest::CompressGzipContent() {
+  evbuffer* compressed_buf = evbuffer_new();
+  if (compressed_buf == nullptr) {
+    return false;
+  }
 
   ZLib zlib;
-  int err = zlib.UncompressGzipAndAllocate(
-      reinterpret_cast<Bytef**>(uncompressed_input),
-      reinterpret_cast<uLongf*>(uncompressed_input_size),
-      static_cast<Bytef*>(input), static_cast<uLong>(input_size));
-  if (err != Z_OK) {
-    ABSL_RAW_LOG(ERROR, "Got zlib error: %d", err);
+  zlib.SetCompressionLevel(handler_options_->auto_compress_level());
+
+  // Deflate the body chunks in place, a slice at a time, each into space
+  // reserved at the end of compressed_buf.
+  const int num_chunks = evbuffer_peek(output_buf, -1, nullptr, nullptr, 0);
+  std::vector<evbuffer_iovec> chunks(num_chunks);
+  evbuffer_peek(output_buf, -1, nullptr, chunks.data(), num_chunks);
+
+  bool ok = true;
+  for (const evbuffer_iovec& chunk : chunks) {
+    const Bytef* data = static_cast<const Bytef*>(chunk.iov_base);
+    size_t data_size = chunk.iov_len;
+    while (ok && data_size > 0) {
+      const size_t slice_size = std::min(data_size, kCompressSliceSize);
+      // Fits the slice even if incompressible, with the gzip header
+      evbuffer_iovec out;
+      if (evbuffer_reserve_space(compressed_buf,
+                                 ZLib::MinCompressbufSize(slice_size), &out,
+                                 1) != 1) {
+        ok = false;
+        break;
+      }
+      uLongf out_size = static_cast<uLongf>(out.iov_len);
+      uLong slice_left = static_cast<uLong>(slice_size);
+      int err = zlib.CompressAtMost(static_cast<Bytef*>(out.iov_base),
+                                    &out_size, data, &slice_left);
+      if (err != Z_OK || slice_left != 0) {
+        ABSL_RAW_LOG(ERROR, "Got zlib error: %d", err);
+        ok = false;
+        break;
+      }
+      out.iov_len = out_size;
+      evbuffer_commit_space(compressed_buf, &out, 1);
+      data += slice_size;
+      data_size -= slice_size;
+    }
   }
+
+  if (ok) {
+    evbuffer_iovec out;
+    ok = evbuffer_reserve_space(compressed_buf, zlib.MinFooterSize(), &out,
+                                1) == 1;
+    uLongf out_size = ok ? static_cast<uLongf>(out.iov_len) : 0;
+    if (ok && zlib.CompressChunkDone(static_cast<Bytef*>(out.iov_base),
+                                     &out_size) == Z_OK) {
+      out.iov_len = out_size;
+      evbuffer_commit_space(compressed_buf, &out, 1);
+    } else {
+      ABSL_RAW_LOG(ERROR, "Failed to write the gzip footer");
+      ok = false;
+    }
+  }
+
+  if (!ok) {
+    evbuffer_free(compressed_buf);
+    return false;
+  }
+
+  evbuffer_free(output_buf);
+  output_buf = compressed_buf;
+
+  evkeyvalq* ev_headers =
+      evhttp_request_get_output_headers(parsed_request_->request);
+  evhttp_remove_header(ev_headers, HTTPHeaders::CONTENT_LENGTH);
+  evhttp_add_header(ev_headers, HTTPHeaders::CONTENT_ENCODING, "gzip");
+  return true;
+}
+
+std::unique_ptr<char[], BlockDeleter>
+EvHTTPRequest::ReadUncompressedRequestBytes(evbuffer* input_buf,
+                                            size_t* size) {
+  *size = 0;
+  if (uncompress_done_) {
+    return nullptr;
+  }
+  if (zlib_ == nullptr) {
+    zlib_.reset(new ZLib());
+  }
+
+  const int64_t max = handler_options_->auto_uncompress_max_size() > 0
+                          ? handler_options_->auto_uncompress_max_size()
+                          : ZLib::kMaxUncompressedBytes;
+  // One byte past the limit is enough to tell that it has been exceeded.
+  const size_t block_size = static_cast<size_t>(std::min<int64_t>(
+      kUncompressBlockSize, max - uncompressed_bytes_ + 1));
+
+  char* block = std::allocator<char>().allocate(block_size);
+  bool failed = false;
+  while (*size < block_size) {
+    // Inflate straight out of the input buffer, draining what is consumed.
+    size_t input_size = evbuffer_get_contiguous_space(input_buf);
+    if (input_size == 0) {
+      break;
+    }
+    const Bytef* input = evbuffer_pullup(input_buf, input_size);
+    uLong input_left = static_cast<uLong>(input_size);
+    uLongf output_size = static_cast<uLongf>(block_size - *size);
+    int err = zlib_->UncompressAtMost(reinterpret_cast<Bytef*>(block + *size),
+                                      &output_size, input, &input_left);
+    if (err != Z_OK && err != Z_BUF_ERROR) {
+      ABSL_RAW_LOG(ERROR, "Got zlib error: %d", err);
+      failed = true;
+      break;
+    }
+    evbuffer_drain(input_buf, input_size - input_left);
+    *size += output_size;
+    if (input_left == input_size && output_size == 0) {
+      ABSL_RAW_LOG(ERROR, "Unexpected trailing data in the gzipped body");
+      failed = true;
+      break;
+    }
+  }
+
+  uncompressed_bytes_ += *size;
+  if (uncompressed_bytes_ > max) {
+    ABSL_RAW_LOG(ERROR, "Uncompressed body exceeds the max size %jd",
+                 static_cast<intmax_t>(max));
+    failed = true;
+  } else if (!failed && *size == 0 &&
+             (zlib_->first_chunk() || !zlib_->UncompressChunkDone())) {
+    // All the input is consumed: the gzip footer must now be complete.
+    ABSL_RAW_LOG(ERROR, "Truncated or corrupted gzipped body");
+    failed = true;
+  }
+
+  if (failed || *size == 0) {
+    std::allocator<char>().deallocate(block, block_size);
+    if (failed) {
+      evbuffer_drain(input_buf, evbuffer_get_length(input_buf));
+    }
+    uncompress_done_ = true;
+    *size = 0;
+    return nullptr;  // EOF, or don't return corrupted buffer
+  }
+
+  return std::unique_ptr<char[], BlockDeleter>(block,
+                                               BlockDeleter(block_size));
 }
 
 // Note: passing string_view incurs a copy of underlying std::string data
@@ -298,6 +475,15 @@ void EvHTTPRequest::PartialReply() {
 }
 
 void EvHTTPRequest::ReplyWithStatus(HTTPStatusCode status) {
+  // Compress here, on the handler's thread, so as not to hold up the loop
+  if (handler_options_ != nullptr &&
+      handler_options_->auto_compress_output()) {
+    AppendResponseHeader(HTTPHeaders::VARY, HTTPHeaders::ACCEPT_ENCODING);
+    if (NeedCompressGzipContent()) {
+      CompressGzipContent();
+    }
+  }
+
   bool result =
       server_->EventLoopSchedule([this, status]() { EvSendReply(status); });
 
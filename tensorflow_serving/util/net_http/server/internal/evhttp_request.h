@@ -35,6 +35,8 @@ namespace tensorflow {
 namespace serving {
 namespace net_http {
 
+class ZLib;
+
 // Headers only
 struct ParsedEvRequest {
  public:
@@ -115,10 +117,19 @@ class EvHTTPRequest final : public ServerRequestInterface {
   // Returns true if the data needs be uncompressed
   bool NeedUncompressGzipContent();
 
-  // Must set uncompressed_input to nullptr if uncompression is failed
-  void UncompressGzipContent(void* input, size_t input_size,
-                             void** uncompressed_input,
-                             size_t* uncompressed_input_size);
+  // Returns true if the response body should be gzip-compressed
+  bool NeedCompressGzipContent();
+
+  // Replaces the response body with its gzip-compressed form, deflated
+  // directly from the body's buffer into a new one. Returns false, leaving
+  // the body as it is, on any error.
+  bool CompressGzipContent();
+
+  // Inflates the next block of the gzipped body from 'input_buf', consuming
+  // only as much input as it needs. Returns nullptr at the end of the body
+  // or on any error, after which the rest of the body is discarded.
+  std::unique_ptr<char[], BlockDeleter> ReadUncompressedRequestBytes(
+      evbuffer* input_buf, size_t* size);
 
   ServerSupport* server_;
 
@@ -127,6 +138,11 @@ class EvHTTPRequest final : public ServerRequestInterface {
   std::unique_ptr<ParsedEvRequest> parsed_request_;
 
   evbuffer* output_buf;  // owned by this
+
+  // Inflater state of a gzipped body, created on the first read
+  std::unique_ptr<ZLib> zlib_;
+  int64_t uncompressed_bytes_ = 0;
+  bool uncompress_done_ = false;
 };
 
 }  // namespace net_http
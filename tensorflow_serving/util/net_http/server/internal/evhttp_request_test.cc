@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <string>
 
 #include <gtest/gtest.h>
 
@@ -318,7 +319,7 @@ TEST_F(EvHTTPRequestTest, DisableGzipPost) {
 
 std::string CompressString(const char* data, size_t size) {
   ZLib zlib;
-  std::string buf(1000, '\0');
+  std::string buf(ZLib::MinCompressbufSize(size), '\0');
   size_t compressed_size = buf.size();
   zlib.Compress((Bytef*)buf.data(), &compressed_size, (Bytef*)data, size);
 
@@ -359,6 +360,49 @@ TEST_F(EvHTTPRequestTest, ValidGzipPost) {
   server->WaitForTermination();
 }
 
+// Test a gzip body inflated over multiple reads
+TEST_F(EvHTTPRequestTest, LargeGzipPost) {
+  std::string body;
+  for (int i = 0; body.size() < 300 * 1024; ++i) {
+    body += std::to_string(i);
+  }
+  std::string compressed = CompressString(body.data(), body.size());
+
+  auto handler = [&](ServerRequestInterface* request) {
+    std::string body_str;
+    int num_reads = 0;
+    int64_t num_bytes;
+    auto request_chunk = request->ReadRequestBytes(&num_bytes);
+    while (request_chunk != nullptr) {
+      body_str.append(request_chunk.get(), static_cast<size_t>(num_bytes));
+      ++num_reads;
+      request_chunk = request->ReadRequestBytes(&num_bytes);
+    }
+    EXPECT_EQ(0, num_bytes);
+    EXPECT_GT(num_reads, 1);
+    EXPECT_EQ(body_str, body);
+
+    request->Reply();
+  };
+  server->RegisterRequestHandler("/ok", std::move(handler),
+                                 RequestHandlerOptions());
+  server->StartAcceptingRequests();
+
+  auto connection =
+      EvHTTPConnection::Connect("localhost", server->listen_port());
+  ASSERT_TRUE(connection != nullptr);
+
+  ClientRequest request = {"/ok", "POST", {}, compressed};
+  request.headers.emplace_back("Content-Encoding", "my_gzip");
+  ClientResponse response = {};
+
+  EXPECT_TRUE(connection->BlockingSendRequest(request, &response));
+  EXPECT_EQ(response.status, 200);
+
+  server->Terminate();
+  server->WaitForTermination();
+}
+
 // Test gzip exceeding the max uncompressed limit
 TEST_F(EvHTTPRequestTest, GzipExceedingLimit) {
   constexpr char kBody[] = "abcdefg12345";
@@ -396,6 +440,85 @@ TEST_F(EvHTTPRequestTest, GzipExceedingLimit) {
   server->WaitForTermination();
 }
 
+// Test gzip compression of response bodies
+TEST_F(EvHTTPRequestTest, GzipResponse) {
+  std::string body;
+  for (int i = 0; body.size() < 100 * 1024; ++i) {
+    body += std::to_string(i % 100);
+  }
+
+  auto handler = [&](ServerRequestInterface* request) {
+    request->WriteResponseString(body);
+    request->Reply();
+  };
+  auto small_handler = [](ServerRequestInterface* request) {
+    request->WriteResponseString("OK");
+    request->Reply();
+  };
+  RequestHandlerOptions options;
+  options.set_auto_compress_output(true);
+  server->RegisterRequestHandler("/ok", std::move(handler), options);
+  server->RegisterRequestHandler("/small", std::move(small_handler), options);
+  server->StartAcceptingRequests();
+
+  auto connection =
+      EvHTTPConnection::Connect("localhost", server->listen_port());
+  ASSERT_TRUE(connection != nullptr);
+
+  auto get_header = [](const ClientResponse& response,
+                       const std::string& header) {
+    for (const auto& keyvalue : response.headers) {
+      if (keyvalue.first == header) {
+        return keyvalue.second;
+      }
+    }
+    return std::string();
+  };
+
+  // Accepted: compressed
+  ClientRequest request = {"/ok", "GET", {}, nullptr};
+  request.headers.emplace_back("Accept-Encoding", "deflate, gzip;q=0.8");
+  ClientResponse response = {};
+
+  EXPECT_TRUE(connection->BlockingSendRequest(request, &response));
+  EXPECT_EQ(response.status, 200);
+  EXPECT_EQ(get_header(response, "Content-Encoding"), "gzip");
+  EXPECT_EQ(get_header(response, "Vary"), "Accept-Encoding");
+  EXPECT_LT(response.body.size(), body.size());
+
+  ZLib zlib;
+  std::string uncompressed(body.size(), '\0');
+  uLongf uncompressed_size = uncompressed.size();
+  EXPECT_EQ(Z_OK, zlib.Uncompress((Bytef*)&uncompressed[0], &uncompressed_size,
+                                  (Bytef*)response.body.data(),
+                                  response.body.size()));
+  uncompressed.resize(uncompressed_size);
+  EXPECT_EQ(uncompressed, body);
+
+  // Not accepted: not compressed
+  request = {"/ok", "GET", {}, nullptr};
+  request.headers.emplace_back("Accept-Encoding", "gzip;q=0");
+  response = {};
+
+  EXPECT_TRUE(connection->BlockingSendRequest(request, &response));
+  EXPECT_EQ(response.status, 200);
+  EXPECT_EQ(get_header(response, "Content-Encoding"), "");
+  EXPECT_EQ(response.body, body);
+
+  // Below the min size: not compressed
+  request = {"/small", "GET", {}, nullptr};
+  request.headers.emplace_back("Accept-Encoding", "gzip");
+  response = {};
+
+  EXPECT_TRUE(connection->BlockingSendRequest(request, &response));
+  EXPECT_EQ(response.status, 200);
+  EXPECT_EQ(get_header(response, "Content-Encoding"), "");
+  EXPECT_EQ(response.body, "OK");
+
+  server->Terminate();
+  server->WaitForTermination();
+}
+
 }  // namespace
 }  // namespace net_http
 }  // namespace serving
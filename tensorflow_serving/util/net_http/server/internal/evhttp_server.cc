@@ -63,16 +63,42 @@ EvHTTPServer::~EvHTTPServer() {
     Terminate();
   }
 
-  if (ev_http_ != nullptr) {
+  loops_.clear();
+}
+
+EvHTTPServer::EventLoop::~EventLoop() {
+  if (ev_http != nullptr) {
     // this frees the socket handlers too
-    evhttp_free(ev_http_);
+    evhttp_free(ev_http);
   }
 
-  if (ev_base_ != nullptr) {
-    event_base_free(ev_base_);
+  if (ev_base != nullptr) {
+    event_base_free(ev_base);
   }
 }
 
+bool EvHTTPServer::EventLoop::Initialize() {
+  // This ev_base created per-loop v.s. global
+  ev_base = event_base_new();
+  if (ev_base == nullptr) {
+    ABSL_RAW_LOG(FATAL, "Failed to create an event_base.");
+    return false;
+  }
+
+  timeval tv_zero = {0, 0};
+  immediate = event_base_init_common_timeout(ev_base, &tv_zero);
+
+  ev_http = evhttp_new(ev_base);
+  if (ev_http == nullptr) {
+    ABSL_RAW_LOG(FATAL, "Failed to create evhttp.");
+    return false;
+  }
+
+  evhttp_set_gencb(ev_http, &DispatchEvRequestFn, this);
+
+  return true;
+}
+
 // Checks options.
 // TODO(wenboz): support multiple ports
 bool EvHTTPServer::Initialize() {
@@ -86,36 +112,31 @@ bool EvHTTPServer::Initialize() {
     return false;
   }
 
-  GlobalInitialize();
-
-  // This ev_base_ created per-server v.s. global
-  ev_base_ = event_base_new();
-  if (ev_base_ == nullptr) {
-    ABSL_RAW_LOG(FATAL, "Failed to create an event_base.");
+  if (server_options_->num_event_loops() < 1) {
+    ABSL_RAW_LOG(FATAL, "At least one event loop is required.");
     return false;
   }
 
-  timeval tv_zero = {0, 0};
-  immediate_ = event_base_init_common_timeout(ev_base_, &tv_zero);
+  GlobalInitialize();
 
-  ev_http_ = evhttp_new(ev_base_);
-  if (ev_http_ == nullptr) {
-    ABSL_RAW_LOG(FATAL, "Failed to create evhttp.");
-    return false;
+  for (int i = 0; i < server_options_->num_event_loops(); ++i) {
+    auto loop = absl::make_unique<EventLoop>(this);
+    if (!loop->Initialize()) {
+      return false;
+    }
+    loops_.push_back(std::move(loop));
   }
 
-  evhttp_set_gencb(ev_http_, &DispatchEvRequestFn, this);
-
   return true;
 }
 
 // static function pointer
-void EvHTTPServer::DispatchEvRequestFn(evhttp_request* req, void* server) {
-  EvHTTPServer* http_server = static_cast<EvHTTPServer*>(server);
-  http_server->DispatchEvRequest(req);
+void EvHTTPServer::DispatchEvRequestFn(evhttp_request* req, void* loop) {
+  EventLoop* event_loop = static_cast<EventLoop*>(loop);
+  event_loop->server->DispatchEvRequest(req, event_loop);
 }
 
-void EvHTTPServer::DispatchEvRequest(evhttp_request* req) {
+void EvHTTPServer::DispatchEvRequest(evhttp_request* req, EventLoop* loop) {
   auto parsed_request = absl::make_unique<ParsedEvRequest>(req);
 
   if (!parsed_request->decode()) {
@@ -127,7 +148,7 @@ void EvHTTPServer::DispatchEvRequest(evhttp_request* req) {
 
   bool dispatched = false;
   std::unique_ptr<EvHTTPRequest> ev_request(
-      new EvHTTPRequest(std::move(parsed_request), this));
+      new EvHTTPRequest(std::move(parsed_request), loop));
 
   if (!ev_request->Initialize()) {
     evhttp_send_error(req, HTTP_SERVUNAVAIL, nullptr);
@@ -135,7 +156,8 @@ void EvHTTPServer::DispatchEvRequest(evhttp_request* req) {
   }
 
   {
-    absl::MutexLock l(&request_mu_);
+    // Shared, as requests are dispatched from all event loops.
+    absl::ReaderMutexLock l(&request_mu_);
 
     auto handler_map_it = uri_handlers_.find(path);
     if (handler_map_it != uri_handlers_.end()) {
@@ -202,44 +224,129 @@ void ResolveEphemeralPort(evhttp_bound_socket* listener, int* port) {
   }
 }
 
-}  // namespace
+// Returns a non-blocking socket of 'family' (or, if AF_UNSPEC, of IPv6 if
+// supported and IPv4 otherwise, which is then set in '*bound_family')
+// listening on any address at 'port', with SO_REUSEPORT set so that more
+// sockets can listen on the same port. Returns -1 on error.
+evutil_socket_t ListenWithReusePort(int port, int family, int* bound_family) {
+#ifdef SO_REUSEPORT
+  for (const int candidate_family : {AF_INET6, AF_INET}) {
+    if (family != AF_UNSPEC && family != candidate_family) {
+      continue;
+    }
+    sockaddr_storage ss = {};
+    ev_socklen_t socklen;
+    if (candidate_family == AF_INET6) {
+      auto* addr = reinterpret_cast<sockaddr_in6*>(&ss);
+      addr->sin6_family = AF_INET6;
+      addr->sin6_addr = in6addr_any;
+      addr->sin6_port = htons(static_cast<uint16_t>(port));
+      socklen = sizeof(*addr);
+    } else {
+      auto* addr = reinterpret_cast<sockaddr_in*>(&ss);
+      addr->sin_family = AF_INET;
+      addr->sin_addr.s_addr = htonl(INADDR_ANY);
+      addr->sin_port = htons(static_cast<uint16_t>(port));
+      socklen = sizeof(*addr);
+    }
 
-bool EvHTTPServer::StartAcceptingRequests() {
-  if (ev_http_ == nullptr) {
-    ABSL_RAW_LOG(FATAL, "Server has not been successfully initialized");
-    return false;
+    evutil_socket_t fd = socket(candidate_family, SOCK_STREAM, 0);
+    if (fd < 0) {
+      continue;
+    }
+    const int one = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0 &&
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == 0 &&
+        evutil_make_socket_nonblocking(fd) == 0 &&
+        evutil_make_socket_closeonexec(fd) == 0 &&
+        bind(fd, reinterpret_cast<sockaddr*>(&ss), socklen) == 0 &&
+        listen(fd, 128) == 0) {  // backlog as in evhttp_bind_socket()
+      *bound_family = candidate_family;
+      return fd;
+    }
+    evutil_closesocket(fd);
   }
+#else
+  ABSL_RAW_LOG(ERROR, "SO_REUSEPORT is not supported on this platform");
+#endif
+  return -1;
+}
+
+}  // namespace
 
+bool EvHTTPServer::Listen() {
   const int port = server_options_->ports().front();
+  port_ = port;
 
-  // "::"  =>  in6addr_any
-  ev_uint16_t ev_port = static_cast<ev_uint16_t>(port);
-  ev_listener_ = evhttp_bind_socket_with_handle(ev_http_, "::", ev_port);
-  if (ev_listener_ == nullptr) {
-    // in case ipv6 is not supported, fallback to inaddr_any
-    ev_listener_ = evhttp_bind_socket_with_handle(ev_http_, nullptr, ev_port);
-    if (ev_listener_ == nullptr) {
-      ABSL_RAW_LOG(FATAL, "Couldn't bind to port %d", port);
-      return false;
+  if (loops_.size() == 1) {
+    evhttp* const ev_http = loops_.front()->ev_http;
+    evhttp_bound_socket* ev_listener;
+    // "::"  =>  in6addr_any
+    ev_uint16_t ev_port = static_cast<ev_uint16_t>(port);
+    ev_listener = evhttp_bind_socket_with_handle(ev_http, "::", ev_port);
+    if (ev_listener == nullptr) {
+      // in case ipv6 is not supported, fallback to inaddr_any
+      ev_listener = evhttp_bind_socket_with_handle(ev_http, nullptr, ev_port);
+      if (ev_listener == nullptr) {
+        ABSL_RAW_LOG(FATAL, "Couldn't bind to port %d", port);
+        return false;
+      }
+    }
+    loops_.front()->ev_listener = ev_listener;
+  } else {
+    // The first listener picks the port (if ephemeral) and address family;
+    // the others join it.
+    int family = AF_UNSPEC;
+    for (const auto& loop : loops_) {
+      evutil_socket_t fd = ListenWithReusePort(port_, family, &family);
+      if (fd < 0) {
+        ABSL_RAW_LOG(FATAL, "Couldn't bind to port %d with SO_REUSEPORT",
+                     port_);
+        return false;
+      }
+      // The listener owns the socket from here on.
+      loop->ev_listener = evhttp_accept_socket_with_handle(loop->ev_http, fd);
+      if (loop->ev_listener == nullptr) {
+        evutil_closesocket(fd);
+        ABSL_RAW_LOG(FATAL, "Couldn't listen on port %d", port_);
+        return false;
+      }
+      if (port_ == 0) {
+        ResolveEphemeralPort(loop->ev_listener, &port_);
+      }
     }
   }
 
-  // Listener counts as an active operation
-  IncOps();
-
-  port_ = port;
   if (port_ == 0) {
-    ResolveEphemeralPort(ev_listener_, &port_);
+    ResolveEphemeralPort(loops_.front()->ev_listener, &port_);
   }
+  return true;
+}
 
-  IncOps();
-  server_options_->executor()->Schedule([this]() {
-    ABSL_RAW_LOG(INFO, "Entering the event loop ...");
-    int result = event_base_dispatch(ev_base_);
-    ABSL_RAW_LOG(INFO, "event_base_dispatch() exits with value %d", result);
+bool EvHTTPServer::StartAcceptingRequests() {
+  if (loops_.empty()) {
+    ABSL_RAW_LOG(FATAL, "Server has not been successfully initialized");
+    return false;
+  }
+
+  if (!Listen()) {
+    return false;
+  }
 
-    DecOps();
-  });
+  for (const auto& loop : loops_) {
+    // Listener counts as an active operation
+    IncOps();
+
+    IncOps();
+    event_base* const ev_base = loop->ev_base;
+    server_options_->executor()->Schedule([this, ev_base]() {
+      ABSL_RAW_LOG(INFO, "Entering the event loop ...");
+      int result = event_base_dispatch(ev_base);
+      ABSL_RAW_LOG(INFO, "event_base_dispatch() exits with value %d", result);
+
+      DecOps();
+    });
+  }
 
   accepting_requests_.Notify();
 
@@ -266,12 +373,15 @@ void EvHTTPServer::Terminate() {
   terminating_.Notify();
 
   // call exit-loop from the event loop
-  this->EventLoopSchedule([this]() {
-    // Stop the listener first, which will delete ev_listener_
-    // This may cause the loop to exit, so need be scheduled from within
-    evhttp_del_accept_socket(ev_http_, ev_listener_);
-    DecOps();
-  });
+  for (const auto& loop : loops_) {
+    EventLoop* const event_loop = loop.get();
+    event_loop->EventLoopSchedule([this, event_loop]() {
+      // Stop the listener first, which will delete ev_listener
+      // This may cause the loop to exit, so need be scheduled from within
+      evhttp_del_accept_socket(event_loop->ev_http, event_loop->ev_listener);
+      DecOps();
+    });
+  }
 
   // Current shut-down behavior:
   // - we don't proactively delete/close any HTTP connections as part of
@@ -295,15 +405,33 @@ void EvHTTPServer::DecOps() {
   num_pending_ops_--;
 }
 
+namespace {
+
+// The state of a server whose only pending operations are its running event
+// loops.
+struct OnlyLoopsPending {
+  const int64_t* num_pending_ops;
+  int64_t num_loops;
+};
+
+bool AreOnlyLoopsPending(OnlyLoopsPending* state) {
+  return *state->num_pending_ops <= state->num_loops;
+}
+
+}  // namespace
+
 void EvHTTPServer::WaitForTermination() {
   {
     absl::MutexLock l(&ops_mu_);
-    ops_mu_.Await(absl::Condition(+[](int64_t* count) { return *count <= 1; },
-                                  &num_pending_ops_));
+    OnlyLoopsPending state = {&num_pending_ops_,
+                              static_cast<int64_t>(loops_.size())};
+    ops_mu_.Await(absl::Condition(&AreOnlyLoopsPending, &state));
   }
 
-  int result = event_base_loopexit(ev_base_, nullptr);
-  ABSL_RAW_LOG(INFO, "event_base_loopexit() exits with value %d", result);
+  for (const auto& loop : loops_) {
+    int result = event_base_loopexit(loop->ev_base, nullptr);
+    ABSL_RAW_LOG(INFO, "event_base_loopexit() exits with value %d", result);
+  }
 
   {
     absl::MutexLock l(&ops_mu_);
@@ -317,15 +445,17 @@ bool EvHTTPServer::WaitForTerminationWithTimeout(absl::Duration timeout) {
 
   {
     absl::MutexLock l(&ops_mu_);
+    OnlyLoopsPending state = {&num_pending_ops_,
+                              static_cast<int64_t>(loops_.size())};
     wait_result = ops_mu_.AwaitWithTimeout(
-        absl::Condition(+[](int64_t* count) { return *count <= 1; },
-                        &num_pending_ops_),
-        timeout);
+        absl::Condition(&AreOnlyLoopsPending, &state), timeout);
   }
 
   if (wait_result) {
-    int result = event_base_loopexit(ev_base_, nullptr);
-    ABSL_RAW_LOG(INFO, "event_base_loopexit() exits with value %d", result);
+    for (const auto& loop : loops_) {
+      int result = event_base_loopexit(loop->ev_base, nullptr);
+      ABSL_RAW_LOG(INFO, "event_base_loopexit() exits with value %d", result);
+    }
 
     // This should pass immediately
     {
@@ -394,9 +524,13 @@ void EvImmediateCallback(evutil_socket_t socket, int16_t flags, void* arg) {
 }  // namespace
 
 bool EvHTTPServer::EventLoopSchedule(std::function<void()> fn) {
+  return loops_.front()->EventLoopSchedule(std::move(fn));
+}
+
+bool EvHTTPServer::EventLoop::EventLoopSchedule(std::function<void()> fn) {
   auto scheduled_fn = new std::function<void()>(std::move(fn));
-  int result = event_base_once(ev_base_, -1, EV_TIMEOUT, EvImmediateCallback,
-                               static_cast<void*>(scheduled_fn), immediate_);
+  int result = event_base_once(ev_base, -1, EV_TIMEOUT, EvImmediateCallback,
+                               static_cast<void*>(scheduled_fn), immediate);
   return result == 0;
 }
 
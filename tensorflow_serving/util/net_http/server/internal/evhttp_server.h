@@ -37,6 +37,7 @@ struct event_base;
 struct evhttp;
 struct evhttp_bound_socket;
 struct evhttp_request;
+struct timeval;
 
 namespace tensorflow {
 namespace serving {
@@ -76,18 +77,46 @@ class EvHTTPServer final : public HTTPServerInterface, ServerSupport {
   void IncOps() override;
   void DecOps() override;
 
+  // Schedules on the first event loop.
   bool EventLoopSchedule(std::function<void()> fn) override;
 
  private:
-  static void DispatchEvRequestFn(struct evhttp_request* req, void* server);
+  // An event loop with its own evhttp instance and listener. The requests of
+  // a connection are read, and replied to, on the loop that accepted it; so
+  // the loop is the ServerSupport of those requests.
+  class EventLoop final : public ServerSupport {
+   public:
+    explicit EventLoop(EvHTTPServer* server_in) : server(server_in) {}
+    ~EventLoop() override;
+
+    bool Initialize();
+
+    void IncOps() override { server->IncOps(); }
+    void DecOps() override { server->DecOps(); }
+    bool EventLoopSchedule(std::function<void()> fn) override;
 
-  void DispatchEvRequest(struct evhttp_request* req);
+    EvHTTPServer* const server;
+    event_base* ev_base = nullptr;
+    evhttp* ev_http = nullptr;
+    evhttp_bound_socket* ev_listener = nullptr;
+
+    // Timeval used to register immediate callbacks, which are called
+    // in the order that they are registered.
+    const timeval* immediate = nullptr;
+  };
+
+  static void DispatchEvRequestFn(struct evhttp_request* req, void* loop);
+
+  void DispatchEvRequest(struct evhttp_request* req, EventLoop* loop);
+
+  // Binds the listeners of all event loops to the configured port.
+  bool Listen();
 
   void ScheduleHandlerReference(const RequestHandler& handler,
                                 EvHTTPRequest* ev_request)
-      EXCLUSIVE_LOCKS_REQUIRED(request_mu_);
+      SHARED_LOCKS_REQUIRED(request_mu_);
   void ScheduleHandler(RequestHandler&& handler, EvHTTPRequest* ev_request)
-      EXCLUSIVE_LOCKS_REQUIRED(request_mu_);
+      SHARED_LOCKS_REQUIRED(request_mu_);
 
   struct UriHandlerInfo {
    public:
@@ -126,14 +155,8 @@ class EvHTTPServer final : public HTTPServerInterface, ServerSupport {
       GUARDED_BY(request_mu_);
   std::vector<DispatcherInfo> dispatchers_ GUARDED_BY(request_mu_);
 
-  // ev instances
-  event_base* ev_base_ = nullptr;
-  evhttp* ev_http_ = nullptr;
-  evhttp_bound_socket* ev_listener_ = nullptr;
-
-  // Timeval used to register immediate callbacks, which are called
-  // in the order that they are registered.
-  const timeval* immediate_;
+  // The event loops. Fixed once Initialize() succeeds.
+  std::vector<std::unique_ptr<EventLoop>> loops_;
 };
 
 }  // namespace net_http
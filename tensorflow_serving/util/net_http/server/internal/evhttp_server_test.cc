@@ -339,6 +339,44 @@ TEST_F(EvHTTPServerTest, ActiveRequestCountInShutdown) {
   // response.status etc are undefined as the server is terminated
 }
 
+// Test serving with multiple event loops listening on the same port
+TEST(EvHTTPServerMultiLoopTest, MultipleEventLoops) {
+  auto options = absl::make_unique<ServerOptions>();
+  options->AddPort(0);
+  options->SetNumEventLoops(3);
+  // one thread per event loop, plus the handler threads
+  options->SetExecutor(absl::make_unique<MyExecutor>(3 + 4));
+
+  auto server = CreateEvHTTPServer(std::move(options));
+  ASSERT_TRUE(server != nullptr);
+
+  auto handler = [](ServerRequestInterface* request) {
+    request->WriteResponseString("OK");
+    request->Reply();
+  };
+  server->RegisterRequestHandler("/ok", std::move(handler),
+                                 RequestHandlerOptions());
+  server->StartAcceptingRequests();
+  ASSERT_NE(server->listen_port(), 0);
+
+  // New connections may land on any of the loops.
+  for (int i = 0; i < 10; ++i) {
+    auto connection =
+        EvHTTPConnection::Connect("localhost", server->listen_port());
+    ASSERT_TRUE(connection != nullptr);
+
+    ClientRequest request = {"/ok", "GET", {}, nullptr};
+    ClientResponse response = {};
+
+    EXPECT_TRUE(connection->BlockingSendRequest(request, &response));
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(response.body, "OK");
+  }
+
+  server->Terminate();
+  server->WaitForTermination();
+}
+
 }  // namespace
 }  // namespace net_http
 }  // namespace serving
@@ -67,13 +67,25 @@ class ServerOptions {
     executor_ = std::move(executor);
   }
 
+  // The number of event loops that accept connections and do their I/O.
+  // Defaults to one. With more than one, each loop has its own listener on
+  // the port, bound with SO_REUSEPORT, and the kernel spreads incoming
+  // connections across them. Each loop occupies one executor thread.
+  void SetNumEventLoops(int num_event_loops) {
+    assert(num_event_loops > 0);
+    num_event_loops_ = num_event_loops;
+  }
+
   const std::vector<int>& ports() const { return ports_; }
 
   EventExecutor* executor() const { return executor_.get(); }
 
+  int num_event_loops() const { return num_event_loops_; }
+
  private:
   std::vector<int> ports_;
   std::unique_ptr<EventExecutor> executor_;
+  int num_event_loops_ = 1;
 };
 
 // Options to specify when registering a handler (given a uri pattern).
@@ -108,13 +120,50 @@ class RequestHandlerOptions {
 
   inline bool auto_uncompress_input() const { return auto_uncompress_input_; }
 
+  // The auto_compress_output option specifies whether the response body
+  // should be gzip-compressed if the request accepts it, i.e. has the
+  // Accept-Encoding: gzip header, and the handler hasn't set its own
+  // Content-Encoding. The option defaults to false.
+  inline RequestHandlerOptions& set_auto_compress_output(bool should_compress) {
+    auto_compress_output_ = should_compress;
+    return *this;
+  }
+
+  inline bool auto_compress_output() const { return auto_compress_output_; }
+
+  // Sets the zlib compression level, from 1 (fastest) to 9 (smallest), for
+  // compressing a response body. Defaults to -1, i.e. zlib's default level.
+  inline RequestHandlerOptions& set_auto_compress_level(int level) {
+    auto_compress_level_ = level;
+    return *this;
+  }
+
+  inline int auto_compress_level() const { return auto_compress_level_; }
+
+  // Sets the min length of a response body for it to be compressed; smaller
+  // bodies are sent as they are. Defaults to 1KB.
+  inline RequestHandlerOptions& set_auto_compress_min_size(int64_t size) {
+    auto_compress_min_size_ = size;
+    return *this;
+  }
+
+  inline int64_t auto_compress_min_size() const {
+    return auto_compress_min_size_;
+  }
+
  private:
-  // To be added: compression, CORS rules, streaming control
+  // To be added: CORS rules, streaming control
   // thread executor, admission control, limits ...
 
   bool auto_uncompress_input_ = true;
 
   int64_t auto_uncompress_max_size_ = 0;
+
+  bool auto_compress_output_ = false;
+
+  int auto_compress_level_ = -1;
+
+  int64_t auto_compress_min_size_ = 1024;
 };
 
 // A request handler is registered by the application to handle a request
@@ -98,7 +98,9 @@ class ServerRequestInterface {
   // release the memory manually as its allocator is subject to change.
   //
   // Note this is not a streaming read API in that the complete request body
-  // should have already been received.
+  // should have already been received. A gzipped body (if auto-uncompressed)
+  // is however inflated incrementally, one bounded block per call, so callers
+  // that consume each block before reading the next never hold it all.
   virtual std::unique_ptr<char[], BlockDeleter> ReadRequestBytes(
       int64_t* size) = 0;
 
@@ -0,0 +1,253 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/util/read_limited_file_system.h"
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/null_file_system.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+// Read-limited paths are of the form "read_limited://<path>". They are the
+// same for every load of a path, so that e.g. the metrics TensorFlow labels
+// with the export directory of a SavedModel do not gain a label per load.
+constexpr char kReadLimitedScheme[] = "read_limited";
+
+string GetReadLimitedPathPrefix() {
+  return strings::StrCat(kReadLimitedScheme, "://");
+}
+
+// Returns in 'path' the path that the read-limited path 'name' stands for.
+Status ParseReadLimitedPath(const string& name, string* path) {
+  const string prefix = GetReadLimitedPathPrefix();
+  if (!str_util::StartsWith(name, prefix) || name.size() == prefix.size()) {
+    return errors::InvalidArgument("Malformed read-limited path: ", name);
+  }
+  *path = name.substr(prefix.size());
+  return Status::OK();
+}
+
+// Returns true iff 'path' is 'root' or lies under it.
+bool IsPathUnder(const string& path, const string& root) {
+  if (!str_util::StartsWith(path, root)) {
+    return false;
+  }
+  return path.size() == root.size() || root.back() == '/' ||
+         path[root.size()] == '/';
+}
+
+// The read limiters of the live ScopedReadLimitedPaths, by the path they limit.
+// A path may be limited by several ScopedReadLimitedPaths at once, in which
+// case the most recent one applies.
+class ReadLimiterRegistry {
+ public:
+  static ReadLimiterRegistry* Get() {
+    static ReadLimiterRegistry* const registry = new ReadLimiterRegistry;
+    return registry;
+  }
+
+  void Register(const string& root,
+                const std::shared_ptr<TokenBucket>& read_limiter) {
+    mutex_lock l(mu_);
+    read_limiters_[root].push_back(read_limiter);
+  }
+
+  void Unregister(const string& root,
+                  const std::shared_ptr<TokenBucket>& read_limiter) {
+    mutex_lock l(mu_);
+    const auto it = read_limiters_.find(root);
+    if (it == read_limiters_.end()) {
+      return;
+    }
+    std::vector<std::shared_ptr<TokenBucket>>& limiters = it->second;
+    const auto limiter_it =
+        std::find(limiters.rbegin(), limiters.rend(), read_limiter);
+    if (limiter_it != limiters.rend()) {
+      limiters.erase(std::next(limiter_it).base());
+    }
+    if (limiters.empty()) {
+      read_limiters_.erase(it);
+    }
+  }
+
+  // Returns in 'root' the registered path that 'path' lies under. Returns
+  // false if there is none.
+  bool FindRoot(const string& path, string* root) {
+    tf_shared_lock l(mu_);
+    for (const auto& entry : read_limiters_) {
+      if (IsPathUnder(path, entry.first)) {
+        *root = entry.first;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Takes 'num_tokens' tokens from the read limiter of 'root', if it is still
+  // registered.
+  void Acquire(const string& root, const uint64 num_tokens) {
+    std::shared_ptr<TokenBucket> read_limiter;
+    {
+      tf_shared_lock l(mu_);
+      const auto it = read_limiters_.find(root);
+      if (it == read_limiters_.end()) {
+        return;
+      }
+      read_limiter = it->second.back();
+    }
+    read_limiter->Acquire(num_tokens);
+  }
+
+ private:
+  mutex mu_;
+  std::unordered_map<string, std::vector<std::shared_ptr<TokenBucket>>>
+      read_limiters_ GUARDED_BY(mu_);
+};
+
+// A RandomAccessFile whose reads take tokens from a registered read limiter.
+class ReadLimitedFile : public RandomAccessFile {
+ public:
+  ReadLimitedFile(const string& root, std::unique_ptr<RandomAccessFile> file)
+      : root_(root), file_(std::move(file)) {}
+
+  ~ReadLimitedFile() override = default;
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    ReadLimiterRegistry::Get()->Acquire(root_, n);
+    return file_->Read(offset, n, result, scratch);
+  }
+
+ private:
+  // The registered path whose read limiter the reads take tokens from.
+  const string root_;
+  const std::unique_ptr<RandomAccessFile> file_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ReadLimitedFile);
+};
+
+// The read-only file system serving read-limited paths from the file systems
+// of the paths they stand for.
+class ReadLimitedFileSystem : public NullFileSystem {
+ public:
+  ReadLimitedFileSystem() = default;
+  ~ReadLimitedFileSystem() override = default;
+
+  Status NewRandomAccessFile(
+      const string& fname, std::unique_ptr<RandomAccessFile>* result) override {
+    string path;
+    TF_RETURN_IF_ERROR(ParseReadLimitedPath(fname, &path));
+    string root;
+    if (!ReadLimiterRegistry::Get()->FindRoot(path, &root)) {
+      return Env::Default()->NewRandomAccessFile(path, result);
+    }
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(path, &file));
+    result->reset(new ReadLimitedFile(root, std::move(file)));
+    return Status::OK();
+  }
+
+  // Memory-mapped files are paged in on access, which can't be limited.
+  Status NewReadOnlyMemoryRegionFromFile(
+      const string& fname,
+      std::unique_ptr<ReadOnlyMemoryRegion>* result) override {
+    string path;
+    TF_RETURN_IF_ERROR(GetPath(fname, &path));
+    return Env::Default()->NewReadOnlyMemoryRegionFromFile(path, result);
+  }
+
+  Status FileExists(const string& fname) override {
+    string path;
+    TF_RETURN_IF_ERROR(GetPath(fname, &path));
+    return Env::Default()->FileExists(path);
+  }
+
+  Status GetChildren(const string& dir, std::vector<string>* result) override {
+    string path;
+    TF_RETURN_IF_ERROR(GetPath(dir, &path));
+    return Env::Default()->GetChildren(path, result);
+  }
+
+  Status GetMatchingPaths(const string& pattern,
+                          std::vector<string>* results) override {
+    string path_pattern;
+    TF_RETURN_IF_ERROR(ParseReadLimitedPath(pattern, &path_pattern));
+    TF_RETURN_IF_ERROR(
+        Env::Default()->GetMatchingPaths(path_pattern, results));
+    for (string& result : *results) {
+      result = strings::StrCat(GetReadLimitedPathPrefix(), result);
+    }
+    return Status::OK();
+  }
+
+  Status Stat(const string& fname, FileStatistics* stat) override {
+    string path;
+    TF_RETURN_IF_ERROR(GetPath(fname, &path));
+    return Env::Default()->Stat(path, stat);
+  }
+
+  Status IsDirectory(const string& fname) override {
+    string path;
+    TF_RETURN_IF_ERROR(GetPath(fname, &path));
+    return Env::Default()->IsDirectory(path);
+  }
+
+  Status GetFileSize(const string& fname, uint64* file_size) override {
+    string path;
+    TF_RETURN_IF_ERROR(GetPath(fname, &path));
+    return Env::Default()->GetFileSize(path, file_size);
+  }
+
+ private:
+  // Returns in 'path' the path that the read-limited path 'name' stands for.
+  static Status GetPath(const string& name, string* path) {
+    return ParseReadLimitedPath(name, path);
+  }
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ReadLimitedFileSystem);
+};
+
+REGISTER_FILE_SYSTEM(kReadLimitedScheme, ReadLimitedFileSystem);
+
+}  // namespace
+
+ScopedReadLimitedPath::ScopedReadLimitedPath(
+    const string& path, std::shared_ptr<TokenBucket> read_limiter)
+    : target_path_(path),
+      path_(strings::StrCat(GetReadLimitedPathPrefix(), path)),
+      read_limiter_(std::move(read_limiter)) {
+  ReadLimiterRegistry::Get()->Register(target_path_, read_limiter_);
+}
+
+ScopedReadLimitedPath::~ScopedReadLimitedPath() {
+  ReadLimiterRegistry::Get()->Unregister(target_path_, read_limiter_);
+}
+
+}  // namespace serving
+}  // namespace tensorflow
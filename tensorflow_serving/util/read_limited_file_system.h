@@ -0,0 +1,71 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_UTIL_READ_LIMITED_FILE_SYSTEM_H_
+#define TENSORFLOW_SERVING_UTIL_READ_LIMITED_FILE_SYSTEM_H_
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow_serving/util/token_bucket.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Makes the files under a path readable, for the lifetime of this object,
+// through another path at which reads acquire one token per byte from a
+// TokenBucket. The other path goes through a file system registered with
+// TensorFlow's Env under the "read_limited" scheme, so the limit applies to
+// all code that reads through the Env, e.g. the ops that restore the variables
+// of a SavedModel, which cannot be handed an Env of their own.
+//
+// The other path depends only on the path, so it is the same for every
+// ScopedReadLimitedPath of that path. While several of them are live, reads
+// take tokens from the TokenBucket of the most recently created one.
+//
+// The other path is read-only. Once this object is destroyed, reads through it
+// still succeed, but are no longer limited: a model loaded from it may e.g.
+// hold on to the paths of its assets.
+//
+// Example use, to limit the read throughput of a model load to 1MB/s:
+//   auto read_limiter =
+//       std::make_shared<TokenBucket>(Env::Default(), 1 << 20, 1 << 20);
+//   ScopedReadLimitedPath limited_path(path, read_limiter);
+//   ... load the model from limited_path.path() ...
+class ScopedReadLimitedPath {
+ public:
+  ScopedReadLimitedPath(const string& path,
+                        std::shared_ptr<TokenBucket> read_limiter);
+
+  ~ScopedReadLimitedPath();
+
+  // Returns the path through which reads are limited.
+  const string& path() const { return path_; }
+
+ private:
+  // The path whose files are made readable.
+  const string target_path_;
+  const string path_;
+  const std::shared_ptr<TokenBucket> read_limiter_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedReadLimitedPath);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_UTIL_READ_LIMITED_FILE_SYSTEM_H_
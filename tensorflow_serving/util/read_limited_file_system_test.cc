@@ -0,0 +1,121 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/util/read_limited_file_system.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(ReadLimitedFileSystemTest, ReadsThroughLimitedPath) {
+  const string dir = io::JoinPath(testing::TmpDir(), "ReadsThroughLimitedPath");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), io::JoinPath(dir, "file"),
+                                 "contents"));
+
+  ScopedReadLimitedPath limited_path(
+      dir, std::make_shared<TokenBucket>(Env::Default(), 1 << 20, 1 << 20));
+  EXPECT_EQ(strings::StrCat("read_limited://", dir), limited_path.path());
+  const string limited_file = io::JoinPath(limited_path.path(), "file");
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), limited_file, &contents));
+  EXPECT_EQ("contents", contents);
+  TF_EXPECT_OK(Env::Default()->IsDirectory(limited_path.path()));
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(limited_path.path(), &children));
+  EXPECT_THAT(children, ElementsAre("file"));
+  std::vector<string> matches;
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+      io::JoinPath(limited_path.path(), "f*"), &matches));
+  EXPECT_THAT(matches, ElementsAre(limited_file));
+
+  // The path is read-only.
+  EXPECT_FALSE(
+      WriteStringToFile(Env::Default(), limited_file, "overwritten").ok());
+}
+
+TEST(ReadLimitedFileSystemTest, SamePathForEveryScope) {
+  const string dir = io::JoinPath(testing::TmpDir(), "SamePathForEveryScope");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), io::JoinPath(dir, "file"),
+                                 "contents"));
+
+  auto read_limiter =
+      std::make_shared<TokenBucket>(Env::Default(), 1 << 20, 1 << 20);
+  std::unique_ptr<ScopedReadLimitedPath> first_path(
+      new ScopedReadLimitedPath(dir, read_limiter));
+  ScopedReadLimitedPath second_path(dir, read_limiter);
+  EXPECT_EQ(first_path->path(), second_path.path());
+
+  // Destroying one of the scopes leaves the other one's path readable.
+  first_path.reset();
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(
+      Env::Default(), io::JoinPath(second_path.path(), "file"), &contents));
+  EXPECT_EQ("contents", contents);
+}
+
+TEST(ReadLimitedFileSystemTest, LimitsReads) {
+  const string dir = io::JoinPath(testing::TmpDir(), "LimitsReads");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), io::JoinPath(dir, "file"),
+                                 "0123456789"));
+
+  test_util::FakeClockEnv env(Env::Default());
+  // The bucket holds exactly one read of the file.
+  std::unique_ptr<ScopedReadLimitedPath> limited_path(new ScopedReadLimitedPath(
+      dir, std::make_shared<TokenBucket>(&env, 1000 /* i.e. 1 per ms */, 10)));
+  const string limited_file = io::JoinPath(limited_path->path(), "file");
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), limited_file, &contents));
+
+  Notification read;
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread(ThreadOptions(), "Read", [&]() {
+        string contents;
+        TF_ASSERT_OK(ReadFileToString(Env::Default(), limited_file, &contents));
+        read.Notify();
+      }));
+  // The bucket is empty, so the second read waits 10ms for tokens to accrue.
+  env.BlockUntilSleepingThread(10 * 1000);
+  EXPECT_FALSE(read.HasBeenNotified());
+  env.AdvanceByMicroseconds(10 * 1000);
+  read.WaitForNotification();
+
+  // Once the path goes out of scope, reads through it are no longer limited,
+  // and would not block on the frozen clock.
+  limited_path.reset();
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), limited_file, &contents));
+  EXPECT_EQ("0123456789", contents);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
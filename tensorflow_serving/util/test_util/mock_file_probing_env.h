@@ -31,6 +31,8 @@ class MockFileProbingEnv : public FileProbingEnv {
                Status(const string& fname, std::vector<string>* children));
   MOCK_METHOD1(IsDirectory, Status(const string& fname));
   MOCK_METHOD2(GetFileSize, Status(const string& fname, uint64* file_size));
+  MOCK_METHOD2(GetModificationTime,
+               Status(const string& fname, int64* mtime_nsec));
 };
 
 }  // namespace test_util
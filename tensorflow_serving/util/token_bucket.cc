@@ -0,0 +1,59 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/util/token_bucket.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace serving {
+
+TokenBucket::TokenBucket(Env* const env, const uint64 tokens_per_second,
+                         const uint64 max_tokens)
+    : env_(env),
+      tokens_per_micro_(tokens_per_second / 1e6),
+      max_tokens_(max_tokens),
+      available_tokens_(max_tokens),
+      last_refill_micros_(env->NowMicros()) {
+  DCHECK_GT(tokens_per_second, 0);
+}
+
+void TokenBucket::Acquire(const uint64 num_tokens) {
+  uint64 wait_micros;
+  {
+    mutex_lock l(mu_);
+    const uint64 now_micros = env_->NowMicros();
+    if (now_micros > last_refill_micros_) {
+      available_tokens_ =
+          std::min(max_tokens_,
+                   available_tokens_ +
+                       (now_micros - last_refill_micros_) * tokens_per_micro_);
+      last_refill_micros_ = now_micros;
+    }
+    // Take the tokens right away, going into debt if need be, so that later
+    // callers queue up behind this one.
+    available_tokens_ -= num_tokens;
+    if (available_tokens_ >= 0) {
+      return;
+    }
+    wait_micros = static_cast<uint64>(-available_tokens_ / tokens_per_micro_);
+  }
+  env_->SleepForMicroseconds(wait_micros);
+}
+
+}  // namespace serving
+}  // namespace tensorflow
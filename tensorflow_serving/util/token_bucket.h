@@ -0,0 +1,72 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_SERVING_UTIL_TOKEN_BUCKET_H_
+#define TENSORFLOW_SERVING_UTIL_TOKEN_BUCKET_H_
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// A thread-safe token-bucket rate limiter. Tokens accrue at a fixed rate, up to
+// a maximum (the permitted burst size), and callers block until the tokens they
+// ask for are available.
+//
+// Requests for more tokens than the maximum are permitted: the bucket goes into
+// debt, which later requests wait out. Thus requests are served in the order
+// in which they arrive, and the long-run rate never exceeds the configured one.
+//
+// Example use, to limit the read throughput of a file copy to 1MB/s:
+//   TokenBucket read_limiter(Env::Default(), 1 << 20, 1 << 20);
+//   for (...) {
+//     read_limiter.Acquire(chunk_size);
+//     ... read the chunk ...
+//   }
+class TokenBucket {
+ public:
+  // 'env' is used for time and for sleeping, and is not owned. The bucket
+  // starts out full. 'tokens_per_second' must be positive.
+  TokenBucket(Env* env, uint64 tokens_per_second, uint64 max_tokens);
+
+  ~TokenBucket() = default;
+
+  // Takes 'num_tokens' tokens, blocking until they are available.
+  void Acquire(uint64 num_tokens) LOCKS_EXCLUDED(mu_);
+
+ private:
+  Env* const env_;
+  const double tokens_per_micro_;
+  const double max_tokens_;
+
+  mutable mutex mu_;
+
+  // Number of tokens in the bucket as of 'last_refill_micros_'. Negative if the
+  // bucket is in debt.
+  double available_tokens_ GUARDED_BY(mu_);
+
+  uint64 last_refill_micros_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TokenBucket);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_SERVING_UTIL_TOKEN_BUCKET_H_
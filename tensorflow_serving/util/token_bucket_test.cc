@@ -0,0 +1,80 @@
+/* Copyright 2018 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_serving/util/token_bucket.h"
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
+#include "tensorflow/core/lib/core/notification.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+TEST(TokenBucketTest, BurstDoesNotBlock) {
+  test_util::FakeClockEnv env(Env::Default());
+  TokenBucket bucket(&env, 100, 1000);
+  // Would block forever if any of these slept, since the clock is frozen.
+  bucket.Acquire(500);
+  bucket.Acquire(500);
+}
+
+TEST(TokenBucketTest, BlocksUntilTokensAccrue) {
+  test_util::FakeClockEnv env(Env::Default());
+  TokenBucket bucket(&env, 1000 /* per second, i.e. 1 per ms */, 1000);
+  bucket.Acquire(1000);
+
+  Notification acquired;
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread(ThreadOptions(), "Acquire", [&]() {
+        bucket.Acquire(10);
+        acquired.Notify();
+      }));
+  // The bucket is empty, so it takes 10ms to accrue 10 tokens.
+  env.BlockUntilSleepingThread(10 * 1000);
+  EXPECT_FALSE(acquired.HasBeenNotified());
+  env.AdvanceByMicroseconds(10 * 1000);
+  acquired.WaitForNotification();
+}
+
+TEST(TokenBucketTest, OversizedRequestsGoIntoDebt) {
+  test_util::FakeClockEnv env(Env::Default());
+  TokenBucket bucket(&env, 1000 /* per second, i.e. 1 per ms */, 100);
+
+  Notification first_acquired;
+  Notification second_acquired;
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread(ThreadOptions(), "Acquire", [&]() {
+        // Larger than the bucket: takes the 100 tokens in it, and waits for
+        // 200 more.
+        bucket.Acquire(300);
+        first_acquired.Notify();
+        // Must wait for the debt to be paid off, too.
+        bucket.Acquire(1);
+        second_acquired.Notify();
+      }));
+  env.BlockUntilSleepingThread(200 * 1000);
+  env.AdvanceByMicroseconds(200 * 1000);
+  first_acquired.WaitForNotification();
+  env.BlockUntilSleepingThread(201 * 1000);
+  env.AdvanceByMicroseconds(1000);
+  second_acquired.WaitForNotification();
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow